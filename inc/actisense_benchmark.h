@@ -0,0 +1,117 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_BENCHMARK_H
+#define ACTISENSE_BENCHMARK_H
+
+#include "twocanerror.h"
+#include "twocanutils.h"
+#include "actisense_device.h"
+#include "actisense_bus.h"
+
+// wxWidgets
+#include <wx/string.h>
+// Reading and writing baselines
+#include <wx/file.h>
+#include <wx/tokenzr.h>
+
+// STL
+#include <vector>
+#include <functional>
+
+// Each benchmark runs for at least this long (msec), the fastest of its repetitions is reported
+#define CONST_BENCHMARK_PERIOD 100
+#define CONST_BENCHMARK_REPETITIONS 5
+
+// Default regression threshold (percent) when comparing with a baseline
+#define CONST_BENCHMARK_THRESHOLD 10
+
+// Result of a benchmark, per operation
+typedef struct BenchmarkResult {
+	wxString name;
+	unsigned long long iterations;
+	double nanoseconds;
+	double allocations;
+} BenchmarkResult;
+
+// Drives the core library's framing, checksum, dispatch, decoders, AIS encoding and sentence
+// formatting with representative messages, measuring the time and heap allocations of each
+class ActisenseBenchmark {
+
+public:
+	// Constructor and destructor
+	ActisenseBenchmark(void);
+	~ActisenseBenchmark(void);
+
+	// Create the device, with the in memory interface
+	int Init(void);
+
+	// Run the benchmarks whose name contains filter, all of them if it is empty
+	void Run(const wxString& filter);
+
+	const std::vector<BenchmarkResult>& GetResults(void) { return results; }
+
+	// Baselines are JSON, one benchmark per line
+	int SaveBaseline(const wxString& fileName);
+	// Count the benchmarks that are slower than the baseline by more than threshold percent, or allocate more
+	int CompareBaseline(const wxString& fileName, const int threshold, int *regressions);
+
+	// Heap allocations made by the process, counted by the benchmark's operator new
+	static unsigned long long GetAllocations(void);
+
+private:
+	ActisenseDevice *device;
+	ActisenseSubscription *subscription;
+	std::vector<BusMessagePtr> batch;
+	std::vector<BenchmarkResult> results;
+	wxString filter;
+
+	// A representative message for each PGN that the device decodes
+	typedef struct BenchmarkMessage {
+		unsigned int pgn;
+		std::vector<byte> payload;
+	} BenchmarkMessage;
+	std::vector<BenchmarkMessage> messages;
+
+	// Build the messages, and the Actisense N2K_RX_CMD frames and BST encoded stream that carry them
+	void BuildMessages(void);
+	static std::vector<byte> BuildFrame(const unsigned int pgn, const std::vector<byte>& payload);
+	static void AppendEscaped(std::vector<byte>& stream, const std::vector<byte>& frame);
+
+	// Time function, which performs operations operations, until it has run for CONST_BENCHMARK_PERIOD
+	void Measure(const wxString& name, const unsigned int operations, std::function<void(void)> function);
+
+	// Discard what the device published and wrote, so that the bus and the interface never fill
+	void Drain(void);
+
+	// The benchmarks
+	void RunFraming(void);
+	void RunChecksums(void);
+	void RunDispatch(void);
+	void RunDecoders(void);
+	void RunAIS(void);
+	void RunFormatting(void);
+
+	// Decode a message as ProcessMessage does, without the bookkeeping
+	bool Decode(const unsigned int pgn, const std::vector<byte>& payload, std::vector<wxString> *nmeaSentences);
+};
+
+#endif
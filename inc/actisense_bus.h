@@ -0,0 +1,216 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_BUS_H
+#define ACTISENSE_BUS_H
+
+#include "twocanerror.h"
+#include "twocanutils.h"
+#include "actisense_pgnfilter.h"
+// Typed messages, published alongside the payload
+#include "actisense_decode.h"
+// PGN classes, safety messages are delivered ahead of the others
+#include "actisense_queue.h"
+
+// wxWidgets
+// Mutex, only taken when subscribing and publishing, never by consumers
+#include <wx/thread.h>
+// Doorbell events
+#include <wx/event.h>
+#include <wx/string.h>
+// Logging subscriber statistics
+#include <wx/log.h>
+// Parsing lists of sentence types
+#include <wx/tokenzr.h>
+
+// STL
+#include <vector>
+#include <bitset>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+
+// Maximum number of subscribers
+#define CONST_BUS_SUBSCRIBERS 8
+// Default number of messages queued for each subscriber, must be a power of two
+#define CONST_SUBSCRIPTION_SIZE 512
+// Number of safety messages queued for each subscriber, in addition to the above
+#define CONST_SUBSCRIPTION_SAFETY_SIZE 64
+// Number of messages a consumer takes at a time
+#define CONST_BUS_BATCH 64
+
+// NMEA 0183 sentence types produced by the device, as bits in a SentenceMask
+#define SENTENCE_BOD 0
+#define SENTENCE_BWC 1
+#define SENTENCE_BWR 2
+#define SENTENCE_DBT 3
+#define SENTENCE_DPT 4
+#define SENTENCE_GGA 5
+#define SENTENCE_GLL 6
+#define SENTENCE_HDG 7
+#define SENTENCE_HDM 8
+#define SENTENCE_HDT 9
+#define SENTENCE_MTW 10
+#define SENTENCE_MWV 11
+#define SENTENCE_ROT 12
+#define SENTENCE_RPM 13
+#define SENTENCE_RSA 14
+#define SENTENCE_RTE 15
+#define SENTENCE_VDM 16
+#define SENTENCE_VHW 17
+#define SENTENCE_VLW 18
+#define SENTENCE_VTG 19
+#define SENTENCE_WCV 20
+#define SENTENCE_WPL 21
+#define SENTENCE_XDR 22
+#define SENTENCE_XTE 23
+#define SENTENCE_ZDA 24
+#define SENTENCE_TYPES 25
+
+typedef unsigned int SentenceMask;
+#define SENTENCE_MASK(type) (1U << (type))
+#define SENTENCE_MASK_ALL ((1U << SENTENCE_TYPES) - 1)
+
+// A received NMEA 2000 message and the NMEA 0183 sentences it produced. 
+// Shared by every subscriber and never modified once published
+typedef struct BusMessage {
+	CanHeader header;
+	std::vector<byte> payload;
+	DecodedMessage decoded; // decoded.pgn is 0 if the PGN has no typed decoder
+	std::vector<wxString> sentences; // complete, with checksum and CR LF
+	SentenceMask sentenceTypes; // of the sentences
+	unsigned int traceId; // non zero if the message is being traced, see ActisenseTracer
+} BusMessage;
+
+typedef std::shared_ptr<const BusMessage> BusMessagePtr;
+
+// What a subscriber wants to receive. An empty list, or no sources, matches everything.
+// The device only formats the sentence types that at least one subscriber wants
+typedef struct BusFilter {
+	std::vector<unsigned int> pgns;
+	std::bitset<CONST_GLOBAL_ADDRESS + 1> sources;
+	SentenceMask sentenceTypes; // SENTENCE_MASK_ALL, or 0 for raw messages only
+	bool sentencesOnly; // skip messages that did not produce a wanted sentence
+} BusFilter;
+
+// Backpressure, messages are dropped rather than stalling the publisher
+typedef struct SubscriptionStatistics {
+	unsigned long long delivered;
+	unsigned long long dropped;
+	size_t highWaterMark;
+} SubscriptionStatistics;
+
+// A single producer (the Actisense device), single consumer lock free queue of messages.
+// When a message is queued and the consumer has not yet been told, an event with eventId is queued to its handler, 
+// the consumer then calls Acknowledge followed by Receive until the queue is empty.
+// Safety PGN's (DSC, AIS safety messages and SAR reports) have their own ring which Receive drains first,
+// continuing the ActisenseQueue's safety lane through to delivery, so they are never held up behind bulk messages
+class ActisenseSubscription {
+
+public:
+	// Constructor and destructor
+	ActisenseSubscription(const wxString& name, const BusFilter& filter, const size_t capacity, wxEvtHandler *handler, const wxEventType eventType, const int eventId);
+	~ActisenseSubscription(void);
+
+	// Consumer
+	void Acknowledge(void);
+	size_t Receive(std::vector<BusMessagePtr>& batch, const size_t maximum);
+
+	wxString GetName(void) { return name; }
+	SubscriptionStatistics GetStatistics(void);
+
+private:
+	friend class ActisenseBus;
+
+	wxString name;
+	BusFilter filter;
+
+	typedef struct SubscriptionRing {
+		std::vector<BusMessagePtr> messages;
+		size_t mask;
+		std::atomic<size_t> head; // next to be written, by the producer
+		std::atomic<size_t> tail; // next to be read, by the consumer
+	} SubscriptionRing;
+
+	SubscriptionRing safetyRing;
+	SubscriptionRing normalRing;
+
+	// Notification
+	wxEvtHandler *handler;
+	wxEventType eventType;
+	int eventId;
+	std::atomic<bool> doorbell; // an event is outstanding
+
+	std::atomic<unsigned long long> delivered;
+	std::atomic<unsigned long long> dropped;
+	std::atomic<size_t> highWaterMark;
+
+	// Producer
+	bool Matches(const CanHeader& header, const SentenceMask sentenceTypes) const;
+	bool Push(const BusMessagePtr& message);
+
+	// Ring helpers
+	static void InitRing(SubscriptionRing *ring, const size_t capacity);
+	static size_t TakeRing(SubscriptionRing *ring, std::vector<BusMessagePtr>& batch, const size_t maximum);
+};
+
+// Fans out received messages to the subscribers whose filters match
+class ActisenseBus {
+
+public:
+	// Constructor and destructor
+	ActisenseBus(void);
+	~ActisenseBus(void);
+
+	// Subscriptions remain owned by the caller, and must be unsubscribed before they are deleted.
+	// Subscribers to raw messages have their PGN's enabled in the PGN filter
+	bool Subscribe(ActisenseSubscription *subscription);
+	void Unsubscribe(ActisenseSubscription *subscription);
+
+	// Called by the Actisense device thread. The message is only built if a subscriber wants it
+	void Publish(const CanHeader& header, const std::vector<byte>& payload, const DecodedMessage& decoded, const std::vector<wxString>& sentences, const SentenceMask sentenceTypes, const unsigned int traceId);
+
+	// Enable the PGN's that subscribers to raw messages want, called when the PGN filter is rebuilt
+	void EnableSubscribedPgns(void);
+
+	// Union of the sentence types wanted by the subscribers
+	SentenceMask GetWantedSentences(void) { return wantedSentences.load(std::memory_order_relaxed); }
+
+	// Sentence type (SENTENCE_) of a formatted sentence, NOT_FOUND if it is not one we produce
+	static int GetSentenceType(const wxString& sentence);
+	// Parse a comma separated list of sentence types, eg. "HDT,GLL,VTG". An empty list is all sentences
+	static SentenceMask ParseSentenceTypes(const wxString& sentenceTypes);
+
+private:
+	wxMutex busMutex;
+	ActisenseSubscription *subscriptions[CONST_BUS_SUBSCRIBERS];
+	std::atomic<int> subscriberCount;
+	std::atomic<SentenceMask> wantedSentences;
+
+	// Called with the mutex held
+	void UpdateWantedSentences(void);
+	void EnablePgns(const ActisenseSubscription *subscription);
+};
+
+// The message bus, between the Actisense device and consumers such as the OpenCPN plugin
+extern ActisenseBus messageBus;
+
+#endif
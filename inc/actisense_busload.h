@@ -0,0 +1,132 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_BUSLOAD_H
+#define ACTISENSE_BUSLOAD_H
+
+#include "twocanerror.h"
+#include "twocanutils.h"
+
+// wxWidgets
+#include <wx/thread.h>
+
+// STL
+#include <vector>
+#include <algorithm>
+
+// NMEA 2000 bit rate
+#define CONST_BUS_BIT_RATE 250000
+
+// Bits in an extended (29 bit identifier) CAN frame other than the data. Start of frame, identifier, 
+// SRR, IDE, RTR, reserved bits, DLC and CRC are subject to bit stuffing (54 bits), whereas
+// the CRC delimiter, ACK, end of frame and interframe space are not (13 bits)
+#define CONST_CAN_STUFFED_BITS 54
+#define CONST_CAN_UNSTUFFED_BITS 13
+
+// Milliseconds between updates of the decaying rates, and the weight given to the previous rate 
+// (a time constant of approximately 5 seconds)
+#define CONST_BUSLOAD_INTERVAL 1000
+#define CONST_BUSLOAD_DECAY 0.8
+
+// Every source address, including the global address
+#define CONST_BUSLOAD_SOURCES (CONST_GLOBAL_ADDRESS + 1)
+
+// Number of PGN's with their own counter. Once full, the least active PGN's counter is reused
+#define CONST_BUSLOAD_PGNS 128
+
+// Number of sources & PGN's in the ranked view
+#define CONST_TOP_TALKERS 20
+
+// The rate of a source or PGN
+typedef struct TalkerRate {
+	unsigned int id; // source address or PGN
+	double framesPerSecond;
+	double bitsPerSecond;
+	double share; // percentage of the total
+} TalkerRate;
+
+typedef struct BusLoadSnapshot {
+	double framesPerSecond;
+	double bitsPerSecond;
+	double utilisation; // percentage of CONST_BUS_BIT_RATE
+	double peakUtilisation;
+	std::vector<TalkerRate> sources; // busiest first
+	std::vector<TalkerRate> pgns;
+} BusLoadSnapshot;
+
+// Estimates the bus load from the messages that are received, counting the frames each message required and 
+// the worst case bit stuffing of each frame. Messages dropped by the PGN filter or the NGT-1's receive PGN list 
+// are not seen, so with either in use the estimate is a lower bound.
+// Updated by the device thread, and the ranked snapshot read by the settings dialog
+class ActisenseBusLoad {
+
+public:
+	// Constructor and destructor
+	ActisenseBusLoad(void);
+	~ActisenseBusLoad(void);
+
+	void Reset(void);
+
+	// Record a received message
+	void Record(const CanHeader& header, const size_t payloadLength, const bool isFastPacket);
+
+	// Decay the rates and publish the snapshot, once every CONST_BUSLOAD_INTERVAL
+	void Update(const unsigned long long now);
+
+	// A copy of the latest snapshot
+	void GetSnapshot(BusLoadSnapshot *busLoadSnapshot);
+
+	// Number of frames used to transmit a message, either a single frame, Fast Packet, or ISO Transport Protocol
+	static unsigned int CountFrames(const size_t payloadLength, const bool isFastPacket);
+
+	// Worst case length of a frame on the wire, including stuff bits
+	static unsigned int FrameBits(const size_t dataLength);
+
+private:
+	typedef struct RateCounter {
+		unsigned int id;
+		bool inUse;
+		unsigned int frames; // during the current interval
+		unsigned int bits;
+		double framesPerSecond; // decaying
+		double bitsPerSecond;
+	} RateCounter;
+
+	// Owned by the device thread
+	RateCounter total;
+	RateCounter sources[CONST_BUSLOAD_SOURCES];
+	RateCounter pgns[CONST_BUSLOAD_PGNS];
+	unsigned long long lastUpdate;
+	double peakUtilisation;
+
+	// Published for the settings dialog
+	wxMutex snapshotMutex;
+	BusLoadSnapshot snapshot;
+
+	RateCounter *FindPgn(const unsigned int pgn);
+	static void DecayCounter(RateCounter *counter, const double seconds);
+	static void Rank(const RateCounter *counters, const size_t count, const double totalBitsPerSecond, std::vector<TalkerRate>& talkers);
+};
+
+// The bus load estimator, shared by the device and the settings dialog
+extern ActisenseBusLoad busLoad;
+
+#endif
@@ -0,0 +1,59 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_CANDUMP_H
+#define ACTISENSE_CANDUMP_H
+
+#include "actisense_interface.h"
+
+// Name of the candump log file, in the user's documents folder
+#define CONST_CANDUMP_NAME _T("candump.log")
+
+// Implements a reader for Linux candump log files, raw CAN frames rather than Actisense messages.
+// Accepts both the candump -l format, (1542484935.123456) can0 09F80103#0102030405060708
+// and the default format, with or without a timestamp, can0  09F80103   [8]  01 02 03 04 05 06 07 08
+class ActisenseCanDump : public ActisenseInterface {
+
+public:
+	// Constructor and destructor
+	ActisenseCanDump(ActisenseQueue *messageQueue);
+	~ActisenseCanDump(void);
+
+	// Open and Close the log file
+	int Open(const wxString& fileName);
+	int Close(void);
+	void Read();
+	int Write(const unsigned int canId, const unsigned char payloadLength, const unsigned char *payload);
+
+protected:
+	// wxThread overridden functions
+	virtual wxThread::ExitCode Entry();
+	virtual void OnExit();
+
+private:
+	std::string logFileName;
+	std::ifstream logFileStream;
+
+	// Parse a line into a CAN_RX_CMD message. timestamp is -1 if the line has none
+	bool ParseLine(const std::string& line, std::vector<byte>& message, double *timestamp);
+};
+
+#endif
@@ -0,0 +1,138 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_DECODE_H
+#define ACTISENSE_DECODE_H
+
+#include "twocanerror.h"
+#include "twocanutils.h"
+
+// STL
+#include <vector>
+
+// Typed NMEA 2000 messages, as transmitted. Fields retain their NMEA 2000 resolution 
+// and "data not available" values, check them with TwoCanUtils::IsDataValid.
+// Decoded once per frame, then consumed by the NMEA 0183 formatters and any other outputs
+
+// PGN 127250 Vessel Heading. Angles 1e-4 radians
+typedef struct Heading {
+	byte sid;
+	unsigned short heading;
+	short deviation; // positive East
+	short variation; // positive East
+	byte reference; // HEADING_TRUE or HEADING_MAGNETIC
+} Heading;
+
+// PGN 129025 Position, Rapid Update. 1e-7 degrees, positive North & East
+typedef struct Position {
+	int latitude;
+	int longitude;
+} Position;
+
+// PGN 129026 COG & SOG, Rapid Update
+typedef struct CourseOverGround {
+	byte sid;
+	byte reference; // HEADING_TRUE or HEADING_MAGNETIC
+	unsigned short courseOverGround; // 1e-4 radians
+	unsigned short speedOverGround; // 0.01 m/s
+} CourseOverGround;
+
+// PGN 129029 GNSS Position Data, only the first reference station is retained
+typedef struct GnssFix {
+	byte sid;
+	unsigned short daysSinceEpoch;
+	unsigned int secondsSinceMidnight; // 1e-4 seconds
+	long long latitude; // 1e-16 degrees
+	long long longitude; // 1e-16 degrees
+	long long altitude; // 1e-6 metres
+	byte gnssType;
+	byte fixMethod; // 0 no fix, 1 GNSS, 2 DGNSS etc. as per the GGA quality indicator
+	byte fixIntegrity;
+	byte numberOfSatellites;
+	short hDOP; // 0.01
+	short pDOP; // 0.01
+	int geoidalSeparation; // 0.01 metres
+	byte referenceStations;
+	byte referenceStationType;
+	unsigned short referenceStationId;
+	unsigned short referenceStationAge; // 0.01 seconds
+} GnssFix;
+
+// PGN 129038 AIS Class A Position Report, AIS message types 1, 2 & 3
+typedef struct AisClassAReport {
+	byte messageId;
+	byte repeatIndicator;
+	unsigned int userId; // MMSI
+	int longitude; // 1e-7 degrees
+	int latitude; // 1e-7 degrees
+	byte positionAccuracy;
+	byte raimFlag;
+	byte timeStamp; // UTC second
+	unsigned short courseOverGround; // 1e-4 radians
+	unsigned short speedOverGround; // 0.01 m/s
+	unsigned int communicationState;
+	byte transceiverInformation;
+	unsigned short trueHeading; // 1e-4 radians
+	unsigned short rateOfTurn; // 3.125e-5 radians/second, 0xFFFF if not available
+	byte navigationalStatus;
+	byte manoeuverIndicator;
+	byte spare;
+	byte sequenceId;
+} AisClassAReport;
+
+// The decoded message, published with the payload so that subscribers need not decode it again.
+// pgn selects the member of the union that is valid, 0 if the message has no decoder or could not be decoded
+typedef struct DecodedMessage {
+	unsigned int pgn;
+	union {
+		Heading heading;
+		Position position;
+		CourseOverGround courseOverGround;
+		GnssFix gnssFix;
+		AisClassAReport aisClassAReport;
+	};
+} DecodedMessage;
+
+// Decoders fill the caller's struct, they neither allocate nor format.
+// Each returns FALSE if the payload is too short for the PGN
+class ActisenseDecode {
+
+public:
+	static bool DecodeHeading(const std::vector<byte>& payload, Heading *heading);
+	static bool DecodePosition(const std::vector<byte>& payload, Position *position);
+	static bool DecodeCourseOverGround(const std::vector<byte>& payload, CourseOverGround *courseOverGround);
+	static bool DecodeGnssFix(const std::vector<byte>& payload, GnssFix *gnssFix);
+	static bool DecodeAisClassAReport(const std::vector<byte>& payload, AisClassAReport *report);
+
+private:
+	// Little endian fields
+	static unsigned short GetUnsignedShort(const std::vector<byte>& payload, const size_t offset) {
+		return payload[offset] | (payload[offset + 1] << 8);
+	}
+	static unsigned int GetUnsignedInt(const std::vector<byte>& payload, const size_t offset) {
+		return payload[offset] | (payload[offset + 1] << 8) | (payload[offset + 2] << 16) | ((unsigned int)payload[offset + 3] << 24);
+	}
+	static long long GetLongLong(const std::vector<byte>& payload, const size_t offset) {
+		return (long long)GetUnsignedInt(payload, offset) | ((long long)GetUnsignedInt(payload, offset + 4) << 32);
+	}
+};
+
+#endif
@@ -36,6 +36,23 @@
 
 #include "actisense_ngt1.h"
 #include "actisense_ebl.h"
+#include "actisense_candump.h"
+#include "actisense_memory.h"
+#include "actisense_transport.h"
+#include "actisense_ngtstatus.h"
+#include "actisense_busload.h"
+#include "actisense_loss.h"
+#include "actisense_statistics.h"
+#include "actisense_trace.h"
+#include "actisense_profile.h"
+#include "actisense_decode.h"
+#include "actisense_bus.h"
+
+// Last value received for each (PGN, source)
+#include "actisense_lastvalue.h"
+
+// Heartbeat and data staleness deadlines
+#include "actisense_timerwheel.h"
 
 #ifdef __LINUX__
 // For logging to get time values
@@ -116,7 +133,7 @@ extern bool enableSignalK;
 extern int logLevel;
 
 // List of devices discovered on the NMEA 2000 network
-extern NetworkInformation networkMap[CONST_MAX_DEVICES];
+#include "actisense_network.h"
 
 // The uniqueID of this device (also used as the serial number)
 extern unsigned long uniqueId;
@@ -128,16 +145,32 @@ extern int networkAddress;
 extern wxMutex *debugMutex;
 
 // Buffer used to re-assemble sequences of multi frame Fast Packet messages
+// Entries are slots in an open addressed hash table, keyed by source, PGN & sequence identifier
 typedef struct FastMessageEntry {
 	byte IsFree; // indicate whether this entry is free
-	time_t timeArrived; // time of last message. garbage collector will remove stale entries
+	unsigned long long timeArrived; // monotonic time (msec) of last frame. garbage collector will remove stale entries
 	CanHeader header; // the header of the message. Used to "map" the incoming fast message fragments
 	unsigned int sid; // message sequence identifier, used to check if a received message is the next message in the sequence
 	unsigned int expectedLength; // total data length obtained from first frame
 	unsigned int cursor; // cursor into the current position in the below data
-	byte *data; // pointer to memory allocated for the data. Note: must be freed when IsFree is set to TRUE.
+	byte frameCounter; // the next frame expected
+	byte data[CONST_MAX_FAST_PACKET_LENGTH]; // inline, so no allocation per message
 } FastMessageEntry;
 
+// Used to arbitrate between the producers of the same NMEA 0183 sentence type,
+// eg. ZDA from 126992 & 129033, VTG from 129026 & 130577, or GGA from two GPS's
+typedef struct ArbitrationEntry {
+	unsigned int pgn; // PGN that last produced a sentence of this type, 0 if none
+	byte source; // and the device that transmitted it
+	int rank; // lower values are higher quality producers
+	unsigned long long timestamp; // monotonic time (msec) it was produced
+} ArbitrationEntry;
+
+// Timers in the timer wheel, one heartbeat timer per network address followed by a staleness timer for each monitored sentence,
+// then a timeout for each ISO Transport Protocol session, and finally the NGT-1 status query
+#define TIMER_HEARTBEAT 0
+#define TIMER_STALE_DATA CONST_NETWORK_ADDRESSES
+
 // Implements a NGT-1 device
 class ActisenseDevice : public wxThread {
 
@@ -149,23 +182,32 @@ public:
 	// Reference to event handler address, ie. the Actisense PlugIn
 	wxEvtHandler *eventHandlerAddress;
 
-	// wxMessage Queue to receive Frames from either the NGT-1 Device
-	wxMessageQueue<std::vector<byte>> *canQueue;
+	// Bounded queue to receive Frames from either the NGT-1 Device or the EBL Log Reader
+	ActisenseQueue *canQueue;
 
-	// Event raised when a NMEA 2000 message is received and converted to a NMEA 0183 sentence
-	void RaiseEvent(wxString sentence);
-	
 	// Initialize & DeInitialize the device.
 	// As we don't throw errors in the constructor, invoke functions that may fail from these functions
 	int Init(wxString driverPath);
 	int DeInit(void);
 
+	// The interface, NULL until initialized. Tools using CONST_MEMORY_READER feed their messages through it
+	ActisenseInterface *GetInterface(void) { return deviceInterface; }
+
+	// Parse the messages waiting in the queue on the caller's thread, for tools whose device thread is not run.
+	// Returns the number of messages parsed, their sentences have been published to the message bus
+	int ProcessPendingMessages(void);
+
 protected:
 	// wxThread overridden functions
 	virtual wxThread::ExitCode Entry();
 	virtual void OnExit();
 
 private:
+	// The micro benchmarks call the decoders and formatters directly
+	friend class ActisenseBenchmark;
+	// And the tests drive the reassembly and timestamp mapping directly
+	friend class ActisenseTest;
+
 	// BUG BUG replace with whatever format NGT-1 uses
 	byte canFrame[CONST_FRAME_LENGTH];
 
@@ -178,23 +220,55 @@ private:
 	// Functions to control the Actisense NGT-1 device
 	int ReadActisenseDriver(void);
 
+	// Parse a message taken from the queue, recording its decode and queue times
+	void ProcessQueuedMessage(const std::vector<byte>& receivedFrame);
+
 	// Heartbeat timer
 	wxTimer *heartbeatTimer;
 	void OnHeartbeat(wxEvent &event);
 	byte heartbeatCounter;
 
-	// Statistics
-	int receivedFrames;
-	int transmittedFrames;
-	int droppedFrames;
-	int fastFrames;
-	int errorFrames;
-	int standardFrames;
-	int averageProcessingTime;
-	int minimumProcessingTime;
-	int maximumProcessingTime;
+	// Statistics, frame counters and processing times are kept in deviceStatistics for the settings dialog
+	// PGN of the frame being parsed, CONST_OTHER_PGNS until known
+	unsigned int currentPgn;
+	// Trace of the frame being parsed, zero if it was not sampled
+	unsigned int currentTrace;
 	
-	wxDateTime droppedFrameTime;
+	// Lost messages, from gaps in each (source, PGN)'s sequence identifiers and rate
+	ActisenseLossTracker lossTracker;
+	unsigned long long droppedFrameTime; // start of the current CONST_DROPPEDFRAME_PERIOD
+	unsigned long long droppedFrameCount; // lost messages at that time
+
+	// Priority lane and time posted (monotonic usec) of the frame being parsed
+	int currentLane;
+	unsigned long long currentPostedTime;
+
+	// Per lane latency from the interface posting a frame until its NMEA 0183 sentence is raised
+	LaneStatistics deliveryStatistics[QUEUE_LANES];
+
+	// Adapter timestamp of the frame being parsed, mapped to host monotonic time (msec)
+	unsigned long long currentTimestamp;
+
+	// Latency (msec) from the adapter timestamping a frame until its NMEA 0183 sentence is raised.
+	// Measured relative to the least delayed frame, as the adapter's clock is only related to ours by the frames it sends
+	LaneStatistics adapterStatistics;
+
+	// Extending and mapping the adapter's 32 bit timestamps
+	bool adapterTimeValid;
+	unsigned int lastAdapterTime;
+	unsigned long long adapterEpoch; // multiple of CONST_ADAPTER_TIME_WRAP
+	long long adapterOffset; // host - adapter (msec)
+	long long windowOffset; // minimum offset seen in the current window
+	unsigned long long windowStart;
+
+	// NGT-1 responses, including the adapter's own count of frames it dropped
+	ActisenseNgtStatus ngtStatus;
+
+	// Extend an adapter timestamp to 64 bits and map it onto the host's monotonic clock
+	unsigned long long ConvertAdapterTimestamp(const unsigned int adapterTime, const unsigned long long hostTime);
+
+	// Record the latency of a sentence raised for the current frame
+	void UpdateDeliveryStatistics(void);
 	
 	// File handle for logging raw frame data
 	wxFile rawLogFile;
@@ -216,11 +290,15 @@ private:
 	// NMEA 2000 Product Information
 	ProductInformation productInformation;
 
+	// Extract a raw CAN frame (CAN_RX_CMD) posted by a non Actisense interface
+	void ParseRawFrame(const std::vector<byte>& receivedFrame);
+
 	// Determine whether frame is a single frame message or multiframe Fast Packet message
-	bool IsFastMessage(const CanHeader header);
+	static bool IsFastMessage(const CanHeader header);
 
 	// The Fast Packet buffer - used to reassemble Fast packet messages
 	FastMessageEntry fastMessages[CONST_MAX_MESSAGES];
+	int fastMessageCount;
 	
 	// Assemble sequence of Fast Messages into a payload
 	void AssembleFastMessage(const CanHeader header, const byte *message);
@@ -228,20 +306,64 @@ private:
 	// And its companion
 	int FragmentFastMessage(CanHeader *header, unsigned int payloadLength, byte *payload);
 
-	// Add, Append and Find entries in the FastMessage buffer
+	// Transmit a frame via the interface, counting it
+	int TransmitFrame(const unsigned int id, const unsigned char payloadLength, const unsigned char *payload);
+
+	// Add, Append, Find and Remove entries in the FastMessage buffer
 	void MapInitialize(void);
-	void MapLockRange(const int start, const int end);
-	int MapFindFreeEntry(void);
+	int MapFindFreeEntry(const CanHeader header, const unsigned int sid);
 	void MapInsertEntry(const CanHeader header, const byte *data, const int position);
 	int MapAppendEntry(const CanHeader header, const byte *data, const int position);
-	int MapFindMatchingEntry(const CanHeader header);
+	int MapFindMatchingEntry(const CanHeader header, const unsigned int sid);
+	void MapRemoveEntry(const int position);
 	int MapGarbageCollector(void);
+	int MapHash(const CanHeader header, const unsigned int sid);
+	unsigned long long lastGarbageCollection;
+
+	// ISO Transport Protocol (BAM and RTS/CTS) reassembly, for raw CAN frames
+	ActisenseTransport *transport;
 	
 	// Log received frames
 	void LogReceivedFrames(const CanHeader *header, const byte *frame);
 
-	// Big switch statement to determine which function is called to decode each received NMEA 2000 message
+	// Producers of NMEA 0183 sentences, indexed by SENTENCE_ type
+	ArbitrationEntry arbitrationTable[SENTENCE_TYPES];
+
+	// Whether a fresher or higher quality producer has already supplied this type of sentence
+	bool IsRedundantSentence(const CanHeader header, const int sentenceType);
+
+	// Record the PGN & source as the current producer of the sentence type
+	void UpdateArbitration(const CanHeader header, const int sentenceType);
+
+	// Following an address claim conflict, a producer's sentences are still its own at its new address
+	void ReassignArbitration(const byte previousAddress, const byte networkAddress);
+
+	// Heartbeat and data staleness supervision
+	ActisenseTimerWheel *timerWheel;
+	std::vector<int> expiredTimers;
+
+	// Push back the deadline for a device's next heartbeat
+	void ArmHeartbeatTimer(const byte deviceAddress, const unsigned int heartbeatInterval);
+
+	// Push back the staleness deadline of the sentence type, if it is monitored
+	void ArmStaleDataTimer(const int sentenceType);
+
+	// Advance the timer wheel, reporting devices that have missed their heartbeats and data that has gone stale
+	void SuperviseTimers(void);
+	// Copy the queue, serial port and adapter counters into the lock free device statistics
+	void SampleStatistics(void);
+
+	// Extract the NMEA 2000 message from a received Actisense message
 	void ParseMessage(std::vector<byte> receivedFrame);
+
+	// Big switch statement to determine which function is called to decode each received NMEA 2000 message
+	void ProcessMessage(const CanHeader header, const std::vector<byte>& payload);
+
+	// Typed message decoded by ProcessMessage, used by the NMEA 0183 formatters and published on the bus for other outputs
+	DecodedMessage decodedMessage;
+
+	// Sets decodedMessage.pgn to the PGN if it was decoded, otherwise 0, and returns whether it was
+	bool DecodeTyped(const CanHeader header, const bool isDecoded);
 	
 	// Decode PGN59392 ISO Acknowledgement
 	int DecodePGN59392(std::vector<byte> payload);
@@ -259,7 +381,7 @@ private:
 	bool DecodePGN126992(std::vector<byte> payload, std::vector<wxString> *nmeaSentences);
 	
 	// Decode PGN 126993 NMEA heartbeat
-	bool DecodePGN126993(const int source, std::vector<byte> payload);
+	bool DecodePGN126993(const int source, std::vector<byte> payload, unsigned int *heartbeatInterval);
 
 	// Decode PGN 126996 NMEA Product Information
 	int DecodePGN126996(std::vector<byte> payload, ProductInformation *product_Information);
@@ -267,8 +389,8 @@ private:
 	// Decode PGN 127245 NMEA Rudder
 	bool DecodePGN127245(std::vector<byte> payload, std::vector<wxString> *nmeaSentences);
 	
-	// Decode PGN 127250 NMEA Vessel Heading
-	bool DecodePGN127250(std::vector<byte> payload, std::vector<wxString> *nmeaSentences);
+	// Format PGN 127250 NMEA Vessel Heading
+	bool FormatHeading(const Heading& heading, std::vector<wxString> *nmeaSentences);
 
 	// Decode PGN 127251 NMEA Rate of Turn (ROT)
 	bool DecodePGN127251(std::vector<byte> payload, std::vector<wxString> *nmeaSentences);
@@ -300,20 +422,20 @@ private:
 	// Decode PGN 128275 Distance Log
 	bool DecodePGN128275(std::vector<byte> payload, std::vector<wxString> *nmeaSentences);
 
-	// Decode PGN 129025 NMEA Position Rapid Update
-	bool DecodePGN129025(std::vector<byte> payload, std::vector<wxString> *nmeaSentences);
+	// Format PGN 129025 NMEA Position Rapid Update
+	bool FormatPosition(const Position& position, std::vector<wxString> *nmeaSentences);
 
-	// Decode PGN 129026 NMEA COG SOG Rapid Update
-	bool DecodePGN129026(std::vector<byte> payload, std::vector<wxString> *nmeaSentences);
+	// Format PGN 129026 NMEA COG SOG Rapid Update
+	bool FormatCourseOverGround(const CourseOverGround& course, std::vector<wxString> *nmeaSentences);
 
-	// Decode PGN 129029 NMEA GNSS Position
-	bool DecodePGN129029(std::vector<byte> payload, std::vector<wxString> *nmeaSentences);
+	// Format PGN 129029 NMEA GNSS Position
+	bool FormatGnssFix(const GnssFix& gnssFix, std::vector<wxString> *nmeaSentences);
 
 	// Decode PGN 129033 NMEA Date & Time
 	bool DecodePGN129033(std::vector<byte> payload, std::vector<wxString> *nmeaSentences);
 
-	// Decode PGN 129038 AIS Class A Position Report
-	bool DecodePGN129038(std::vector<byte> payload, std::vector<wxString> *nmeaSentences);
+	// Format PGN 129038 AIS Class A Position Report
+	bool FormatAisClassAReport(const AisClassAReport& report, std::vector<wxString> *nmeaSentences);
 
 	// Deocde PGN 129039 AIS Class B Position Report
 	bool DecodePGN129039(std::vector<byte> payload, std::vector<wxString> *nmeaSentences);
@@ -402,9 +524,24 @@ private:
 	// Send NMEA 2000 Heartbeat
 	int SendHeartbeat(void);
 
-	// Appends '*' and Checksum to NMEA 183 Sentence prior to sending to OpenCPN
+	// Appends '*' and Checksum to NMEA 183 Sentence prior to publishing it
 	void SendNMEASentence(wxString sentence);
 
+	// Sentences produced by the message being processed, and their types
+	std::vector<wxString> publishedSentences;
+	SentenceMask publishedTypes;
+
+	// Sentence types wanted by the bus's subscribers, sampled as each message is processed
+	SentenceMask wantedSentences;
+	bool IsFormatWanted(const unsigned int pgn);
+
+	// Configure the interface's PGN filter
+	void BuildPgnFilter(void);
+	bool IsSentenceWanted(const int sentenceType);
+
+	// Publish the message and its sentences on the message bus
+	void PublishMessage(const CanHeader header, const std::vector<byte>& payload);
+
 	// Computes the NMEA 0183 XOR checksum
 	wxString ComputeChecksum(wxString sentence);
 
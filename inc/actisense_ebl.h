@@ -23,16 +23,21 @@
 
 #include "actisense_interface.h"
 
+// Assembles the messages from the bytes read from the log file
+#include "actisense_framer.h"
 
 // Whether to perform checksum calculation
 extern bool actisenseChecksum;
 
+// Milliseconds between messages, so that the log file is played back at roughly the rate it was recorded
+#define CONST_EBL_PLAYBACK_DELAY 5
+
 // Implements the Actisense EBL Log File Format Reader
 class ActisenseEBL : public ActisenseInterface {
 
 public:
 	// Constructor and destructor
-	ActisenseEBL(wxMessageQueue<std::vector<byte>> *messageQueue);
+	ActisenseEBL(ActisenseQueue *messageQueue);
 	~ActisenseEBL(void);
 
 	// Open and Close the log file
@@ -49,6 +54,9 @@ protected:
 private:
 	std::string logFileName;
 	std::ifstream logFileStream;
+
+	// Assembles the Actisense messages, running in the read thread
+	ActisenseFramer framer;
 };
 
 #endif
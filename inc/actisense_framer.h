@@ -0,0 +1,92 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_FRAMER_H
+#define ACTISENSE_FRAMER_H
+
+// Error constants and macros
+#include "twocanerror.h"
+
+// Constants, typedefs and utility functions for bit twiddling and array manipulation for NMEA 2000 messages
+#include "twocanutils.h"
+
+// Where the assembled messages are posted
+#include "actisense_queue.h"
+
+// Unwanted messages are discarded as soon as their PGN is known
+#include "actisense_pgnfilter.h"
+
+// Compile time profiling of the framing loop
+#include "actisense_profile.h"
+
+// STL
+#include <vector>
+#include <functional>
+
+// Assembles the DLE STX ... DLE ETX (or ESC BEMSTART ... ESC BEMEND) framed Actisense messages from a stream of bytes, 
+// removing the escape characters. Used by the NGT-1's read thread, the EBL log file reader, and by the in memory 
+// interface so that tools and benchmarks run the same code
+class ActisenseFramer {
+
+public:
+	// Constructor and destructor
+	ActisenseFramer(ActisenseQueue *queue);
+	~ActisenseFramer(void);
+
+	// Discard any partially received message
+	void Reset(void);
+
+	// Post each message completed by these bytes, timed from when they were read (GetMonotonicMicros)
+	void Process(const byte *data, const size_t length, const unsigned long long readTime);
+
+	// Optionally called after each message is posted, eg. the log file reader paces playback
+	void SetPostHook(std::function<void(void)> hook) { postHook = hook; }
+
+	// Statistics
+	unsigned long long GetPostedMessages(void) const { return postedMessages; }
+	unsigned long long GetResyncs(void) const { return resyncs; }
+	unsigned long long GetEscapeErrors(void) const { return escapeErrors; }
+	unsigned long long GetDiscardedBytes(void) const { return discardedBytes; }
+
+private:
+	ActisenseQueue *messageQueue;
+	std::function<void(void)> postHook;
+
+	// used to construct valid Actisense messages
+	std::vector<byte> assemblyBuffer;
+	// if we've found an ASCII Control Char DLE or ESC
+	bool isEscaped;
+	// if we've found an ASCII Control Char STX (preceded by a DLE)
+	// or a BEMSTART (preceded by an ESC)
+	bool msgStart;
+	// if we've found an ASCII Control Char ETX (also preceded by a DLE)
+	// or a BEMEND (preceded by an ESC)
+	bool msgComplete;
+	// if the message's PGN is not wanted, in which case the rest of it is not copied
+	bool isFiltered;
+
+	unsigned long long postedMessages;
+	unsigned long long resyncs; // partially received messages discarded
+	unsigned long long escapeErrors; // DLE or ESC followed by an unexpected character
+	unsigned long long discardedBytes; // received outside of any message
+};
+
+#endif
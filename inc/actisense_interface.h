@@ -24,6 +24,12 @@
 #include "twocanerror.h"
 #include "twocanutils.h"
 
+// Bounded queue of messages passed to the Actisense device
+#include "actisense_queue.h"
+
+// Drop unwanted PGN's before they are queued
+#include "actisense_pgnfilter.h"
+
 // wxWidgets
 // BUG BUG work out which ones we really need
 #include <wx/defs.h>
@@ -67,26 +73,47 @@
 #include <initializer_list>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 
 // global mutex used to control debug output (prevents interleaving of debug output)
 extern wxMutex *debugMutex;
 
+// Serial link statistics, for those interfaces attached to a serial port
+typedef struct SerialStatistics {
+	unsigned long long rxBytes;
+	unsigned int bytesPerSecond; // over the latest sample interval
+	unsigned int peakBytesPerSecond;
+	int utilisation; // percentage of the link's capacity
+	int peakUtilisation;
+	unsigned long long overruns; // UART overruns
+	unsigned long long bufferOverruns; // tty (driver) buffer overruns
+	unsigned long long framingErrors;
+	unsigned long long parityErrors;
+	unsigned long long resyncs; // partially received messages discarded
+	unsigned long long escapeErrors; // DLE or ESC followed by an unexpected character
+	unsigned long long discardedBytes; // received outside of any message
+} SerialStatistics;
+
 // abstract class for actisense interfaces (NGT-1 and EBL Log reader)
 class ActisenseInterface : public wxThread {
 
 public:
 	// Constructor and destructor
-	ActisenseInterface(wxMessageQueue<std::vector<byte>> *messageQueue);
+	ActisenseInterface(ActisenseQueue *messageQueue);
 	~ActisenseInterface(void);
 
 	// Reference to Actisense Device message queue
-	wxMessageQueue<std::vector<byte>> *deviceQueue;
+	ActisenseQueue *deviceQueue;
 	
 	// Functions to be overridden in derived classes
 	virtual int Open(const wxString& fileName);
 	virtual int Close(void);
 	virtual void Read();
 	virtual int Write(const unsigned int canId, const unsigned char payloadLength, const unsigned char *payload);
+	// Send a configuration command or status query to the adapter, if it has any
+	virtual int WriteCommand(const std::vector<byte>& command);
+	// The latest serial link statistics, FALSE if the interface is not attached to a serial port
+	virtual bool GetSerialStatistics(SerialStatistics *statistics);
 	
 	
 protected:
@@ -0,0 +1,99 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_LASTVALUE_H
+#define ACTISENSE_LASTVALUE_H
+
+#include "twocanerror.h"
+#include "twocanutils.h"
+
+// STL
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <cstring>
+
+// Number of (PGN, source) slots, must be a power of two
+#define CONST_LAST_VALUE_SLOTS 1024
+
+// Snapshot of the last frame received for a (PGN, source)
+typedef struct LastValue {
+	CanHeader header;
+	unsigned int length;
+	byte payload[CONST_MAX_FAST_PACKET_LENGTH];
+	unsigned long long sequence; // number of times this (PGN, source) has been received
+	unsigned long long timestamp; // monotonic time (msec) it was received
+} LastValue;
+
+// Retains the latest payload for each (PGN, source) so that slow consumers (GUI, loggers, network outputs)
+// read the current value rather than replaying every intermediate frame.
+// A single producer, the Actisense device thread, writes without locking. Each slot is protected
+// by a sequence lock, readers retry if the slot was written whilst they were copying it.
+class ActisenseLastValues {
+
+public:
+	// Constructor and destructor
+	ActisenseLastValues(void);
+	~ActisenseLastValues(void);
+
+	// Producer, only ever called from the one thread. Returns FALSE if the table is full,
+	// or the payload is longer than a Fast Packet, in which case it is counted but not stored
+	bool Update(const CanHeader header, const byte *payload, const unsigned int length, const unsigned long long timestamp);
+
+	// Consumers, any thread. Returns FALSE if nothing has been received for the (PGN, source)
+	bool Read(const unsigned int pgn, const byte source, LastValue *value);
+
+	// Consumers, any thread. Returns the latest snapshot of each slot updated since the consumer last called.
+	// cursor is owned by the consumer, it records the sequence last read from each slot
+	size_t ReadUpdates(std::vector<unsigned long long>& cursor, std::vector<LastValue>& updates);
+
+	// Incremented on every update, so a consumer can cheaply determine whether anything has changed
+	unsigned long long GetGeneration(void) { return generation.load(std::memory_order_acquire); }
+
+	// Frames that could not be stored because the table is full
+	unsigned long long GetOverflows(void) { return overflows.load(std::memory_order_relaxed); }
+
+	// ISO Transport Protocol messages that are too long to be stored
+	unsigned long long GetOversized(void) { return oversized.load(std::memory_order_relaxed); }
+
+private:
+	typedef struct LastValueSlot {
+		std::atomic<unsigned int> key; // ((PGN << 8) | source) + 1, zero if the slot is unused
+		std::atomic<unsigned int> lock; // odd whilst the producer is writing
+		LastValue value;
+	} LastValueSlot;
+
+	LastValueSlot *slots;
+	std::atomic<unsigned long long> generation;
+	std::atomic<unsigned long long> overflows;
+	std::atomic<unsigned long long> oversized;
+
+	// Index of the slot holding a key, or if create is TRUE, the slot it should be inserted into. NOT_FOUND if neither
+	int FindSlot(const unsigned int key, const bool create);
+
+	// Copy a slot, retrying if it is overwritten in the meantime
+	bool ReadSlot(const int index, LastValue *value);
+};
+
+// The last values, shared by the device and any consumers
+extern ActisenseLastValues lastValues;
+
+#endif
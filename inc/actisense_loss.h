@@ -0,0 +1,107 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_LOSS_H
+#define ACTISENSE_LOSS_H
+
+#include "twocanerror.h"
+#include "twocanutils.h"
+
+// STL
+#include <vector>
+#include <algorithm>
+
+// Number of (source, PGN) pairs that are tracked. Must be a power of two, as it is an open addressed hash table
+#define CONST_LOSS_ENTRIES 256
+
+// Sequence identifiers are 0 - 252, 253 & 254 are reserved and 255 is not available
+#define CONST_SID_RANGE 253
+
+// A larger jump in the sequence identifier is taken to be a restart, rather than lost messages
+#define CONST_MAX_SID_GAP 16
+
+// Fast Packet sequence counters are 3 bits
+#define CONST_FAST_PACKET_SEQUENCES 8
+
+// A message is late, and those in between are assumed lost, once its interval exceeds 1.5 times the expected period. 
+// After CONST_RATE_TIMEOUT the transmitter is assumed to have stopped, rather than its messages lost
+#define CONST_RATE_TIMEOUT (10 * CONST_ONE_SECOND)
+
+// Messages received and lost for a (source, PGN)
+typedef struct LossEntry {
+	unsigned int pgn;
+	byte source;
+	bool inUse;
+	int lastSid; // -1 until received
+	int lastSequence; // Fast Packet sequence counter, -1 until received
+	unsigned long long lastTimestamp; // msec
+	unsigned long long received;
+	unsigned long long sidGaps; // missing from the sequence identifiers
+	unsigned long long sequenceGaps; // missing from the Fast Packet sequence counters
+	unsigned long long incomplete; // Fast Packets with missing frames
+	unsigned long long late; // missing from the expected rate
+	unsigned long long lost; // the best estimate from the above
+} LossEntry;
+
+// Detects lost messages per (source, PGN) from gaps in the sequence identifier (SID), the Fast Packet
+// sequence counter and, for PGN's without a SID, intervals longer than the PGN's expected period.
+// Heuristic, as transmitters may repeat a SID, share one across PGN's or transmit less often than the standard rate.
+// Used only by the device thread
+class ActisenseLossTracker {
+
+public:
+	// Constructor and destructor
+	ActisenseLossTracker(void);
+	~ActisenseLossTracker(void);
+
+	void Reset(void);
+
+	// A complete message, timestamp in msec
+	void Record(const CanHeader& header, const std::vector<byte>& payload);
+
+	// The first frame of a Fast Packet from a raw CAN interface
+	void RecordSequence(const CanHeader& header, const unsigned int sequence);
+
+	// A Fast Packet discarded with missing frames
+	void RecordIncomplete(const CanHeader& header);
+
+	unsigned long long GetLostMessages(void) { return lostMessages; }
+	unsigned long long GetReceivedMessages(void) { return receivedMessages; }
+	// (source, PGN) pairs not tracked as the table was full
+	unsigned long long GetOverflows(void) { return overflows; }
+
+	// Entries that have lost messages, highest loss ratio first
+	void GetLosses(std::vector<LossEntry>& losses, const size_t maximum);
+
+	static double LossRatio(const LossEntry& entry);
+
+private:
+	LossEntry entries[CONST_LOSS_ENTRIES];
+	int entryCount;
+	unsigned long long receivedMessages;
+	unsigned long long lostMessages;
+	unsigned long long overflows;
+
+	LossEntry *FindEntry(const CanHeader& header);
+	void AddLost(LossEntry *entry, const unsigned long long lost);
+};
+
+#endif
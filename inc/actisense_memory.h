@@ -0,0 +1,80 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_MEMORY_H
+#define ACTISENSE_MEMORY_H
+
+#include "actisense_interface.h"
+
+// Assembles the messages from the bytes that are fed in
+#include "actisense_framer.h"
+
+// A frame written by the device
+typedef struct MemoryFrame {
+	unsigned int id;
+	std::vector<byte> payload;
+} MemoryFrame;
+
+// In memory interface, for tools and benchmarks that link the core library rather than load the plugin.
+// The caller feeds it the bytes an NGT-1 would have sent, which are framed and queued on the caller's thread,
+// and it keeps the frames and commands the device writes. Not listed in the settings dialog
+class ActisenseMemory : public ActisenseInterface {
+
+public:
+	// Constructor and destructor
+	ActisenseMemory(ActisenseQueue *messageQueue);
+	~ActisenseMemory(void);
+
+	// Overridden functions, there is nothing to open
+	int Open(const wxString& fileName);
+	int Close(void);
+	void Read();
+	int Write(const unsigned int canId, const unsigned char payloadLength, const unsigned char *payload);
+	int WriteCommand(const std::vector<byte>& command);
+
+	// Frame the bytes and post the messages to the device's queue, before returning
+	void Feed(const byte *data, const size_t length);
+	void Feed(const std::vector<byte>& data);
+
+	// Messages posted to the device's queue
+	unsigned long long GetPostedMessages(void);
+
+	// Take the frames and commands written by the device since the last call
+	void TakeWrittenFrames(std::vector<MemoryFrame>& frames);
+	void TakeWrittenCommands(std::vector<std::vector<byte>>& commands);
+
+protected:
+	// wxThread overridden functions
+	virtual wxThread::ExitCode Entry();
+	virtual void OnExit();
+
+private:
+	// Feed may be called from any thread, but only one at a time
+	wxMutex feedMutex;
+	ActisenseFramer framer;
+
+	// Written by the device thread, taken by the caller
+	wxMutex writeMutex;
+	std::vector<MemoryFrame> writtenFrames;
+	std::vector<std::vector<byte>> writtenCommands;
+};
+
+#endif
@@ -0,0 +1,122 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_METRICS_H
+#define ACTISENSE_METRICS_H
+
+// Pre compiled headers 
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+
+// Error constants and macros
+#include "twocanerror.h"
+
+// Constants, typedefs and utility functions for bit twiddling and array manipulation for NMEA 2000 messages
+#include "twocanutils.h"
+
+// Frame counters, queue, serial port and adapter statistics and the processing time histograms
+#include "actisense_statistics.h"
+
+// SerialStatistics
+#include "actisense_interface.h"
+
+// Frames dropped by the PGN filter
+#include "actisense_pgnfilter.h"
+
+// Sampled frame latencies
+#include "actisense_trace.h"
+
+// The latest message from each device for each PGN
+#include "actisense_lastvalue.h"
+
+// wxWidgets
+// Listens in its own thread
+#include <wx/thread.h>
+
+// Sockets
+#include <wx/socket.h>
+
+// Logging (Info & Errors)
+#include <wx/log.h>
+
+// Removing a stale Unix domain socket
+#include <wx/filefn.h>
+
+// STL
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+
+// Default TCP port, the Prometheus exporter port allocated to OpenTelemetry
+#define CONST_METRICS_PORT 9464
+
+// How long to wait for a scraper to connect before checking whether the thread is to exit (msec)
+#define CONST_METRICS_ACCEPT_TIMEOUT 500
+
+// Longest request header that is read, the remainder is ignored
+#define CONST_METRICS_REQUEST_SIZE 1024
+
+// Whether the metrics endpoint is enabled, its TCP port and Unix domain socket path (Linux only, used instead of the port if set).
+// No UI, set manually in the config file
+extern bool enableMetrics;
+extern int metricsPort;
+extern wxString metricsSocket;
+
+// Serves the device statistics in the Prometheus text exposition format (http://<host>:<port>/metrics).
+// Only bound to localhost or a Unix domain socket, and only reads atomics, so a scrape never holds up the device
+class ActisenseMetrics : public wxThread {
+
+public:
+	// Constructor and destructor
+	ActisenseMetrics(void);
+	~ActisenseMetrics(void);
+
+	// Bind the listening socket. As we don't throw errors in the constructor, invoke functions that may fail from here
+	int Init(void);
+	int DeInit(void);
+
+	// The metrics page, separate from the server so it may be used elsewhere
+	static std::string FormatMetrics(void);
+
+protected:
+	// wxThread overridden functions
+	virtual wxThread::ExitCode Entry();
+	virtual void OnExit();
+
+private:
+	wxSocketServer *metricsServer;
+
+	// Read the request and reply with either the metrics or not found
+	void ServeRequest(wxSocketBase *client);
+
+	// Append a single valued counter or gauge
+	static void AppendMetric(std::string& page, const char *name, const char *type, const char *help, const unsigned long long value);
+	// Append a histogram of times, converting from microseconds to the seconds favoured by Prometheus
+	static void AppendHistogram(std::string& page, const char *name, const char *help, const ActisenseHistogram& histogram);
+	// Append the message count and age of each PGN from each source, labelled by PGN and source
+	static void AppendLastValues(std::string& page);
+};
+
+#endif
@@ -0,0 +1,100 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_NETWORK_H
+#define ACTISENSE_NETWORK_H
+
+#include "twocanerror.h"
+#include "twocanutils.h"
+
+// STL
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <unordered_map>
+
+// Number of devices remembered, including those that have since left the network
+#define CONST_REGISTRY_SIZE 512
+
+// Number of network addresses, 0 - 253 may be claimed, 254 is the NULL address and 255 the global address
+#define CONST_NETWORK_ADDRESSES 256
+
+// Registry of the devices discovered on the NMEA 2000 network, keyed by their 64 bit NAME, so that a device
+// retains its product information, heartbeat interval and statistics when an address claim conflict moves it
+// to another address. An address table maps each network address to the device currently using it.
+// Written only by the Actisense device thread, read by the settings dialog and other consumers.
+// The time a device was last seen and its frame count are updated on every frame, so they are separate atomics
+// rather than part of the entry protected by the sequence lock, which is only written by claims, product information etc.
+class ActisenseNetworkMap {
+
+public:
+	// Constructor and destructor
+	ActisenseNetworkMap(void);
+	~ActisenseNetworkMap(void);
+
+	// Writers, the device thread only
+	// A frame has been received from the address, timestamp is monotonic msec
+	void Touch(const byte networkAddress, const unsigned long long timestamp);
+	// A device has claimed the address. Returns the address it previously used, 
+	// or CONST_NULL_ADDRESS if it is a new device or has not moved
+	byte UpdateAddressClaim(const byte networkAddress, const DeviceInformation *deviceInformation);
+	void UpdateProductInformation(const byte networkAddress, const ProductInformation *productInformation);
+	void UpdateHeartbeat(const byte networkAddress, const unsigned int heartbeatInterval);
+	void ExpireHeartbeat(const byte networkAddress);
+
+	// Readers, any thread. Returns a consistent copy of the entry, with timestamp set to when the device was last seen
+	// By the device currently using a network address
+	bool Read(const byte networkAddress, NetworkInformation *networkInformation);
+	// Or by registry slot, to iterate over every device including those that have left the network
+	bool ReadSlot(const int slot, NetworkInformation *networkInformation);
+	unsigned long long GetLastSeen(const byte networkAddress);
+
+private:
+	typedef struct RegistryEntry {
+		NetworkInformation information;
+		std::atomic<unsigned int> lock; // odd whilst the information is being written
+		std::atomic<bool> inUse;
+		std::atomic<unsigned long long> lastSeen;
+		std::atomic<unsigned long long> receivedFrames;
+	} RegistryEntry;
+
+	RegistryEntry *registry;
+
+	// Network address to registry slot, NOT_FOUND if no device is using the address
+	std::atomic<int> addressSlots[CONST_NETWORK_ADDRESSES];
+
+	// NAME to registry slot, only used by the device thread
+	std::unordered_map<unsigned long long, int> nameSlots;
+
+	// Slot for a device whose address claim has not yet been seen
+	int GetAnonymousSlot(const byte networkAddress);
+	// Find a free slot, or reuse the one that has been gone longest
+	int AllocateSlot(void);
+	void FreeSlot(const int slot);
+
+	void BeginWrite(const int slot);
+	void EndWrite(const int slot);
+};
+
+// List of devices discovered on the NMEA 2000 network
+extern ActisenseNetworkMap networkMap;
+
+#endif
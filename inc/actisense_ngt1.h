@@ -24,6 +24,9 @@
 
 #include "actisense_interface.h"
 
+// Assembles the messages from the bytes read from the serial port
+#include "actisense_framer.h"
+
 #ifdef __WXMSW__
 #define WINDOWS_LEAN_AND_MEAN
 #include <windows.h>
@@ -33,6 +36,8 @@
 #ifdef __LINUX__
 #include <termios.h>
 #include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
 #include <wx/dir.h>
 #include <wx/textfile.h>
 #include <wx/file.h>
@@ -41,12 +46,50 @@
 
 extern bool actisenseChecksum;
 
+// Whether to program the NGT-1's receive PGN enable list, no UI, set manually in the config file
+extern bool adapterFilter;
+
+// NGT-1 configuration commands, the first byte of an NGT_TX_CMD message
+#define NGT_CMD_OPERATING_MODE 0x11
+#define NGT_CMD_RX_PGN_ENABLE 0x46
+#define NGT_CMD_DELETE_PGN_LIST 0x4A
+#define NGT_CMD_ACTIVATE_PGN_LISTS 0x4B
+// Sent without any data, queries the adapter's status. Refer to ActisenseNgtStatus for the response
+#define NGT_CMD_SYSTEM_STATUS 0xF2
+
+// Operating modes, either only the PGN's in the receive PGN enable list or every PGN
+#define NGT_MODE_RX_LIST 0x0001
+#define NGT_MODE_RX_ALL 0x0002
+
+// Which list is deleted by NGT_CMD_DELETE_PGN_LIST
+#define NGT_LIST_RX 0x00
+
+// Beyond this many PGN's, the adapter is left to receive everything
+#define CONST_NGT_MAX_RX_PGNS 100
+
+// Milliseconds between configuration commands, so as not to overrun the adapter's input buffer
+#define CONST_NGT_COMMAND_DELAY 10
+
+// Milliseconds the PGN filter must be unchanged before the receive PGN list is reprogrammed,
+// so that a filter being rebuilt, or several subscribers being added, is only programmed once
+#define CONST_NGT_FILTER_SETTLE 250
+
+// The NGT-1's factory default baud rate. Each byte is 10 bits on the wire, start, 8 data and stop bits
+#define CONST_NGT_BAUD_RATE 115200
+#define CONST_SERIAL_BITS_PER_BYTE 10
+
+// Milliseconds between samples of the serial port's error counters and throughput
+#define CONST_SERIAL_SAMPLE_INTERVAL 1000
+
+// Milliseconds between System Status queries
+#define CONST_NGT_STATUS_INTERVAL 5000
+
 // Implements the EBL NGT1 interface
 class ActisenseNGT1 : public ActisenseInterface {
 
 public:
 	// Constructor and destructor
-	ActisenseNGT1(wxMessageQueue<std::vector<byte>> *messageQueue);
+	ActisenseNGT1(ActisenseQueue *messageQueue);
 	~ActisenseNGT1(void);
 	
 	// Open and Close the NGT-1 interface
@@ -55,6 +98,10 @@ public:
 	int Close(void);
 	void Read();
 	int Write(const unsigned int canId, const unsigned char payloadLength, const unsigned char *payload);
+	// Frame an NGT_TX_CMD message (length, checksum & DLE escaping) and send it to the adapter
+	int WriteCommand(const std::vector<byte>& command);
+	static void EncodeCommand(const std::vector<byte>& command, std::vector<byte>& writeBuffer);
+	bool GetSerialStatistics(SerialStatistics *statistics);
 
 protected:
 	// wxThread overridden functions
@@ -64,12 +111,38 @@ protected:
 private:
 	wxString portName;
 	int ConfigureAdapter(void);
+	// Program the receive PGN enable list from the PGN filter
+	int ConfigureRxPgns(void);
+	// Called by the read thread, reprograms the receive PGN list when the PGN filter changes and 
+	// sends the configuration commands one at a time, so that reading is never held up
+	void ServiceRxPgns(const unsigned long long now);
+	std::deque<std::vector<byte>> pendingCommands;
+	unsigned long long lastCommand;
+	unsigned int programmedGeneration;
+	unsigned int observedGeneration;
+	unsigned long long generationChanged;
+	// Whether the adapter has been left receiving only the PGN's in its list
+	bool isListActive;
 	int ConfigurePort(void);
 	wxFile logFile;
+
+	// Assembles the Actisense messages, running in the read thread
+	ActisenseFramer framer;
+
+	// Serial link statistics, maintained by the read thread and copied to serialStatistics each sample interval
+	SerialStatistics readerStatistics;
+	SerialStatistics serialStatistics;
+	wxMutex statisticsMutex;
+	unsigned long long lastSample;
+	unsigned long long lastSampleBytes;
+	void SampleSerialCounters(const unsigned long long now);
 	
 	// Serial port handle
 #ifdef __LINUX__
 	int serialPortHandle;
+	// Kernel serial counters (TIOCGICOUNT) at the previous sample, not every driver supports them
+	struct serial_icounter_struct lastCounters;
+	bool hasCounters;
 	int FindTTYDevice(wxString& ttyDevice, const int vid, const int pid);
 #endif
 
@@ -0,0 +1,88 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_NGTSTATUS_H
+#define ACTISENSE_NGTSTATUS_H
+
+#include "twocanerror.h"
+#include "twocanutils.h"
+
+// wxWidgets
+#include <wx/log.h>
+
+// STL
+#include <vector>
+#include <algorithm>
+
+// NGT-1 responses (NGT_RX_CMD), identified by the first byte following the length
+#define NGT_MSG_OPERATING_MODE 0x11
+#define NGT_MSG_STARTUP_STATUS 0xF0
+#define NGT_MSG_ERROR_REPORT 0xF1
+#define NGT_MSG_SYSTEM_STATUS 0xF2
+
+// Every response starts with the response id, SID, model id (2 bytes), serial number (4 bytes) and error code (4 bytes)
+#define CONST_NGT_RESPONSE_HEADER 12
+
+// Bytes per channel in the System Status. Independent (CAN) channels report Rx bandwidth, Rx load, Rx filtered, 
+// Rx dropped, Tx bandwidth and Tx load. Unified (buffer) channels report bandwidth, deleted, buffer & pointer loading
+#define CONST_NGT_INDI_CHANNEL_LENGTH 6
+#define CONST_NGT_UNI_CHANNEL_LENGTH 4
+
+// The adapter's view of the traffic, from its periodic System Status responses. 
+// Loads are percentages from the latest response, counts are totalled over all responses
+typedef struct NgtStatistics {
+	unsigned long long responses;
+	unsigned long long statusReports;
+	unsigned long long invalidResponses; // too short or failed the checksum
+	unsigned long long rxFiltered; // frames the adapter's receive PGN list discarded
+	unsigned long long rxDropped; // frames the adapter could not buffer
+	unsigned long long deleted; // messages deleted from the adapter's buffers, not sent over the serial link
+	int rxLoad;
+	int maximumRxLoad;
+	int txLoad;
+	int bufferLoading;
+	int maximumBufferLoading;
+	unsigned int errorCode;
+	unsigned int operatingMode;
+	unsigned int modelId;
+	unsigned int serialNumber;
+} NgtStatistics;
+
+// Decodes the NGT-1's responses to configuration commands and status queries
+class ActisenseNgtStatus {
+
+public:
+	// Constructor and destructor
+	ActisenseNgtStatus(void);
+	~ActisenseNgtStatus(void);
+
+	// receivedFrame is the complete NGT_RX_CMD message, command, length, data and checksum
+	void ProcessResponse(const std::vector<byte>& receivedFrame);
+
+	NgtStatistics GetStatistics(void) { return statistics; }
+
+private:
+	NgtStatistics statistics;
+
+	void DecodeSystemStatus(const byte *data, const size_t length);
+};
+
+#endif
@@ -0,0 +1,82 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_PGNFILTER_H
+#define ACTISENSE_PGNFILTER_H
+
+#include "twocanerror.h"
+#include "twocanutils.h"
+
+// STL
+#include <vector>
+#include <atomic>
+
+// PGN's are 18 bits (data page and PDU format & specific)
+#define CONST_PGN_SPACE (1 << 18)
+#define CONST_PGN_MASK (CONST_PGN_SPACE - 1)
+
+// Number of bytes of an Actisense N2K_RX_CMD message required to peek at its PGN
+#define CONST_PEEK_LENGTH 6
+
+// One bit per PGN, set if any part of the plugin wants the PGN. 
+// Built by the Actisense device, and read by the interfaces so that they can drop unwanted frames 
+// as soon as their PGN has been received, before copying them into the queue
+class ActisensePgnFilter {
+
+public:
+	// Constructor and destructor, initially every PGN is enabled
+	ActisensePgnFilter(void);
+	~ActisensePgnFilter(void);
+
+	void EnableAll(void);
+	void DisableAll(void);
+	void Enable(const unsigned int pgn);
+
+	bool IsEnabled(const unsigned int pgn) const {
+		return ((bitmap[(pgn & CONST_PGN_MASK) >> 5].load(std::memory_order_relaxed) >> (pgn & 0x1F)) & 1) != 0;
+	}
+
+	// Whether every PGN is enabled, eg. when a subscriber wants raw messages
+	bool IsAllEnabled(void) const;
+	// The enabled PGN's, in ascending order. Used to program the NGT-1's own receive PGN list
+	void GetEnabledPgns(std::vector<unsigned int>& pgns) const;
+
+	// Whether a partially received Actisense message is wanted, once CONST_PEEK_LENGTH bytes have been received.
+	// Messages other than received NMEA 2000 messages (N2K_RX_CMD) are always wanted
+	bool IsEnabled(const std::vector<byte>& message) const;
+
+	// Incremented whenever the set of enabled PGN's changes, so that an interface can tell when to reprogram its adapter
+	unsigned int GetGeneration(void) const { return generation.load(std::memory_order_acquire); }
+
+	// Interfaces count the frames they drop
+	void CountFiltered(void) { filteredFrames.fetch_add(1, std::memory_order_relaxed); }
+	unsigned long long GetFilteredFrames(void) { return filteredFrames.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<unsigned int> bitmap[CONST_PGN_SPACE / 32];
+	std::atomic<unsigned long long> filteredFrames;
+	std::atomic<unsigned int> generation;
+};
+
+// The PGN filter, shared by the Actisense device and its interface
+extern ActisensePgnFilter pgnFilter;
+
+#endif
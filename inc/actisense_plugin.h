@@ -44,6 +44,9 @@
 // Actisense device, which is our implementation of a NMEA 2000 device
 #include "actisense_device.h"
 
+// Prometheus metrics endpoint
+#include "actisense_metrics.h"
+
 // BUG BUG check which wxWidget includes we really need
 #include <wx/arrstr.h> 
 
@@ -103,10 +106,19 @@ private:
 	// NMEA 0183 sentence received events
 	void OnSentenceReceived(wxCommandEvent &event);
 
+	// Our subscription to the message bus, and the messages being pushed to OpenCPN
+	ActisenseSubscription *sentenceSubscription;
+	std::vector<BusMessagePtr> sentenceBatch;
+
 	// Actisense Device, either EBL Log reader or NGT-1 device
 	void StartDevice(void);
 	void StopDevice(void);
 
+	// Metrics endpoint, runs for the lifetime of the plugin as it is only configured from the config file
+	ActisenseMetrics *metricsServer;
+	void StartMetrics(void);
+	void StopMetrics(void);
+
 };
 
 #endif 
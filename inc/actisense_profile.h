@@ -0,0 +1,133 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_PROFILE_H
+#define ACTISENSE_PROFILE_H
+
+// Pre compiled headers 
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+
+// Error constants and macros
+#include "twocanerror.h"
+
+// wxWidgets
+// Guards the list of per thread profiles
+#include <wx/thread.h>
+
+// Collapsed stack file
+#include <wx/file.h>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+
+// Logging (Info & Errors)
+#include <wx/log.h>
+
+// STL
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+
+// Collapsed stacks, written to the Documents folder when the device stops
+#define CONST_PROFILE_FILE "actisense_profile.folded"
+
+// Profiling scopes are only compiled when the ACTISENSE_PROFILE cmake option is set, otherwise they cost nothing.
+// The name must be a string literal (or __func__), as scopes are matched by the name's address
+#ifdef ACTISENSE_PROFILE
+#define ACTISENSE_PROFILE_CONCAT(a, b) a##b
+#define ACTISENSE_PROFILE_NAME(line) ACTISENSE_PROFILE_CONCAT(profileScope, line)
+#define ACTISENSE_PROFILE_SCOPE(name) ActisenseProfileScope ACTISENSE_PROFILE_NAME(__LINE__)(name)
+#define ACTISENSE_PROFILE_FUNCTION() ACTISENSE_PROFILE_SCOPE(__func__)
+#define ACTISENSE_PROFILE_THREAD(name) ActisenseProfiler::SetThreadName(name)
+#else
+#define ACTISENSE_PROFILE_SCOPE(name)
+#define ACTISENSE_PROFILE_FUNCTION()
+#define ACTISENSE_PROFILE_THREAD(name)
+#endif
+
+// Call tree of the profiling scopes entered by a thread, with the time spent in each.
+// Only the owning thread updates its tree, so recording takes no locks
+class ActisenseProfiler {
+
+public:
+	// The calling thread's profile, created when the thread first enters a scope
+	static ActisenseProfiler *GetThreadProfiler(void);
+	// Name of the calling thread, the root of its stacks
+	static void SetThreadName(const char *name);
+
+	// Returns the node, which is passed back on exit
+	int Enter(const char *name);
+	void Exit(const int node, const unsigned long long elapsed);
+
+	// Write every thread's stacks, with their self time in nanoseconds, in the collapsed format read by
+	// flamegraph.pl, speedscope and others. Only called when the profiled threads have stopped
+	static int WriteCollapsedStacks(const wxString& fileName);
+
+private:
+	ActisenseProfiler(void);
+
+	typedef struct ProfileNode {
+		const char *name;
+		int parent;
+		unsigned long long calls;
+		unsigned long long elapsed; // nanoseconds, including the children
+		std::vector<int> children;
+	} ProfileNode;
+
+	// Node zero is the thread itself
+	std::vector<ProfileNode> nodes;
+	int currentNode;
+	std::string threadName;
+
+	static thread_local ActisenseProfiler *threadProfiler;
+
+	// Every thread's profile, they outlive their threads so that they may be written once the threads have exited
+	static wxMutex profilersMutex;
+	static std::vector<ActisenseProfiler *> profilers;
+
+	void AppendStacks(wxFile& file, const int node, const std::string& stack);
+};
+
+// Times its enclosing block
+class ActisenseProfileScope {
+
+public:
+	explicit ActisenseProfileScope(const char *name) {
+		profiler = ActisenseProfiler::GetThreadProfiler();
+		node = profiler->Enter(name);
+		start = std::chrono::steady_clock::now();
+	}
+
+	~ActisenseProfileScope(void) {
+		profiler->Exit(node, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+	}
+
+private:
+	ActisenseProfiler *profiler;
+	int node;
+	std::chrono::steady_clock::time_point start;
+};
+
+#endif
@@ -0,0 +1,150 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+#ifndef ACTISENSE_QUEUE_H
+#define ACTISENSE_QUEUE_H
+
+#include "twocanerror.h"
+#include "twocanutils.h"
+
+// wxWidgets
+// Mutex and Condition
+#include <wx/thread.h>
+
+// For the wxMessageQueueError return values, so that the queue is a drop in replacement for wxMessageQueue
+#include <wx/msgqueue.h>
+
+// STL
+#include <vector>
+#include <deque>
+#include <unordered_map>
+
+// Overload policies, what to discard when the queue is full
+#define QUEUE_POLICY_DROP_OLDEST 0 // Discard the oldest frame
+#define QUEUE_POLICY_DROP_CLASS 1 // Discard the oldest frame from the least important PGN class
+#define QUEUE_POLICY_COALESCE 2 // Replace a queued navigation frame with the latest one from the same PGN & source
+
+// Default and minimum number of frames that may be queued
+#define CONST_QUEUE_SIZE 1024
+#define CONST_MIN_QUEUE_SIZE 16
+
+// PGN classes, ordered from least to most important. The least important are discarded first
+#define PGN_CLASS_BULK 0 // Engine, tanks, batteries, environmental data etc.
+#define PGN_CLASS_NAVIGATION 1 // Position, heading, speed, depth etc. Superseded by the next update
+#define PGN_CLASS_AIS 2 // AIS reports, each from a different vessel
+#define PGN_CLASS_NETWORK 3 // ISO & NMEA network management
+#define PGN_CLASS_SAFETY 4 // DSC, AIS safety related messages and SAR reports
+#define PGN_CLASSES 5
+
+// Priority lanes, dequeued in strict priority order so that a DSC distress call 
+// is not held up behind thousands of queued engine or environmental frames
+#define QUEUE_LANE_SAFETY 0 // Safety PGN's
+#define QUEUE_LANE_NETWORK 1 // Network management and NGT-1 responses
+#define QUEUE_LANE_NORMAL 2 // Everything else, in arrival order
+#define QUEUE_LANES 3
+
+// Per lane latency, in microseconds
+typedef struct LaneStatistics {
+	unsigned long long frames;
+	unsigned long long totalLatency;
+	unsigned long long maximumLatency;
+} LaneStatistics;
+
+// Overload policy and queue size, no UI, set manually in the config file
+extern int queuePolicy;
+extern int queueSize;
+
+// Bounded queue of Actisense messages between the interface (NGT-1 or EBL Log Reader) and the Actisense device
+class ActisenseQueue {
+
+public:
+	// Constructor and destructor
+	ActisenseQueue(const size_t capacity, const int policy);
+	~ActisenseQueue(void);
+
+	// Add a frame, applying the overload policy if the queue is full. Never blocks the interface
+	wxMessageQueueError Post(const std::vector<byte>& frame);
+	// As above, timing the frame from when it was read (GetMonotonicMicros) rather than when it was posted
+	wxMessageQueueError Post(const std::vector<byte>& frame, const unsigned long long readTime);
+
+	// Wait up to timeout milliseconds for a frame, taken from the highest priority lane
+	wxMessageQueueError ReceiveTimeout(long timeout, std::vector<byte>& frame);
+	// As above, also returning the lane and the time (GetMonotonicMicros) the frame was posted
+	wxMessageQueueError ReceiveTimeout(long timeout, std::vector<byte>& frame, int *lane, unsigned long long *postedTime);
+
+	// Discard everything
+	void Clear(void);
+
+	// Statistics
+	size_t GetCount(void);
+	size_t GetCapacity(void) { return capacity; }
+	size_t GetHighWaterMark(void);
+	unsigned long long GetDroppedFrames(void);
+	unsigned long long GetCoalescedFrames(void);
+	unsigned long long GetDroppedFrames(const int pgnClass);
+	size_t GetCount(const int lane);
+	LaneStatistics GetLaneStatistics(const int lane);
+
+	// Classify a PGN for the overload policies
+	static int GetPGNClass(const unsigned int pgn);
+	// And which lane it travels in
+	static int GetLane(const int pgnClass);
+
+private:
+	typedef struct QueueEntry {
+		std::vector<byte> frame;
+		unsigned int key; // (PGN << 8) | source, used for coalescing
+		int pgnClass;
+		bool isRaw; // a raw CAN frame, possibly one fragment of a Fast Packet or ISO Transport Protocol message
+		unsigned long long sequence; // position in the lane when coalescing
+		unsigned long long postedTime; // for latency statistics
+	} QueueEntry;
+
+	wxMutex queueMutex;
+	wxCondition queueCondition;
+	std::deque<QueueEntry> lanes[QUEUE_LANES];
+	size_t count; // total across all lanes
+	size_t capacity;
+	int policy;
+
+	// Coalescing, the sequence number of the queued frame for each (PGN, source).
+	// Navigation PGN's, the only ones coalesced, all travel in the normal lane
+	std::unordered_map<unsigned int, unsigned long long> pendingFrames;
+	unsigned long long headSequence;
+	unsigned long long tailSequence;
+
+	// Statistics
+	size_t highWaterMark;
+	unsigned long long droppedFrames;
+	unsigned long long coalescedFrames;
+	unsigned long long droppedClassFrames[PGN_CLASSES];
+	LaneStatistics laneStatistics[QUEUE_LANES];
+
+	// Remove the frame at the front of a lane, called with the mutex held
+	void PopFront(const int lane);
+
+	// Overload handlers, called with the mutex held. Raw CAN frames are never discarded by them,
+	// as losing a single fragment would corrupt the reassembly of the whole message
+	bool DropOldest(void);
+	bool DropClass(const int pgnClass);
+	bool Coalesce(const QueueEntry& entry);
+};
+
+#endif
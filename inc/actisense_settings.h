@@ -204,7 +204,13 @@ extern bool enableExcel;
 extern bool enableInfluxDB;
 
 // List of devices dicovered on the NMEA 2000 network
-extern NetworkInformation networkMap[CONST_MAX_DEVICES];
+#include "actisense_network.h"
+
+// Bus load and its top talkers
+#include "actisense_busload.h"
+
+// Frame counters and processing times
+#include "actisense_statistics.h"
 
 // The uniqueID of this device (also used as the serial number)
 extern unsigned long uniqueId;
@@ -242,9 +248,13 @@ protected:
 	void OnApply(wxCommandEvent &event);
 	void OnCancel(wxCommandEvent &event);
 	void OnRightCick( wxMouseEvent& event);
+	void OnRefresh(wxCommandEvent &event);
+	void OnRefreshStatistics(wxCommandEvent &event);
 
 private:
 	void SaveSettings(void);
+	void DisplayBusLoad(void);
+	void DisplayStatistics(void);
 	bool settingsDirty;
 	bool EnumerateDrivers(void);
 	bool togglePGN;
@@ -66,6 +66,12 @@ class ActisenseSettingsBase : public wxDialog
 		wxStaticText* labelDebug;
 		wxButton* btnPause;
 		wxButton* btnCopy;
+		wxPanel* panelBusLoad;
+		wxStaticText* labelBusLoad;
+		wxButton* btnRefresh;
+		wxPanel* panelStatistics;
+		wxStaticText* labelStatistics;
+		wxButton* btnRefreshStatistics;
 		wxPanel* panelAbout;
 		wxStaticBitmap* bmpAbout;
 		wxStaticText* txtAbout;
@@ -87,6 +93,8 @@ class ActisenseSettingsBase : public wxDialog
 		virtual void OnCheckInfluxDb( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnPause( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnCopy( wxCommandEvent& event ) { event.Skip(); }
+		virtual void OnRefresh( wxCommandEvent& event ) { event.Skip(); }
+		virtual void OnRefreshStatistics( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnOK( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnApply( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnCancel( wxCommandEvent& event ) { event.Skip(); }
@@ -97,6 +105,10 @@ class ActisenseSettingsBase : public wxDialog
 		wxCheckListBox* chkListPGN;
 		wxGrid* dataGridNetwork;
 		wxTextCtrl* txtDebug;
+		wxGrid* dataGridSources;
+		wxGrid* dataGridPGN;
+		wxGrid* dataGridHistogram;
+		wxGrid* dataGridTimes;
 
 		ActisenseSettingsBase( wxWindow* parent, wxWindowID id = wxID_ANY, const wxString& title = wxT("Preferences"), const wxPoint& pos = wxDefaultPosition, const wxSize& size = wxSize( 411,487 ), long style = wxDEFAULT_DIALOG_STYLE );
 		~ActisenseSettingsBase();
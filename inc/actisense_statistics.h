@@ -0,0 +1,184 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_STATISTICS_H
+#define ACTISENSE_STATISTICS_H
+
+#include "twocanerror.h"
+#include "twocanutils.h"
+
+// STL
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <climits>
+
+// Histogram buckets, bucket 0 counts times of 0 usec, bucket n times of 2^(n-1) to 2^n - 1 usec,
+// and the last bucket everything longer (about 4 seconds)
+#define CONST_HISTOGRAM_BUCKETS 24
+
+// Number of PGN's with their own histograms. Must be a power of two, as it is an open addressed hash table.
+// Once full, further PGN's are counted together
+#define CONST_STATISTICS_PGNS 128
+
+// Log bucketed histogram of times (usec). Updated by the device thread, and read by the settings dialog
+// without locking, so that a refresh never stalls the pipeline. Readers may see a slightly inconsistent view
+class ActisenseHistogram {
+
+public:
+	ActisenseHistogram(void);
+
+	void Reset(void);
+	void Record(const unsigned long long micros);
+
+	unsigned long long GetCount(void) const { return count.load(std::memory_order_relaxed); }
+	unsigned long long GetTotal(void) const { return total.load(std::memory_order_relaxed); }
+	unsigned long long GetMean(void) const;
+	unsigned long long GetMinimum(void) const;
+	unsigned long long GetMaximum(void) const { return maximum.load(std::memory_order_relaxed); }
+	unsigned long long GetBucket(const int bucket) const { return buckets[bucket].load(std::memory_order_relaxed); }
+
+	// Upper bound of the bucket containing the given percentile (0 - 100)
+	unsigned long long GetPercentile(const double percentile) const;
+
+	static int GetBucketIndex(const unsigned long long micros);
+	static unsigned long long GetBucketLimit(const int bucket);
+
+private:
+	std::atomic<unsigned long long> buckets[CONST_HISTOGRAM_BUCKETS];
+	std::atomic<unsigned long long> count;
+	std::atomic<unsigned long long> total;
+	std::atomic<unsigned long long> minimum;
+	std::atomic<unsigned long long> maximum;
+};
+
+// Decode and queue wait times for a PGN
+typedef struct PgnTimes {
+	unsigned int pgn; // CONST_OTHER_PGNS for those without their own histograms
+	unsigned long long messages;
+	unsigned long long decodeMean;
+	unsigned long long decodePercentile; // 99th
+	unsigned long long decodeMaximum;
+	unsigned long long queueMean;
+	unsigned long long queuePercentile;
+	unsigned long long queueMaximum;
+} PgnTimes;
+
+#define CONST_OTHER_PGNS 0xFFFFFFFF
+
+// How often the device samples the counters that are guarded by a mutex (queue, serial port & adapter)
+#define CONST_STATISTICS_INTERVAL 1000
+
+// Declared in actisense_interface.h
+struct SerialStatistics;
+
+// The Actisense device's frame counters and processing times
+class ActisenseStatistics {
+
+public:
+	// Constructor and destructor
+	ActisenseStatistics(void);
+	~ActisenseStatistics(void);
+
+	void Reset(void);
+
+	// Frame counters
+	void CountReceived(void) { receivedFrames.fetch_add(1, std::memory_order_relaxed); }
+	void CountTransmitted(void) { transmittedFrames.fetch_add(1, std::memory_order_relaxed); }
+	void CountStandard(void) { standardFrames.fetch_add(1, std::memory_order_relaxed); }
+	void CountFast(void) { fastFrames.fetch_add(1, std::memory_order_relaxed); }
+	void CountErrors(const unsigned int errors) { errorFrames.fetch_add(errors, std::memory_order_relaxed); }
+	void SetDropped(const unsigned long long dropped) { droppedFrames.store(dropped, std::memory_order_relaxed); }
+
+	// Sampled by the device thread every CONST_STATISTICS_INTERVAL, so that readers never take the queue's,
+	// the serial port's or the adapter status' mutex
+	void SetQueue(const size_t depth, const size_t highWaterMark, const size_t capacity, const unsigned long long coalesced);
+	void SetAdapterDropped(const unsigned long long dropped) { adapterDropped.store(dropped, std::memory_order_relaxed); }
+	void SetSerial(const SerialStatistics& serial);
+
+	unsigned long long GetReceivedFrames(void) const { return receivedFrames.load(std::memory_order_relaxed); }
+	unsigned long long GetTransmittedFrames(void) const { return transmittedFrames.load(std::memory_order_relaxed); }
+	unsigned long long GetStandardFrames(void) const { return standardFrames.load(std::memory_order_relaxed); }
+	unsigned long long GetFastFrames(void) const { return fastFrames.load(std::memory_order_relaxed); }
+	unsigned long long GetErrorFrames(void) const { return errorFrames.load(std::memory_order_relaxed); }
+	unsigned long long GetDroppedFrames(void) const { return droppedFrames.load(std::memory_order_relaxed); }
+	unsigned long long GetCoalescedFrames(void) const { return coalescedFrames.load(std::memory_order_relaxed); }
+	unsigned long long GetAdapterDropped(void) const { return adapterDropped.load(std::memory_order_relaxed); }
+	size_t GetQueueDepth(void) const { return queueDepth.load(std::memory_order_relaxed); }
+	size_t GetQueueHighWaterMark(void) const { return queueHighWaterMark.load(std::memory_order_relaxed); }
+	size_t GetQueueCapacity(void) const { return queueCapacity.load(std::memory_order_relaxed); }
+	// FALSE if the interface is not attached to a serial port
+	bool GetSerial(SerialStatistics *serial) const;
+
+	// Time taken to decode a frame, and the time it waited in the queue beforehand (usec)
+	void RecordFrame(const unsigned int pgn, const unsigned long long decodeMicros, const unsigned long long queueMicros);
+
+	const ActisenseHistogram& GetDecodeTime(void) const { return decodeTime; }
+	const ActisenseHistogram& GetQueueTime(void) const { return queueTime; }
+
+	// Per PGN times, most frequent first
+	void GetPgnTimes(std::vector<PgnTimes>& times) const;
+
+private:
+	std::atomic<unsigned long long> receivedFrames;
+	std::atomic<unsigned long long> transmittedFrames;
+	std::atomic<unsigned long long> standardFrames;
+	std::atomic<unsigned long long> fastFrames;
+	std::atomic<unsigned long long> errorFrames;
+	std::atomic<unsigned long long> droppedFrames;
+	std::atomic<unsigned long long> coalescedFrames;
+	std::atomic<unsigned long long> adapterDropped;
+	std::atomic<size_t> queueDepth;
+	std::atomic<size_t> queueHighWaterMark;
+	std::atomic<size_t> queueCapacity;
+
+	// Serial link, a copy of the interface's SerialStatistics
+	std::atomic<bool> serialAvailable;
+	std::atomic<unsigned long long> serialBytes;
+	std::atomic<unsigned int> serialBytesPerSecond;
+	std::atomic<int> serialUtilisation;
+	std::atomic<unsigned long long> serialOverruns;
+	std::atomic<unsigned long long> serialBufferOverruns;
+	std::atomic<unsigned long long> serialFramingErrors;
+	std::atomic<unsigned long long> serialParityErrors;
+	std::atomic<unsigned long long> serialResyncs;
+	std::atomic<unsigned long long> serialEscapeErrors;
+	std::atomic<unsigned long long> serialDiscardedBytes;
+
+	ActisenseHistogram decodeTime;
+	ActisenseHistogram queueTime;
+
+	// Keyed by PGN + 1, so that zero marks a free entry. The final entry counts the PGN's that did not fit
+	typedef struct PgnEntry {
+		std::atomic<unsigned int> key;
+		ActisenseHistogram decodeTime;
+		ActisenseHistogram queueTime;
+	} PgnEntry;
+	PgnEntry pgnEntries[CONST_STATISTICS_PGNS + 1];
+	int pgnCount;
+
+	PgnEntry *FindPgn(const unsigned int pgn);
+};
+
+// The device's statistics, shared with the settings dialog
+extern ActisenseStatistics deviceStatistics;
+
+#endif
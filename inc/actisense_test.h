@@ -0,0 +1,89 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_TEST_H
+#define ACTISENSE_TEST_H
+
+#include "twocanerror.h"
+#include "twocanutils.h"
+#include "actisense_device.h"
+#include "actisense_bus.h"
+#include "actisense_memory.h"
+#include "actisense_framer.h"
+#include "actisense_queue.h"
+#include "actisense_transport.h"
+#include "actisense_ngt1.h"
+
+// wxWidgets
+#include <wx/string.h>
+
+// STL
+#include <vector>
+
+// Proprietary PGN's, which the device neither converts nor responds to
+#define CONST_TEST_FAST_PGN 130820
+#define CONST_TEST_SINGLE_PGN 65300
+
+// Behaviour checks of the core library, run by ctest. Each test feeds known frames through
+// the framer, queue, reassembly and timestamp mapping and checks what comes out
+class ActisenseTest {
+
+public:
+	// Constructor and destructor
+	ActisenseTest(void);
+	~ActisenseTest(void);
+
+	// Create the device, with the in memory interface
+	int Init(void);
+
+	// Run the tests whose name contains filter, all of them if it is empty. Returns the number of failed checks
+	int Run(const wxString& filter);
+
+private:
+	ActisenseDevice *device;
+	ActisenseSubscription *subscription;
+	std::vector<BusMessagePtr> batch;
+	wxString testName;
+	int checks;
+	int failures;
+
+	// Record the outcome of a check, reporting those that fail
+	void Expect(const bool condition, const char *description);
+
+	// Actisense N2K_RX_CMD frames, and the BST encoded stream that carries them
+	static std::vector<byte> BuildFrame(const unsigned int pgn, const byte source, const std::vector<byte>& payload);
+	static void AppendEscaped(std::vector<byte>& stream, const std::vector<byte>& frame);
+	// Raw CAN_RX_CMD frames, as posted by the CAN log file readers
+	static std::vector<byte> BuildRawFrame(const CanHeader& header, const std::vector<byte>& data);
+
+	// Take what the device published
+	size_t TakePublished(void);
+
+	// The tests
+	void TestFraming(void);
+	void TestQueue(void);
+	void TestFastPacket(void);
+	void TestTransport(void);
+	void TestAdapterTimestamp(void);
+	void TestWriteCommand(void);
+};
+
+#endif
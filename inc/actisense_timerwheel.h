@@ -0,0 +1,70 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_TIMERWHEEL_H
+#define ACTISENSE_TIMERWHEEL_H
+
+#include "twocanerror.h"
+#include "twocanutils.h"
+
+// STL
+#include <vector>
+
+// Number of buckets, must be a power of two, and the time each bucket spans (msec).
+// One revolution covers 25.6 seconds, longer deadlines wait in their bucket for subsequent revolutions
+#define CONST_WHEEL_SLOTS 256
+#define CONST_WHEEL_TICK 100
+
+// Hashed timer wheel with a fixed number of timers, identified by 0 .. timers - 1.
+// Arming, re-arming and cancelling a timer are O(1), so a deadline can be pushed back on every frame.
+// Not thread safe, owned and advanced by the Actisense device thread
+class ActisenseTimerWheel {
+
+public:
+	// Constructor and destructor
+	ActisenseTimerWheel(const int timers, const unsigned long long now);
+	~ActisenseTimerWheel(void);
+
+	// Arm (or re-arm) a timer to expire at deadline, monotonic msec
+	void Arm(const int timer, const unsigned long long deadline);
+	void Cancel(const int timer);
+	bool IsArmed(const int timer);
+
+	// Advance the wheel to now, returning the timers that have expired. Expired timers are disarmed
+	size_t Advance(const unsigned long long now, std::vector<int>& expired);
+
+private:
+	typedef struct WheelTimer {
+		int next;
+		int previous;
+		int bucket; // NOT_FOUND if not armed
+		unsigned long long deadline;
+	} WheelTimer;
+
+	std::vector<WheelTimer> timers;
+	int buckets[CONST_WHEEL_SLOTS]; // head of each bucket's list of timers
+	unsigned long long currentTick;
+
+	void Link(const int timer, const int bucket);
+	void Unlink(const int timer);
+};
+
+#endif
@@ -0,0 +1,130 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_TRACE_H
+#define ACTISENSE_TRACE_H
+
+// Pre compiled headers 
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+
+// Error constants and macros
+#include "twocanerror.h"
+
+// Constants, typedefs and utility functions for bit twiddling and array manipulation for NMEA 2000 messages
+#include "twocanutils.h"
+
+// Histograms of the stage latencies
+#include "actisense_statistics.h"
+
+// wxWidgets
+// Chrome trace file
+#include <wx/file.h>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+
+// Logging (Info & Errors)
+#include <wx/log.h>
+
+// STL
+#include <atomic>
+
+// Where a traced frame is stamped, in order
+#define TRACE_STAGE_READ 0 // The serial read that completed the message (NGT-1), otherwise when it was queued
+#define TRACE_STAGE_DEQUEUED 1 // Received from the queue by the device
+#define TRACE_STAGE_DECODED 2 // Decoded, and about to be published to the message bus
+#define TRACE_STAGE_PUBLISHED 3 // Published
+#define TRACE_STAGE_PUSHED 4 // Pushed into OpenCPN, PushNMEABuffer
+#define TRACE_STAGES 5
+
+// Aggregated latencies
+#define TRACE_INTERVAL_QUEUE 0 // Read to dequeued
+#define TRACE_INTERVAL_DECODE 1 // Dequeued to decoded
+#define TRACE_INTERVAL_PUBLISH 2 // Decoded to published
+#define TRACE_INTERVAL_DELIVER 3 // Decoded to pushed, the time spent on the bus and waiting for the main thread
+#define TRACE_INTERVAL_TOTAL 4 // Read to pushed
+#define TRACE_INTERVALS 5
+
+// Number of the most recently traced frames kept for the Chrome trace file. Must be a power of two
+#define CONST_TRACE_RECORDS 4096
+
+// Trace one in every traceSampling frames, zero disables tracing, and the Chrome trace event file
+// written when the device stops (relative to the Documents folder). No UI, set manually in the config file
+extern int traceSampling;
+extern wxString traceFile;
+
+// Stamps a sample of frames with the monotonic clock as they pass through the pipeline. The device thread
+// begins the trace and stamps all but the last stage, the main thread stamps the frame when it is pushed into OpenCPN
+class ActisenseTracer {
+
+public:
+	// Constructor and destructor
+	ActisenseTracer(void);
+	~ActisenseTracer(void);
+
+	// Only called when the device is not running
+	void Reset(const int interval);
+	bool IsEnabled(void) const { return (samplingInterval > 0); }
+
+	// Device thread. Begin returns zero if the frame is not sampled, which the other functions ignore
+	unsigned int Begin(const unsigned long long readTime, const unsigned long long dequeueTime);
+	void Stamp(const unsigned int traceId, const int stage);
+	void End(const unsigned int traceId, const unsigned int pgn);
+
+	// Main thread
+	void Deliver(const unsigned int traceId);
+
+	const ActisenseHistogram& GetInterval(const int interval) const { return intervals[interval]; }
+	static const char *GetIntervalName(const int interval);
+
+	// Log the median, 99th percentile and maximum of each interval
+	void LogIntervals(void);
+
+	// Write the traced frames in the Chrome trace event format (chrome://tracing or https://ui.perfetto.dev)
+	// Only called when the device is not running
+	int WriteChromeTrace(const wxString& fileName);
+
+private:
+	typedef struct TraceRecord {
+		std::atomic<unsigned int> id; // zero while the record is being reused
+		unsigned int pgn;
+		std::atomic<unsigned long long> stamps[TRACE_STAGES]; // usec, zero if the frame did not reach the stage
+	} TraceRecord;
+
+	TraceRecord records[CONST_TRACE_RECORDS];
+	int samplingInterval;
+	int sampleCount;
+	unsigned int lastId;
+
+	// Queue, decode and publish are recorded by the device thread, deliver and total by the main thread
+	ActisenseHistogram intervals[TRACE_INTERVALS];
+
+	// The record for a trace, NULL if it has since been reused
+	TraceRecord *FindRecord(const unsigned int traceId);
+};
+
+// Shared by the device and the plugin
+extern ActisenseTracer frameTracer;
+
+#endif
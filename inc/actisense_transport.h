@@ -0,0 +1,118 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+#ifndef ACTISENSE_TRANSPORT_H
+#define ACTISENSE_TRANSPORT_H
+
+#include "twocanerror.h"
+#include "twocanutils.h"
+#include "actisense_timerwheel.h"
+
+// STL
+#include <vector>
+
+// ISO 11783-3 Transport Protocol, Connection Management (TP.CM) and Data Transfer (TP.DT) PGN's
+#define CONST_TP_CM_PGN 60416
+#define CONST_TP_DT_PGN 60160
+
+// TP.CM control bytes
+#define TP_CM_RTS 16 // Request To Send
+#define TP_CM_CTS 17 // Clear To Send
+#define TP_CM_EOMA 19 // End Of Message Acknowledgement
+#define TP_CM_BAM 32 // Broadcast Announce Message
+#define TP_CM_ABORT 255 // Connection Abort
+
+// ISO 11783-3 timeouts (msec)
+#define CONST_TP_T1 750 // Between data packets
+#define CONST_TP_T2 1250 // From Clear To Send to the first data packet
+#define CONST_TP_T3 1250 // From the last data packet, or the Request To Send, to Clear To Send
+#define CONST_TP_T4 1050 // Whilst the receiver holds the connection open
+
+// Number of concurrent transfers. Each session buffers up to CONST_MAX_ISO_MULTI_PACKET_LENGTH bytes
+#define CONST_TP_SESSIONS 32
+
+typedef struct TransportStatistics {
+	unsigned long long completed;
+	unsigned long long aborted; // by either party
+	unsigned long long timedOut;
+	unsigned long long discarded; // invalid, out of sequence or no free session
+} TransportStatistics;
+
+// Reassembles BAM and RTS/CTS multi-packet transfers observed on the bus.
+// Sessions and their buffers are preallocated and timeouts use the device's timer wheel, 
+// timers firstTimer .. firstTimer + CONST_TP_SESSIONS - 1, so no allocation takes place per transfer.
+// Listen only, we never send CTS, EOMA or Abort ourselves, so RTS/CTS transfers are followed as they are acknowledged by their receiver.
+// Not thread safe, owned by the Actisense device thread
+class ActisenseTransport {
+
+public:
+	// Constructor and destructor
+	ActisenseTransport(ActisenseTimerWheel *timerWheel, const int firstTimer);
+	~ActisenseTransport(void);
+
+	// Process a TP.CM or TP.DT frame. Returns TRUE when a transfer has completed,
+	// the reassembled message is then available from GetHeader and GetPayload until the next call
+	bool ProcessFrame(const CanHeader header, const byte *data, const byte length);
+	const CanHeader& GetHeader(void) { return messageHeader; }
+	const std::vector<byte>& GetPayload(void) { return messagePayload; }
+
+	// Whether the timer belongs to a session, and if so discard the session
+	bool IsTransportTimer(const int timer);
+	void Expire(const int timer);
+
+	TransportStatistics GetStatistics(void) { return statistics; }
+
+private:
+	typedef struct TransportSession {
+		byte source;
+		byte destination; // CONST_GLOBAL_ADDRESS for BAM
+		byte priority;
+		unsigned int pgn;
+		unsigned int size;
+		byte packets;
+		byte nextSequence;
+		byte lastSequence; // last packet cleared to send, RTS/CTS only
+		int next; // next session from the same source, or next free session
+		byte data[CONST_MAX_ISO_MULTI_PACKET_LENGTH];
+	} TransportSession;
+
+	ActisenseTimerWheel *timerWheel;
+	int firstTimer;
+
+	std::vector<TransportSession> sessions;
+	int freeSessions; // head of the free list
+	int sourceSessions[CONST_GLOBAL_ADDRESS + 1]; // head of each source's list of sessions
+
+	// The completed message
+	CanHeader messageHeader;
+	std::vector<byte> messagePayload;
+
+	TransportStatistics statistics;
+
+	int FindSession(const byte source, const byte destination);
+	int OpenSession(const CanHeader header, const byte *data);
+	void CloseSession(const int session);
+
+	void ProcessConnection(const CanHeader header, const byte *data);
+	bool ProcessData(const CanHeader header, const byte *data);
+};
+
+#endif
@@ -38,11 +38,18 @@
 // For memcpy
 #include <string.h>
 
+// For monotonic time stamps
+#include <chrono>
+
 // Actisense Specific
 // Name of the Actisense EBL Log Reader or NGT-1 Device for input
 // Used in he settings dialog and in determinig what device to load
 #define CONST_LOG_READER "EBL Log Reader"
 #define CONST_NGT_READER "NGT-1 Device Reader"
+// Or a Linux candump log file of raw CAN frames, for testing fast packet & ISO transport protocol reassembly
+#define CONST_CANDUMP_READER "Candump Log Reader"
+// Or bytes fed in by a tool or benchmark linked with the core library, not offered in the settings dialog
+#define CONST_MEMORY_READER "Memory Reader"
 
 // Some NMEA 2000 constants
 #define CONST_HEADER_LENGTH 4
@@ -55,7 +62,7 @@
 #define CONST_NULL_ADDRESS 254
 
 // Maximum payload for NMEA multi-frame Fast Message
-#define CONST_MAX_FAST_PACKET 223_LENGTH
+#define CONST_MAX_FAST_PACKET_LENGTH 223
 
 // Maximum payload for ISO 11783-3 Multi Packet
 #define CONST_MAX_ISO_MULTI_PACKET_LENGTH 1785 
@@ -77,7 +84,8 @@
 #define CONST_SOFTWARE_VERSION  "1.0" // BUG BUG Should derive from PLUGIN_VERSION_MAJOR etc.
 
 // Maximum number of multi-frame Fast Messages we can support in the Fast Message Buffer, just an arbitary number
-#define CONST_MAX_MESSAGES 100
+// Must be a power of two, as the buffer is an open addressed hash table
+#define CONST_MAX_MESSAGES 128
 
 // Stale Fast Message expiration  (I think Fast Messages must be sent within 250 msec)
 #define CONST_TIME_EXCEEDED 250
@@ -85,7 +93,7 @@
 // Whether an existing Fast Message entry exists, in order to append a frame
 #define NOT_FOUND -1
 
-// Dropped or missing frames from a Fast Message
+// Lost messages, a warning is logged if more than the threshold are lost within the period (seconds)
 #define CONST_DROPPEDFRAME_THRESHOLD 200
 #define CONST_DROPPEDFRAME_PERIOD 5
 
@@ -94,6 +102,25 @@
 #define CONST_ONE_SECOND 100 * CONST_TEN_MILLIS
 #define CONST_ONE_MINUTE 60 * CONST_ONE_SECOND
 
+// Period during which a higher ranked (or the current) producer of a NMEA 0183 sentence
+// suppresses the same sentence from other PGN's or sources. Must exceed the slowest producer's interval (1Hz).
+#define CONST_ARBITRATION_PERIOD (2 * CONST_ONE_SECOND)
+
+// The Actisense timestamp is a 32 bit millisecond count, which wraps every 49.7 days.
+// A backwards step larger than the reordering threshold means the adapter restarted, or the log file was rewound
+#define CONST_ADAPTER_TIME_WRAP 0x100000000ULL
+#define CONST_ADAPTER_TIME_REORDER CONST_ONE_SECOND
+// Period over which the minimum host - adapter offset is re-estimated, to follow drift between the two clocks
+#define CONST_ADAPTER_TIME_WINDOW CONST_ONE_MINUTE
+
+// Heartbeat interval (msec) assumed if a device's heartbeat does not specify one.
+// A device is presumed to have left the network once it has missed this many heartbeats
+#define CONST_HEARTBEAT_INTERVAL 60000
+#define CONST_HEARTBEAT_MISSED 2
+
+// Period after which data that is no longer being received is reported as invalid
+#define CONST_DATA_STALE_PERIOD (5 * CONST_ONE_SECOND)
+
 // NMEA 2000 priorities - derived from observation. As priority is only 3 bits, values range from 0-7
 #define CONST_PRIORITY_MEDIUM 6 // seen for 60928 ISO Address Claim, 59904 ISO Request
 #define CONST_PRIORITY_LOW 7 // Seen for 126996 Product Information
@@ -230,6 +257,10 @@ const byte N2K_RX_CMD {0x93};
 const byte NGT_TX_CMD {0xA1};
 const byte NGT_RX_CMD {0xA3};
 
+// Not an Actisense command, a raw CAN frame from a non Actisense source, posted to the device's queue as
+// Command, CAN Id (4 bytes, little endian), Timestamp (4 bytes, little endian, msec), Data Length, Data
+const byte CAN_RX_CMD {0x00};
+
 
 // CAN v2.0 29 bit header as used by NMEA 2000
 typedef struct CanHeader {
@@ -237,6 +268,7 @@ typedef struct CanHeader {
 	byte source;
 	byte destination;
 	unsigned int pgn;
+	unsigned long long timestamp; // when received, host monotonic msec derived from the adapter's timestamp. 0 if unknown
 } CanHeader;
 
 // NMEA 2000 Product Information, transmitted in PGN 126996 NMEA Product Information
@@ -264,7 +296,7 @@ typedef struct DeviceInformation {
 	// however this field is part of PGN 65420 Commanded Address
 	byte networkAddress;
 	// NAME is the value of the 8 bytes that make up this PGN. The NAME is used for resolving addess claim conflicts
-	unsigned long deviceName;
+	unsigned long long deviceName;
 } DeviceInformation;
 
 // Used  to store the data for the Network Map, combines elements from address claim & product information
@@ -272,7 +304,13 @@ typedef struct NetworkInformation {
 	unsigned long uniqueId;
 	unsigned int manufacturerId;
 	ProductInformation productInformation;
-	wxDateTime timestamp; // Updated upon reception of heartbeat or address claim. Used to determine stale entries
+	unsigned long long timestamp; // Monotonic time (msec) a frame was last received from the device. Used to determine stale entries
+	unsigned long long deviceName; // NAME from the address claim, 0 if the device has yet to be seen claiming an address
+	byte networkAddress; // Address currently used, CONST_NULL_ADDRESS if the device has lost its address
+	unsigned int heartbeatInterval; // msec, from PGN 126993, 0 if unknown
+	unsigned long long receivedFrames;
+	unsigned int addressChanges;
+	bool heartbeatExpired; // Missed CONST_HEARTBEAT_MISSED heartbeats
 } NetworkInformation;
 
 // Utility functions used by both the ActisenseDevice
@@ -290,8 +328,16 @@ public:
 	static int DecodeCanHeader(const byte *buf, CanHeader *header);
 	// And its companion, encode a 29 bit CAN Header to a byte array
 	static int EncodeCanHeader(unsigned int *id, const CanHeader *header);
+	// Decodes the CAN header from an Actisense N2K_RX_CMD message, with or without the overall length & checksum
+	static int DecodeActisenseHeader(const byte *buf, const unsigned int length, CanHeader *header);
+	// Sum of the bytes of an Actisense message modulo 256, zero if the message's checksum is valid
+	static byte ActisenseChecksum(const byte *buf, const unsigned int length);
 	// Convert a string of hex characters to the corresponding byte array
 	static int ConvertHexStringToByteArray(const byte *hexstr, const unsigned int len, byte *buf);
+	// Milliseconds from a monotonic clock, cheaper than wxDateTime::Now() and immune to clock changes
+	static unsigned long long GetMonotonicMillis(void);
+	// And with microsecond resolution, for latency measurements
+	static unsigned long long GetMonotonicMicros(void);
 	// BUG BUG Any other conversion functions required ??
 
 	
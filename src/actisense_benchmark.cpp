@@ -0,0 +1,1066 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseBenchmark - Micro benchmarks of the framing, checksums, dispatch, decoders, AIS encoding and sentence formatting
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+
+#include "actisense_benchmark.h"
+
+// wxWidgets
+// Console application initialization and output
+#include <wx/init.h>
+#include <wx/crt.h>
+
+// STL
+// Counting heap allocations
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Every heap allocation made by the process, including those made by std::vector and wxString
+static std::atomic<unsigned long long> heapAllocations(0);
+
+void *operator new(std::size_t size) {
+	heapAllocations.fetch_add(1, std::memory_order_relaxed);
+	void *block = std::malloc(size > 0 ? size : 1);
+	if (block == NULL) {
+		throw std::bad_alloc();
+	}
+	return block;
+}
+
+void *operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void *block) noexcept {
+	std::free(block);
+}
+
+void operator delete[](void *block) noexcept {
+	std::free(block);
+}
+
+unsigned long long ActisenseBenchmark::GetAllocations(void) {
+	return heapAllocations.load(std::memory_order_relaxed);
+}
+
+// Little endian NMEA 2000 fields
+static void AppendByte(std::vector<byte>& payload, const unsigned int value) {
+	payload.push_back(value & 0xFF);
+}
+
+static void AppendShort(std::vector<byte>& payload, const unsigned int value) {
+	AppendByte(payload, value);
+	AppendByte(payload, value >> 8);
+}
+
+static void AppendInt(std::vector<byte>& payload, const unsigned int value) {
+	AppendShort(payload, value);
+	AppendShort(payload, value >> 16);
+}
+
+static void AppendLong(std::vector<byte>& payload, const unsigned long long value) {
+	AppendInt(payload, value & 0xFFFFFFFF);
+	AppendInt(payload, value >> 32);
+}
+
+// Repeated bytes, for reserved and unused fields
+static void AppendFill(std::vector<byte>& payload, const unsigned int value, const size_t count) {
+	payload.insert(payload.end(), count, value & 0xFF);
+}
+
+// Fixed length text, padded
+static void AppendText(std::vector<byte>& payload, const char *text, const size_t length, const byte padding) {
+	for (size_t i = 0; i < length; i++) {
+		payload.push_back((*text != 0) ? *text++ : padding);
+	}
+}
+
+// Variable length text, the length includes the length and encoding bytes. Encoding 1 is ASCII
+static void AppendString(std::vector<byte>& payload, const char *text) {
+	AppendByte(payload, strlen(text) + 2);
+	AppendByte(payload, 1);
+	AppendText(payload, text, strlen(text), 0);
+}
+
+ActisenseBenchmark::ActisenseBenchmark(void) {
+	device = NULL;
+	subscription = NULL;
+}
+
+ActisenseBenchmark::~ActisenseBenchmark(void) {
+	if (subscription != NULL) {
+		messageBus.Unsubscribe(subscription);
+		delete subscription;
+	}
+	if (device != NULL) {
+		// The device thread was never run, so its OnExit has not deleted the interface
+		delete device->GetInterface();
+		delete device;
+	}
+}
+
+int ActisenseBenchmark::Init(void) {
+	// Every PGN the plugin converts
+	supportedPGN = (FLAGS_NAV << 1) - 1;
+
+	// Measured as in normal use, without the debug hex dump of each frame
+	debugWindowActive = FALSE;
+	logLevel = FLAGS_LOG_NONE;
+
+	device = new ActisenseDevice(NULL);
+	int returnCode = device->Init(CONST_MEMORY_READER);
+	if (returnCode != TWOCAN_RESULT_SUCCESS) {
+		return returnCode;
+	}
+
+	// So that every message is framed in full, rather than just those the plugin converts
+	pgnFilter.EnableAll();
+
+	// The device only formats sentences that a subscriber wants. No handler, the benchmark drains it
+	BusFilter busFilter = {};
+	busFilter.sentenceTypes = SENTENCE_MASK_ALL;
+	subscription = new ActisenseSubscription(_T("Benchmark"), busFilter, CONST_SUBSCRIPTION_SIZE, NULL, wxEVT_NULL, 0);
+	messageBus.Subscribe(subscription);
+
+	BuildMessages();
+	return TWOCAN_RESULT_SUCCESS;
+}
+
+// Representative payloads, as reassembled by the NGT-1. 
+// A vessel at 50.8N 1.3W, its AIS targets, instruments and engine
+void ActisenseBenchmark::BuildMessages(void) {
+	const unsigned int mmsi = 235012345;
+	const int latitude = 508000000; // 1e-7 degrees
+	const int longitude = -13000000;
+	const unsigned int daysSinceEpoch = 20000;
+	const unsigned int secondsSinceMidnight = 43200 * 10000; // 1e-4 seconds
+	std::vector<byte> payload;
+
+	messages.clear();
+
+	// ISO Request for an address claim, addressed to another device so that we don't respond
+	payload.clear();
+	AppendByte(payload, 60928 & 0xFF);
+	AppendByte(payload, (60928 >> 8) & 0xFF);
+	AppendByte(payload, 60928 >> 16);
+	messages.push_back({ 59904, payload });
+
+	// ISO Address Claim, unique id & manufacturer, instance, function, class and industry group
+	payload.clear();
+	AppendInt(payload, 123456 | (135 << 21));
+	AppendByte(payload, 0);
+	AppendByte(payload, 145);
+	AppendByte(payload, 60 << 1);
+	AppendByte(payload, 0x80 | (4 << 4));
+	messages.push_back({ 60928, payload });
+
+	// ISO Commanded Address, the NAME followed by the new address
+	payload.clear();
+	AppendInt(payload, 123456 | (135 << 21));
+	AppendByte(payload, 0);
+	AppendByte(payload, 145);
+	AppendByte(payload, 60 << 1);
+	AppendByte(payload, 0x80 | (4 << 4));
+	AppendByte(payload, 0x24);
+	messages.push_back({ 65240, payload });
+
+	// System Time
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendByte(payload, 0xF0);
+	AppendShort(payload, daysSinceEpoch);
+	AppendInt(payload, secondsSinceMidnight);
+	messages.push_back({ 126992, payload });
+
+	// Heartbeat, 60 second interval
+	payload.clear();
+	AppendShort(payload, 60000);
+	AppendByte(payload, 0);
+	AppendByte(payload, 0x01);
+	AppendFill(payload, 0xFF, 4);
+	messages.push_back({ 126993, payload });
+
+	// Product Information
+	payload.clear();
+	AppendShort(payload, 2100);
+	AppendShort(payload, 1234);
+	AppendText(payload, "GPS 200", 32, 0xFF);
+	AppendText(payload, "2.30.1", 32, 0xFF);
+	AppendText(payload, "Rev B", 32, 0xFF);
+	AppendText(payload, "0123456789", 32, 0xFF);
+	AppendByte(payload, 1);
+	AppendByte(payload, 2);
+	messages.push_back({ 126996, payload });
+
+	// Rudder, 5 degrees to starboard
+	payload.clear();
+	AppendByte(payload, 0);
+	AppendByte(payload, 0xFF);
+	AppendShort(payload, 0x7FFF);
+	AppendShort(payload, 873);
+	AppendFill(payload, 0xFF, 2);
+	messages.push_back({ 127245, payload });
+
+	// Vessel Heading, magnetic with 2 degrees West variation
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendShort(payload, 12000);
+	AppendShort(payload, 0x7FFF);
+	AppendShort(payload, static_cast<unsigned short>(-349));
+	AppendByte(payload, HEADING_MAGNETIC);
+	messages.push_back({ 127250, payload });
+
+	// Rate of Turn
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendInt(payload, 32000);
+	AppendFill(payload, 0xFF, 3);
+	messages.push_back({ 127251, payload });
+
+	// Attitude, yaw, pitch and roll
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendShort(payload, 12000);
+	AppendShort(payload, 200);
+	AppendShort(payload, static_cast<unsigned short>(-500));
+	AppendByte(payload, 0xFF);
+	messages.push_back({ 127257, payload });
+
+	// Magnetic Variation
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendByte(payload, 0xF1);
+	AppendShort(payload, daysSinceEpoch);
+	AppendShort(payload, static_cast<unsigned short>(-349));
+	AppendFill(payload, 0xFF, 2);
+	messages.push_back({ 127258, payload });
+
+	// Engine Parameters, Rapid Update, 1800 rpm
+	payload.clear();
+	AppendByte(payload, 0);
+	AppendShort(payload, 1800 * 4);
+	AppendShort(payload, 0xFFFF);
+	AppendByte(payload, 0x7F);
+	AppendFill(payload, 0xFF, 2);
+	messages.push_back({ 127488, payload });
+
+	// Engine Parameters, Dynamic
+	payload.clear();
+	AppendByte(payload, 0);
+	AppendShort(payload, 3500);
+	AppendShort(payload, 3630);
+	AppendShort(payload, 3550);
+	AppendShort(payload, 1420);
+	AppendShort(payload, 120);
+	AppendInt(payload, 1234 * 3600);
+	AppendShort(payload, 0xFFFF);
+	AppendShort(payload, 0xFFFF);
+	AppendByte(payload, 0xFF);
+	AppendShort(payload, 0);
+	AppendShort(payload, 0);
+	AppendByte(payload, 65);
+	AppendByte(payload, 0x7F);
+	messages.push_back({ 127489, payload });
+
+	// Fluid Level, fuel tank three quarters full
+	payload.clear();
+	AppendByte(payload, 0x00);
+	AppendShort(payload, 18750);
+	AppendInt(payload, 2000);
+	AppendByte(payload, 0xFF);
+	messages.push_back({ 127505, payload });
+
+	// Battery Status
+	payload.clear();
+	AppendByte(payload, 0);
+	AppendShort(payload, 1280);
+	AppendShort(payload, 50);
+	AppendShort(payload, 29815);
+	AppendByte(payload, 1);
+	messages.push_back({ 127508, payload });
+
+	// Speed, Water Referenced
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendShort(payload, 320);
+	AppendShort(payload, 330);
+	AppendByte(payload, 0);
+	AppendFill(payload, 0xFF, 2);
+	messages.push_back({ 128259, payload });
+
+	// Water Depth
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendInt(payload, 1250);
+	AppendShort(payload, 500);
+	AppendByte(payload, 0xFF);
+	messages.push_back({ 128267, payload });
+
+	// Distance Log
+	payload.clear();
+	AppendShort(payload, daysSinceEpoch);
+	AppendInt(payload, secondsSinceMidnight);
+	AppendInt(payload, 1852 * 1000);
+	AppendInt(payload, 1852 * 12);
+	messages.push_back({ 128275, payload });
+
+	// Position, Rapid Update
+	payload.clear();
+	AppendInt(payload, latitude);
+	AppendInt(payload, longitude);
+	messages.push_back({ 129025, payload });
+
+	// COG & SOG, Rapid Update
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendByte(payload, 0xFC | HEADING_TRUE);
+	AppendShort(payload, 15708);
+	AppendShort(payload, 320);
+	AppendFill(payload, 0xFF, 2);
+	messages.push_back({ 129026, payload });
+
+	// GNSS Position Data, a DGNSS fix with one reference station
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendShort(payload, daysSinceEpoch);
+	AppendInt(payload, secondsSinceMidnight);
+	AppendLong(payload, (long long)latitude * 1000000000LL);
+	AppendLong(payload, (long long)longitude * 1000000000LL);
+	AppendLong(payload, 15000000);
+	AppendByte(payload, 0 | (2 << 4));
+	AppendByte(payload, 0xFC | 1);
+	AppendByte(payload, 9);
+	AppendShort(payload, 90);
+	AppendShort(payload, 150);
+	AppendInt(payload, 4700);
+	AppendByte(payload, 1);
+	AppendShort(payload, 0 | (42 << 4));
+	AppendShort(payload, 500);
+	messages.push_back({ 129029, payload });
+
+	// Date & Time
+	payload.clear();
+	AppendShort(payload, daysSinceEpoch);
+	AppendInt(payload, secondsSinceMidnight);
+	AppendShort(payload, 60);
+	messages.push_back({ 129033, payload });
+
+	// AIS Class A Position Report
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendInt(payload, mmsi);
+	AppendInt(payload, longitude + 100000);
+	AppendInt(payload, latitude + 100000);
+	AppendByte(payload, 0x01 | (30 << 2));
+	AppendShort(payload, 31416);
+	AppendShort(payload, 520);
+	AppendByte(payload, 0x00);
+	AppendByte(payload, 0x20);
+	AppendByte(payload, 0x00);
+	AppendShort(payload, 31400);
+	AppendShort(payload, 0xFFFF);
+	AppendByte(payload, 0);
+	AppendByte(payload, 0xFF);
+	AppendByte(payload, 0xFF);
+	AppendByte(payload, 0xFF);
+	messages.push_back({ 129038, payload });
+
+	// AIS Class B Position Report
+	payload.clear();
+	AppendByte(payload, 18);
+	AppendInt(payload, mmsi + 1);
+	AppendInt(payload, longitude - 100000);
+	AppendInt(payload, latitude + 50000);
+	AppendByte(payload, 0x01 | (15 << 2));
+	AppendShort(payload, 20000);
+	AppendShort(payload, 310);
+	AppendByte(payload, 0x00);
+	AppendByte(payload, 0x00);
+	AppendByte(payload, 0x08);
+	AppendShort(payload, 20000);
+	AppendByte(payload, 0xFF);
+	AppendByte(payload, 0x74);
+	AppendByte(payload, 0x01);
+	messages.push_back({ 129039, payload });
+
+	// AIS Class B Extended Position Report
+	payload.clear();
+	AppendByte(payload, 19);
+	AppendInt(payload, mmsi + 2);
+	AppendInt(payload, longitude - 200000);
+	AppendInt(payload, latitude - 50000);
+	AppendByte(payload, 0x01 | (45 << 2));
+	AppendShort(payload, 10000);
+	AppendShort(payload, 250);
+	AppendByte(payload, 0xFF);
+	AppendByte(payload, 0xFF);
+	AppendByte(payload, 36);
+	AppendShort(payload, 10000);
+	AppendByte(payload, 0x1F);
+	AppendShort(payload, 120);
+	AppendShort(payload, 40);
+	AppendShort(payload, 20);
+	AppendShort(payload, 90);
+	AppendText(payload, "SEA BREEZE", 20, '@');
+	AppendByte(payload, 0x01);
+	AppendByte(payload, 0xFF);
+	messages.push_back({ 129040, payload });
+
+	// AIS Aids To Navigation Report
+	payload.clear();
+	AppendByte(payload, 21);
+	AppendInt(payload, 992351234);
+	AppendInt(payload, longitude + 300000);
+	AppendInt(payload, latitude - 300000);
+	AppendByte(payload, 0x01);
+	AppendShort(payload, 200);
+	AppendShort(payload, 100);
+	AppendShort(payload, 50);
+	AppendShort(payload, 100);
+	AppendByte(payload, 1 << 3);
+	AppendByte(payload, 0x02);
+	AppendByte(payload, 0);
+	AppendByte(payload, 0x00);
+	AppendString(payload, "NAB TOWER");
+	messages.push_back({ 129041, payload });
+
+	// Cross Track Error
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendByte(payload, 0x00);
+	AppendInt(payload, 150);
+	AppendFill(payload, 0xFF, 2);
+	messages.push_back({ 129283, payload });
+
+	// Navigation Data
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendInt(payload, 185200);
+	AppendByte(payload, 0x00);
+	AppendInt(payload, secondsSinceMidnight);
+	AppendShort(payload, daysSinceEpoch);
+	AppendShort(payload, 7854);
+	AppendShort(payload, 7900);
+	AppendInt(payload, 1);
+	AppendInt(payload, 2);
+	AppendInt(payload, latitude + 200000);
+	AppendInt(payload, longitude + 200000);
+	AppendShort(payload, 310);
+	messages.push_back({ 129284, payload });
+
+	// Route & Waypoint Information, a route with two waypoints
+	payload.clear();
+	AppendShort(payload, 0);
+	AppendShort(payload, 2);
+	AppendShort(payload, 1);
+	AppendShort(payload, 1);
+	AppendByte(payload, 0x07);
+	AppendString(payload, "HOME");
+	AppendByte(payload, 0xFF);
+	AppendShort(payload, 1);
+	AppendString(payload, "WP1");
+	AppendInt(payload, latitude + 100000);
+	AppendInt(payload, longitude + 100000);
+	AppendShort(payload, 2);
+	AppendString(payload, "WP2");
+	AppendInt(payload, latitude + 200000);
+	AppendInt(payload, longitude + 200000);
+	messages.push_back({ 129285, payload });
+
+	// AIS UTC and Date Report, from a base station
+	payload.clear();
+	AppendByte(payload, 4);
+	AppendInt(payload, 2320123);
+	AppendInt(payload, longitude);
+	AppendInt(payload, latitude - 100000);
+	AppendByte(payload, 0x01);
+	AppendInt(payload, secondsSinceMidnight);
+	AppendByte(payload, 0x00);
+	AppendByte(payload, 0x00);
+	AppendByte(payload, 0x00);
+	AppendShort(payload, daysSinceEpoch);
+	AppendByte(payload, 0x70);
+	AppendByte(payload, 0xFF);
+	messages.push_back({ 129793, payload });
+
+	// AIS Class A Static and Voyage Related Data
+	payload.clear();
+	AppendByte(payload, 5);
+	AppendInt(payload, mmsi);
+	AppendInt(payload, 9123456);
+	AppendText(payload, "MABC123", 7, '@');
+	AppendText(payload, "ATLANTIC TRADER", 20, '@');
+	AppendByte(payload, 70);
+	AppendShort(payload, 1500);
+	AppendShort(payload, 250);
+	AppendShort(payload, 120);
+	AppendShort(payload, 300);
+	AppendShort(payload, daysSinceEpoch + 2);
+	AppendInt(payload, secondsSinceMidnight);
+	AppendShort(payload, 850);
+	AppendText(payload, "SOUTHAMPTON", 20, '@');
+	AppendByte(payload, 0x00);
+	AppendByte(payload, 0x00);
+	messages.push_back({ 129794, payload });
+
+	// AIS SAR Aircraft Position Report
+	payload.clear();
+	AppendByte(payload, 9);
+	AppendInt(payload, 111232456);
+	AppendInt(payload, longitude + 500000);
+	AppendInt(payload, latitude + 500000);
+	AppendByte(payload, 0x01);
+	AppendShort(payload, 5000);
+	AppendShort(payload, 6000);
+	AppendByte(payload, 0x00);
+	AppendByte(payload, 0x00);
+	AppendByte(payload, 0x00);
+	AppendInt(payload, 150000);
+	AppendFill(payload, 0xFF, 4);
+	AppendByte(payload, 0xFF);
+	AppendByte(payload, 0x00);
+	AppendByte(payload, 0xFF);
+	messages.push_back({ 129798, payload });
+
+	// AIS Addressed Safety Related Message
+	payload.clear();
+	AppendByte(payload, 12);
+	AppendInt(payload, mmsi);
+	AppendByte(payload, 0x00);
+	AppendInt(payload, mmsi + 1);
+	AppendByte(payload, 0x00);
+	AppendString(payload, "KEEP CLEAR OF BUOY");
+	messages.push_back({ 129801, payload });
+
+	// AIS Safety Related Broadcast Message
+	payload.clear();
+	AppendByte(payload, 14);
+	AppendInt(payload, mmsi);
+	AppendByte(payload, 0x00);
+	AppendString(payload, "DIVERS IN THE WATER");
+	messages.push_back({ 129802, payload });
+
+	// Digital Selective Calling, a distress alert
+	payload.clear();
+	AppendByte(payload, 112);
+	AppendByte(payload, 112);
+	AppendByte(payload, 23);
+	AppendByte(payload, 50);
+	AppendByte(payload, 12);
+	AppendByte(payload, 34);
+	AppendByte(payload, 50);
+	AppendByte(payload, 101);
+	AppendByte(payload, 0xFF);
+	AppendFill(payload, 0xFF, 12);
+	AppendFill(payload, 0xFF, 16);
+	AppendInt(payload, latitude);
+	AppendInt(payload, longitude);
+	AppendInt(payload, secondsSinceMidnight);
+	AppendText(payload, "2350123450", 10, 0xFF);
+	AppendFill(payload, 0xFF, 101 - payload.size());
+	AppendByte(payload, 117);
+	AppendByte(payload, 0x00);
+	AppendByte(payload, 0xFF);
+	AppendByte(payload, 0xFF);
+	AppendInt(payload, secondsSinceMidnight);
+	AppendShort(payload, daysSinceEpoch);
+	AppendShort(payload, 1);
+	AppendByte(payload, 0xFF);
+	messages.push_back({ 129808, payload });
+
+	// AIS Class B Static Data, Part A
+	payload.clear();
+	AppendByte(payload, 24);
+	AppendInt(payload, mmsi + 1);
+	AppendText(payload, "SEA BREEZE", 20, '@');
+	AppendByte(payload, 0x00);
+	messages.push_back({ 129809, payload });
+
+	// AIS Class B Static Data, Part B
+	payload.clear();
+	AppendByte(payload, 24);
+	AppendInt(payload, mmsi + 1);
+	AppendByte(payload, 36);
+	AppendText(payload, "ACME123", 7, '@');
+	AppendText(payload, "MABC124", 7, '@');
+	AppendShort(payload, 120);
+	AppendShort(payload, 40);
+	AppendShort(payload, 20);
+	AppendShort(payload, 90);
+	AppendInt(payload, 0);
+	AppendByte(payload, 0x00);
+	AppendByte(payload, 0x00);
+	messages.push_back({ 129810, payload });
+
+	// Wind Data, apparent
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendShort(payload, 620);
+	AppendShort(payload, 7854);
+	AppendByte(payload, 2);
+	AppendFill(payload, 0xFF, 2);
+	messages.push_back({ 130306, payload });
+
+	// Environmental Parameters
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendShort(payload, 28815);
+	AppendShort(payload, 29315);
+	AppendShort(payload, 1013);
+	AppendByte(payload, 0xFF);
+	messages.push_back({ 130310, payload });
+
+	// Environmental Parameters, superseding 130310
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendByte(payload, 0x00);
+	AppendShort(payload, 28815);
+	AppendShort(payload, 16250);
+	AppendShort(payload, 1013);
+	AppendByte(payload, 0xFF);
+	messages.push_back({ 130311, payload });
+
+	// Temperature, sea water
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendByte(payload, 0);
+	AppendByte(payload, 0);
+	AppendShort(payload, 28815);
+	AppendShort(payload, 0xFFFF);
+	AppendByte(payload, 0xFF);
+	messages.push_back({ 130312, payload });
+
+	// Temperature, Extended Range
+	payload.clear();
+	AppendByte(payload, 1);
+	AppendByte(payload, 0);
+	AppendByte(payload, 0);
+	AppendByte(payload, 288150 & 0xFF);
+	AppendShort(payload, 288150 >> 8);
+	AppendShort(payload, 0xFFFF);
+	messages.push_back({ 130316, payload });
+
+	// Direction Data
+	payload.clear();
+	AppendByte(payload, 0x00);
+	AppendByte(payload, 1);
+	AppendShort(payload, 15708);
+	AppendShort(payload, 320);
+	AppendShort(payload, 15500);
+	AppendShort(payload, 310);
+	AppendShort(payload, 7854);
+	AppendShort(payload, 50);
+	messages.push_back({ 130577, payload });
+}
+
+// An Actisense N2K_RX_CMD message, with the overall length and checksum
+std::vector<byte> ActisenseBenchmark::BuildFrame(const unsigned int pgn, const std::vector<byte>& payload) {
+	std::vector<byte> frame;
+	frame.push_back(N2K_RX_CMD);
+	frame.push_back(static_cast<byte>(payload.size() + 11));
+	frame.push_back(CONST_PRIORITY_MEDIUM);
+	frame.push_back(pgn & 0xFF);
+	frame.push_back((pgn >> 8) & 0xFF);
+	frame.push_back((pgn >> 16) & 0xFF);
+	// An ISO Request is addressed to another device, so that the device does not respond
+	frame.push_back((pgn == 59904) ? 0x30 : CONST_GLOBAL_ADDRESS);
+	frame.push_back(0x23);
+	AppendInt(frame, 1000);
+	frame.push_back(static_cast<byte>(payload.size()));
+	frame.insert(frame.end(), payload.begin(), payload.end());
+	frame.push_back(static_cast<byte>(0x100 - TwoCanUtils::ActisenseChecksum(frame.data(), frame.size())));
+	return frame;
+}
+
+// DLE STX, the message with any DLE escaped by a second DLE, then DLE ETX
+void ActisenseBenchmark::AppendEscaped(std::vector<byte>& stream, const std::vector<byte>& frame) {
+	stream.push_back(DLE);
+	stream.push_back(STX);
+	for (std::vector<byte>::const_iterator it = frame.begin(); it != frame.end(); ++it) {
+		if (*it == DLE) {
+			stream.push_back(DLE);
+		}
+		stream.push_back(*it);
+	}
+	stream.push_back(DLE);
+	stream.push_back(ETX);
+}
+
+void ActisenseBenchmark::Drain(void) {
+	while (subscription->Receive(batch, CONST_BUS_BATCH) > 0) {
+		batch.clear();
+	}
+	subscription->Acknowledge();
+
+	std::vector<MemoryFrame> writtenFrames;
+	static_cast<ActisenseMemory *>(device->GetInterface())->TakeWrittenFrames(writtenFrames);
+}
+
+// Double the iterations until they run for the period, then report the fastest of the repetitions.
+// Allocations are deterministic, so are simply averaged
+void ActisenseBenchmark::Measure(const wxString& name, const unsigned int operations, std::function<void(void)> function) {
+	if ((!filter.IsEmpty()) && (!name.Contains(filter))) {
+		return;
+	}
+
+	// Warm the caches, and fill the reusable buffers
+	function();
+
+	unsigned long long iterations = 1;
+	unsigned long long elapsed = 0;
+	while (TRUE) {
+		unsigned long long start = TwoCanUtils::GetMonotonicMicros();
+		for (unsigned long long i = 0; i < iterations; i++) {
+			function();
+		}
+		elapsed = TwoCanUtils::GetMonotonicMicros() - start;
+		if (elapsed >= (CONST_BENCHMARK_PERIOD * 1000)) {
+			break;
+		}
+		iterations *= 2;
+	}
+
+	unsigned long long fastest = elapsed;
+	unsigned long long allocations = 0;
+	for (int i = 0; i < CONST_BENCHMARK_REPETITIONS; i++) {
+		unsigned long long startAllocations = GetAllocations();
+		unsigned long long start = TwoCanUtils::GetMonotonicMicros();
+		for (unsigned long long j = 0; j < iterations; j++) {
+			function();
+		}
+		elapsed = TwoCanUtils::GetMonotonicMicros() - start;
+		allocations += GetAllocations() - startAllocations;
+		fastest = std::min(fastest, elapsed);
+	}
+
+	BenchmarkResult result;
+	result.name = name;
+	result.iterations = iterations * operations;
+	result.nanoseconds = (fastest * 1000.0) / result.iterations;
+	result.allocations = (double)allocations / (result.iterations * CONST_BENCHMARK_REPETITIONS);
+	results.push_back(result);
+
+	wxPrintf(_T("%-24s %12llu %12.1f %10.2f\n"), result.name, result.iterations, result.nanoseconds, result.allocations);
+}
+
+void ActisenseBenchmark::Run(const wxString& nameFilter) {
+	filter = nameFilter;
+	results.clear();
+
+	wxPrintf(_T("%-24s %12s %12s %10s\n"), _T("Benchmark"), _T("Operations"), _T("ns/op"), _T("allocs/op"));
+
+	RunFraming();
+	RunChecksums();
+	RunDispatch();
+	RunDecoders();
+	RunAIS();
+	RunFormatting();
+}
+
+// The BST framing loop, from the bytes read from the serial port until the messages are queued for the device. Per message
+void ActisenseBenchmark::RunFraming(void) {
+	std::vector<byte> stream;
+	for (std::vector<BenchmarkMessage>::iterator it = messages.begin(); it != messages.end(); ++it) {
+		AppendEscaped(stream, BuildFrame(it->pgn, it->payload));
+	}
+
+	ActisenseMemory *memory = static_cast<ActisenseMemory *>(device->GetInterface());
+	ActisenseQueue *queue = device->canQueue;
+	Measure(_T("framing/bst"), messages.size(), [memory, queue, &stream]() {
+		memory->Feed(stream);
+		queue->Clear();
+	});
+}
+
+// The Actisense checksum of the longest message, and the NMEA 0183 checksum of a GGA sentence
+void ActisenseBenchmark::RunChecksums(void) {
+	std::vector<byte> longestFrame;
+	for (std::vector<BenchmarkMessage>::iterator it = messages.begin(); it != messages.end(); ++it) {
+		if ((it->payload.size() + 14) > longestFrame.size()) {
+			longestFrame = BuildFrame(it->pgn, it->payload);
+		}
+	}
+	volatile byte checksum = 0;
+	Measure(_T("checksum/actisense"), 1, [&longestFrame, &checksum]() {
+		checksum += TwoCanUtils::ActisenseChecksum(longestFrame.data(), longestFrame.size());
+	});
+
+	wxString sentence = _T("$IIGGA,120000.00,5048.0000,N,00118.0000,W,2,09,0.90,150.0,M,47.0,M,5.0,0042");
+	wxString nmeaChecksum;
+	Measure(_T("checksum/nmea0183"), 1, [this, &sentence, &nmeaChecksum]() {
+		nmeaChecksum = device->ComputeChecksum(sentence);
+	});
+}
+
+// ParseMessage, from a queued message to the NMEA 0183 sentences and the raw message published on the bus. Per message
+void ActisenseBenchmark::RunDispatch(void) {
+	std::vector<std::vector<byte>> frames;
+	for (std::vector<BenchmarkMessage>::iterator it = messages.begin(); it != messages.end(); ++it) {
+		frames.push_back(BuildFrame(it->pgn, it->payload));
+	}
+
+	Measure(_T("dispatch/mixed"), frames.size(), [this, &frames]() {
+		for (std::vector<std::vector<byte>>::iterator it = frames.begin(); it != frames.end(); ++it) {
+			device->ParseMessage(*it);
+		}
+		Drain();
+	});
+
+	// The whole pipeline, as a tool using the in memory interface would drive it. Per message
+	std::vector<byte> stream;
+	for (std::vector<std::vector<byte>>::iterator it = frames.begin(); it != frames.end(); ++it) {
+		AppendEscaped(stream, *it);
+	}
+	ActisenseMemory *memory = static_cast<ActisenseMemory *>(device->GetInterface());
+	Measure(_T("dispatch/pipeline"), frames.size(), [this, memory, &stream]() {
+		memory->Feed(stream);
+		device->ProcessPendingMessages();
+		Drain();
+	});
+}
+
+// Each decoder, and its formatter, as called by ProcessMessage
+void ActisenseBenchmark::RunDecoders(void) {
+	std::vector<wxString> nmeaSentences;
+	for (std::vector<BenchmarkMessage>::iterator it = messages.begin(); it != messages.end(); ++it) {
+		const BenchmarkMessage *message = &(*it);
+		Measure(wxString::Format(_T("decode/%u"), message->pgn), 1, [this, message, &nmeaSentences]() {
+			Decode(message->pgn, message->payload, &nmeaSentences);
+			nmeaSentences.clear();
+		});
+	}
+}
+
+// Packing the fields of an AIS Static and Voyage Related Data message (type 5) into bits, then encoding them as 6 bit ASCII
+void ActisenseBenchmark::RunAIS(void) {
+	std::vector<bool> binaryData(424);
+	Measure(_T("ais/pack"), 1, [this, &binaryData]() {
+		device->AISInsertInteger(binaryData, 0, 6, 5);
+		device->AISInsertInteger(binaryData, 6, 2, 0);
+		device->AISInsertInteger(binaryData, 8, 30, 235012345);
+		device->AISInsertInteger(binaryData, 38, 2, 0);
+		device->AISInsertInteger(binaryData, 40, 30, 9123456);
+		device->AISInsertString(binaryData, 70, 42, "MABC123");
+		device->AISInsertString(binaryData, 112, 120, "ATLANTIC TRADER");
+		device->AISInsertInteger(binaryData, 232, 8, 70);
+		device->AISInsertInteger(binaryData, 240, 9, 30);
+		device->AISInsertInteger(binaryData, 249, 9, 120);
+		device->AISInsertInteger(binaryData, 258, 6, 13);
+		device->AISInsertInteger(binaryData, 264, 6, 12);
+		device->AISInsertInteger(binaryData, 270, 4, 1);
+		device->AISInsertDate(binaryData, 274, 20, 21, 10, 12, 0);
+		device->AISInsertInteger(binaryData, 294, 8, 85);
+		device->AISInsertString(binaryData, 302, 120, "SOUTHAMPTON");
+		device->AISInsertInteger(binaryData, 422, 1, 0);
+		device->AISInsertInteger(binaryData, 423, 1, 0);
+	});
+
+	wxString encodedPayload;
+	Measure(_T("ais/encode"), 1, [this, &binaryData, &encodedPayload]() {
+		encodedPayload = device->AISEncodePayload(binaryData);
+	});
+}
+
+// Appending the checksum and publishing a sentence
+void ActisenseBenchmark::RunFormatting(void) {
+	wxString sentence = _T("$IIGGA,120000.00,5048.0000,N,00118.0000,W,2,09,0.90,150.0,M,47.0,M,5.0,0042");
+	device->wantedSentences = SENTENCE_MASK_ALL;
+	Measure(_T("format/sentence"), 1, [this, &sentence]() {
+		device->SendNMEASentence(sentence);
+		device->publishedSentences.clear();
+	});
+}
+
+// The decoder ProcessMessage uses for each PGN, without its bookkeeping
+bool ActisenseBenchmark::Decode(const unsigned int pgn, const std::vector<byte>& payload, std::vector<wxString> *nmeaSentences) {
+	unsigned int requestedPGN;
+	unsigned int heartbeatInterval;
+	DeviceInformation deviceInformation;
+	ProductInformation productInformation;
+
+	switch (pgn) {
+		case 59904: return device->DecodePGN59904(payload, &requestedPGN);
+		case 60928: return device->DecodePGN60928(payload, &deviceInformation);
+		case 65240: return device->DecodePGN65240(payload, &deviceInformation);
+		case 126992: return device->DecodePGN126992(payload, nmeaSentences);
+		case 126993: return device->DecodePGN126993(0x23, payload, &heartbeatInterval);
+		case 126996: return device->DecodePGN126996(payload, &productInformation);
+		case 127245: return device->DecodePGN127245(payload, nmeaSentences);
+		case 127250: return (ActisenseDecode::DecodeHeading(payload, &device->decodedMessage.heading)) && (device->FormatHeading(device->decodedMessage.heading, nmeaSentences));
+		case 127251: return device->DecodePGN127251(payload, nmeaSentences);
+		case 127257: return device->DecodePGN127257(payload, nmeaSentences);
+		case 127258: return device->DecodePGN127258(payload, nmeaSentences);
+		case 127488: return device->DecodePGN127488(payload, nmeaSentences);
+		case 127489: return device->DecodePGN127489(payload, nmeaSentences);
+		case 127505: return device->DecodePGN127505(payload, nmeaSentences);
+		case 127508: return device->DecodePGN127508(payload, nmeaSentences);
+		case 128259: return device->DecodePGN128259(payload, nmeaSentences);
+		case 128267: return device->DecodePGN128267(payload, nmeaSentences);
+		case 128275: return device->DecodePGN128275(payload, nmeaSentences);
+		case 129025: return (ActisenseDecode::DecodePosition(payload, &device->decodedMessage.position)) && (device->FormatPosition(device->decodedMessage.position, nmeaSentences));
+		case 129026: return (ActisenseDecode::DecodeCourseOverGround(payload, &device->decodedMessage.courseOverGround)) && (device->FormatCourseOverGround(device->decodedMessage.courseOverGround, nmeaSentences));
+		case 129029: return (ActisenseDecode::DecodeGnssFix(payload, &device->decodedMessage.gnssFix)) && (device->FormatGnssFix(device->decodedMessage.gnssFix, nmeaSentences));
+		case 129033: return device->DecodePGN129033(payload, nmeaSentences);
+		case 129038: return (ActisenseDecode::DecodeAisClassAReport(payload, &device->decodedMessage.aisClassAReport)) && (device->FormatAisClassAReport(device->decodedMessage.aisClassAReport, nmeaSentences));
+		case 129039: return device->DecodePGN129039(payload, nmeaSentences);
+		case 129040: return device->DecodePGN129040(payload, nmeaSentences);
+		case 129041: return device->DecodePGN129041(payload, nmeaSentences);
+		case 129283: return device->DecodePGN129283(payload, nmeaSentences);
+		case 129284: return device->DecodePGN129284(payload, nmeaSentences);
+		case 129285: return device->DecodePGN129285(payload, nmeaSentences);
+		case 129793: return device->DecodePGN129793(payload, nmeaSentences);
+		case 129794: return device->DecodePGN129794(payload, nmeaSentences);
+		case 129798: return device->DecodePGN129798(payload, nmeaSentences);
+		case 129801: return device->DecodePGN129801(payload, nmeaSentences);
+		case 129802: return device->DecodePGN129802(payload, nmeaSentences);
+		case 129808: return device->DecodePGN129808(payload, nmeaSentences);
+		case 129809: return device->DecodePGN129809(payload, nmeaSentences);
+		case 129810: return device->DecodePGN129810(payload, nmeaSentences);
+		case 130306: return device->DecodePGN130306(payload, nmeaSentences);
+		case 130310: return device->DecodePGN130310(payload, nmeaSentences);
+		case 130311: return device->DecodePGN130311(payload, nmeaSentences);
+		case 130312: return device->DecodePGN130312(payload, nmeaSentences);
+		case 130316: return device->DecodePGN130316(payload, nmeaSentences);
+		case 130577: return device->DecodePGN130577(payload, nmeaSentences);
+		default: return FALSE;
+	}
+}
+
+// One benchmark per line, so that baselines diff well and can be read back without a JSON parser
+int ActisenseBenchmark::SaveBaseline(const wxString& fileName) {
+	wxFile baselineFile;
+	if (!baselineFile.Open(fileName, wxFile::write)) {
+		wxLogError(_T("Actisense Benchmark, Unable to create baseline %s"), fileName);
+		return SET_ERROR(TWOCAN_RESULT_ERROR, TWOCAN_SOURCE_DEVICE, TWOCAN_ERROR_PATH_NOT_FOUND);
+	}
+
+	baselineFile.Write("{\"benchmarks\":[\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		baselineFile.Write(wxString::Format("{\"name\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.1f,\"allocs_per_op\":%.2f}%s\n",
+			results[i].name, results[i].iterations, results[i].nanoseconds, results[i].allocations, (i + 1 < results.size()) ? "," : ""));
+	}
+	baselineFile.Write("]}\n");
+	baselineFile.Close();
+	return TWOCAN_RESULT_SUCCESS;
+}
+
+int ActisenseBenchmark::CompareBaseline(const wxString& fileName, const int threshold, int *regressions) {
+	wxFile baselineFile;
+	wxString baseline;
+	if ((!baselineFile.Open(fileName, wxFile::read)) || (!baselineFile.ReadAll(&baseline))) {
+		wxLogError(_T("Actisense Benchmark, Unable to read baseline %s"), fileName);
+		return SET_ERROR(TWOCAN_RESULT_ERROR, TWOCAN_SOURCE_DEVICE, TWOCAN_ERROR_PATH_NOT_FOUND);
+	}
+
+	*regressions = 0;
+	wxPrintf(_T("\n%-24s %12s %12s %8s %10s %10s\n"), _T("Benchmark"), _T("Baseline"), _T("ns/op"), _T("Change"), _T("Baseline"), _T("allocs/op"));
+	wxStringTokenizer tokenizer(baseline, _T("\n"));
+	while (tokenizer.HasMoreTokens()) {
+		char name[64];
+		unsigned long long iterations;
+		double nanoseconds;
+		double allocations;
+		if (sscanf(tokenizer.GetNextToken().mb_str(), "{\"name\":\"%63[^\"]\",\"iterations\":%llu,\"ns_per_op\":%lf,\"allocs_per_op\":%lf", 
+			name, &iterations, &nanoseconds, &allocations) != 4) {
+			continue;
+		}
+		for (std::vector<BenchmarkResult>::iterator it = results.begin(); it != results.end(); ++it) {
+			if (it->name.Cmp(name) == 0) {
+				double change = (nanoseconds > 0) ? ((it->nanoseconds - nanoseconds) * 100.0) / nanoseconds : 0;
+				// Allocations are rounded to two decimal places in the baseline
+				bool isRegression = (change > threshold) || (it->allocations > allocations + 0.005);
+				if (isRegression) {
+					(*regressions)++;
+				}
+				wxPrintf(_T("%-24s %12.1f %12.1f %+7.1f%% %10.2f %10.2f%s\n"), it->name, nanoseconds, it->nanoseconds, change,
+					allocations, it->allocations, isRegression ? _T(" REGRESSION") : _T(""));
+				break;
+			}
+		}
+	}
+	return TWOCAN_RESULT_SUCCESS;
+}
+
+// Usage: actisense_benchmark [--filter name] [--save baseline.json] [--compare baseline.json] [--threshold percent]
+int main(int argc, char **argv) {
+	wxInitializer initializer;
+	if (!initializer.IsOk()) {
+		fprintf(stderr, "Failed to initialize wxWidgets\n");
+		return EXIT_FAILURE;
+	}
+
+	wxString filter;
+	wxString saveFile;
+	wxString compareFile;
+	long threshold = CONST_BENCHMARK_THRESHOLD;
+	for (int i = 1; i < argc; i++) {
+		wxString argument(argv[i]);
+		if ((argument == _T("--filter")) && (i + 1 < argc)) {
+			filter = argv[++i];
+		}
+		else if ((argument == _T("--save")) && (i + 1 < argc)) {
+			saveFile = argv[++i];
+		}
+		else if ((argument == _T("--compare")) && (i + 1 < argc)) {
+			compareFile = argv[++i];
+		}
+		else if ((argument == _T("--threshold")) && (i + 1 < argc)) {
+			wxString(argv[++i]).ToLong(&threshold);
+		}
+		else {
+			fprintf(stderr, "Usage: %s [--filter name] [--save baseline.json] [--compare baseline.json] [--threshold percent]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	ActisenseBenchmark benchmark;
+	int returnCode = benchmark.Init();
+	if (returnCode != TWOCAN_RESULT_SUCCESS) {
+		fprintf(stderr, "Failed to initialize the device (%d)\n", returnCode);
+		return EXIT_FAILURE;
+	}
+
+	benchmark.Run(filter);
+
+	if ((!saveFile.IsEmpty()) && (benchmark.SaveBaseline(saveFile) != TWOCAN_RESULT_SUCCESS)) {
+		return EXIT_FAILURE;
+	}
+
+	if (!compareFile.IsEmpty()) {
+		int regressions;
+		if (benchmark.CompareBaseline(compareFile, threshold, &regressions) != TWOCAN_RESULT_SUCCESS) {
+			return EXIT_FAILURE;
+		}
+		if (regressions > 0) {
+			wxPrintf(_T("\n%d benchmarks are more than %ld%% slower, or allocate more\n"), regressions, threshold);
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,291 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseBus - Publish/subscribe bus for received messages
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+// Version History: 
+// 1.0 Initial Release
+//
+
+#include "actisense_bus.h"
+
+// Indexed by SENTENCE_ type
+static const char *sentenceTypeNames[SENTENCE_TYPES] = {
+	"BOD", "BWC", "BWR", "DBT", "DPT", "GGA", "GLL", "HDG", "HDM", "HDT", "MTW", "MWV", "ROT", 
+	"RPM", "RSA", "RTE", "VDM", "VHW", "VLW", "VTG", "WCV", "WPL", "XDR", "XTE", "ZDA"
+};
+
+ActisenseSubscription::ActisenseSubscription(const wxString& name, const BusFilter& filter, const size_t capacity, wxEvtHandler *handler, const wxEventType eventType, const int eventId) {
+	this->name = name;
+	this->filter = filter;
+	InitRing(&normalRing, capacity);
+	InitRing(&safetyRing, CONST_SUBSCRIPTION_SAFETY_SIZE);
+	this->handler = handler;
+	this->eventType = eventType;
+	this->eventId = eventId;
+	doorbell = FALSE;
+	delivered = 0;
+	dropped = 0;
+	highWaterMark = 0;
+}
+
+ActisenseSubscription::~ActisenseSubscription(void) {
+}
+
+// Round the capacity up to a power of two
+void ActisenseSubscription::InitRing(SubscriptionRing *ring, const size_t capacity) {
+	size_t size = 1;
+	while (size < capacity) {
+		size <<= 1;
+	}
+	ring->messages.resize(size);
+	ring->mask = size - 1;
+	ring->head = 0;
+	ring->tail = 0;
+}
+
+bool ActisenseSubscription::Matches(const CanHeader& header, const SentenceMask sentenceTypes) const {
+	if ((filter.sentencesOnly) && ((sentenceTypes & filter.sentenceTypes) == 0)) {
+		return FALSE;
+	}
+	if ((filter.sources.any()) && (!filter.sources.test(header.source))) {
+		return FALSE;
+	}
+	if ((!filter.pgns.empty()) && (std::find(filter.pgns.begin(), filter.pgns.end(), header.pgn) == filter.pgns.end())) {
+		return FALSE;
+	}
+	return TRUE;
+}
+
+// Only the producer writes head and only the consumer writes tail, so a slot is owned by one side at a time
+bool ActisenseSubscription::Push(const BusMessagePtr& message) {
+	SubscriptionRing *ring = (ActisenseQueue::GetPGNClass(message->header.pgn) == PGN_CLASS_SAFETY) ? &safetyRing : &normalRing;
+	size_t currentHead = ring->head.load(std::memory_order_relaxed);
+	size_t depth = currentHead - ring->tail.load(std::memory_order_acquire);
+	if (depth > ring->mask) {
+		// Full, never wait for a slow consumer
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return FALSE;
+	}
+	ring->messages[currentHead & ring->mask] = message;
+	ring->head.store(currentHead + 1, std::memory_order_release);
+
+	delivered.fetch_add(1, std::memory_order_relaxed);
+	if (depth + 1 > highWaterMark.load(std::memory_order_relaxed)) {
+		highWaterMark.store(depth + 1, std::memory_order_relaxed);
+	}
+
+	// Ring the doorbell, unless the consumer has yet to answer the last ring
+	if ((handler != NULL) && (!doorbell.exchange(TRUE))) {
+		wxQueueEvent(handler, new wxCommandEvent(eventType, eventId));
+	}
+	return TRUE;
+}
+
+// Called before draining the queue, so that any message pushed whilst draining rings the doorbell again
+void ActisenseSubscription::Acknowledge(void) {
+	doorbell.store(FALSE);
+}
+
+// Safety messages first, then the others in the order they were published
+size_t ActisenseSubscription::Receive(std::vector<BusMessagePtr>& batch, const size_t maximum) {
+	size_t count = TakeRing(&safetyRing, batch, maximum);
+	return count + TakeRing(&normalRing, batch, maximum - count);
+}
+
+size_t ActisenseSubscription::TakeRing(SubscriptionRing *ring, std::vector<BusMessagePtr>& batch, const size_t maximum) {
+	size_t currentTail = ring->tail.load(std::memory_order_relaxed);
+	size_t available = ring->head.load(std::memory_order_acquire) - currentTail;
+	size_t count = (available < maximum) ? available : maximum;
+	for (size_t i = 0; i < count; i++) {
+		// Release the queue's reference as the message is taken
+		batch.push_back(std::move(ring->messages[(currentTail + i) & ring->mask]));
+		ring->messages[(currentTail + i) & ring->mask].reset();
+	}
+	ring->tail.store(currentTail + count, std::memory_order_release);
+	return count;
+}
+
+SubscriptionStatistics ActisenseSubscription::GetStatistics(void) {
+	SubscriptionStatistics statistics;
+	statistics.delivered = delivered.load(std::memory_order_relaxed);
+	statistics.dropped = dropped.load(std::memory_order_relaxed);
+	statistics.highWaterMark = highWaterMark.load(std::memory_order_relaxed);
+	return statistics;
+}
+
+ActisenseBus::ActisenseBus(void) {
+	for (int i = 0; i < CONST_BUS_SUBSCRIBERS; i++) {
+		subscriptions[i] = NULL;
+	}
+	subscriberCount = 0;
+	wantedSentences = 0;
+}
+
+ActisenseBus::~ActisenseBus(void) {
+}
+
+bool ActisenseBus::Subscribe(ActisenseSubscription *subscription) {
+	wxMutexLocker lock(busMutex);
+	for (int i = 0; i < CONST_BUS_SUBSCRIBERS; i++) {
+		if (subscriptions[i] == NULL) {
+			subscriptions[i] = subscription;
+			subscriberCount++;
+			UpdateWantedSentences();
+			EnablePgns(subscription);
+			return TRUE;
+		}
+	}
+	wxLogMessage(_T("Actisense Bus, No free subscriptions for %s"), subscription->GetName());
+	return FALSE;
+}
+
+void ActisenseBus::Unsubscribe(ActisenseSubscription *subscription) {
+	wxMutexLocker lock(busMutex);
+	for (int i = 0; i < CONST_BUS_SUBSCRIBERS; i++) {
+		if (subscriptions[i] == subscription) {
+			subscriptions[i] = NULL;
+			subscriberCount--;
+			UpdateWantedSentences();
+			SubscriptionStatistics statistics = subscription->GetStatistics();
+			wxLogMessage(_T("Actisense Bus, %s, Delivered: %llu, Dropped: %llu, High Water Mark: %lu"), 
+				subscription->GetName(), statistics.delivered, statistics.dropped, statistics.highWaterMark);
+			return;
+		}
+	}
+}
+
+void ActisenseBus::UpdateWantedSentences(void) {
+	SentenceMask mask = 0;
+	for (int i = 0; i < CONST_BUS_SUBSCRIBERS; i++) {
+		if (subscriptions[i] != NULL) {
+			mask |= subscriptions[i]->filter.sentenceTypes;
+		}
+	}
+	wantedSentences.store(mask);
+}
+
+void ActisenseBus::EnablePgns(const ActisenseSubscription *subscription) {
+	// Subscribers to sentences receive whatever PGN's supportedPGN enables
+	if (subscription->filter.sentencesOnly) {
+		return;
+	}
+	if (subscription->filter.pgns.empty()) {
+		pgnFilter.EnableAll();
+	}
+	else {
+		for (std::vector<unsigned int>::const_iterator it = subscription->filter.pgns.begin(); it != subscription->filter.pgns.end(); ++it) {
+			pgnFilter.Enable(*it);
+		}
+	}
+}
+
+void ActisenseBus::EnableSubscribedPgns(void) {
+	wxMutexLocker lock(busMutex);
+	for (int i = 0; i < CONST_BUS_SUBSCRIBERS; i++) {
+		if (subscriptions[i] != NULL) {
+			EnablePgns(subscriptions[i]);
+		}
+	}
+}
+
+// Sentences are formatted as $IIxxx or !AIxxx
+int ActisenseBus::GetSentenceType(const wxString& sentence) {
+	if (sentence.length() < 6) {
+		return NOT_FOUND;
+	}
+	for (int i = 0; i < SENTENCE_TYPES; i++) {
+		if ((sentence[3] == sentenceTypeNames[i][0]) && (sentence[4] == sentenceTypeNames[i][1]) && (sentence[5] == sentenceTypeNames[i][2])) {
+			return i;
+		}
+	}
+	return NOT_FOUND;
+}
+
+SentenceMask ActisenseBus::ParseSentenceTypes(const wxString& sentenceTypes) {
+	SentenceMask mask = 0;
+	wxStringTokenizer tokenizer(sentenceTypes, _T(","));
+	while (tokenizer.HasMoreTokens()) {
+		wxString token = tokenizer.GetNextToken().Trim().Trim(FALSE).Upper();
+		bool isFound = FALSE;
+		for (int i = 0; i < SENTENCE_TYPES; i++) {
+			if (token.IsSameAs(sentenceTypeNames[i])) {
+				mask |= SENTENCE_MASK(i);
+				isFound = TRUE;
+			}
+		}
+		if ((!isFound) && (!token.IsEmpty())) {
+			wxLogMessage(_T("Actisense Bus, Unknown sentence type %s"), token);
+		}
+	}
+	return (mask == 0) ? SENTENCE_MASK_ALL : mask;
+}
+
+// The mutex is uncontended unless a subscriber is being added or removed
+void ActisenseBus::Publish(const CanHeader& header, const std::vector<byte>& payload, const DecodedMessage& decoded, const std::vector<wxString>& sentences, const SentenceMask sentenceTypes, const unsigned int traceId) {
+	if (subscriberCount.load(std::memory_order_relaxed) == 0) {
+		return;
+	}
+
+	wxMutexLocker lock(busMutex);
+	// Each subscriber receives only the sentence types it subscribed to, rather than every sentence the PGN produced.
+	// Subscribers that want the same types share the one message, usually there is only one
+	BusMessagePtr messages[CONST_BUS_SUBSCRIBERS];
+	SentenceMask messageTypes[CONST_BUS_SUBSCRIBERS];
+	int messageCount = 0;
+	for (int i = 0; i < CONST_BUS_SUBSCRIBERS; i++) {
+		if ((subscriptions[i] != NULL) && (subscriptions[i]->Matches(header, sentenceTypes))) {
+			SentenceMask types = sentenceTypes & subscriptions[i]->filter.sentenceTypes;
+			int j = 0;
+			while ((j < messageCount) && (messageTypes[j] != types)) {
+				j++;
+			}
+			if (j == messageCount) {
+				std::shared_ptr<BusMessage> newMessage = std::make_shared<BusMessage>();
+				newMessage->header = header;
+				newMessage->payload = payload;
+				newMessage->decoded = decoded;
+				if (types == sentenceTypes) {
+					newMessage->sentences = sentences;
+				}
+				else {
+					// Sentences of a type we don't produce can't be subscribed to, so they are not filtered
+					for (std::vector<wxString>::const_iterator it = sentences.begin(); it != sentences.end(); ++it) {
+						int sentenceType = GetSentenceType(*it);
+						if ((sentenceType == NOT_FOUND) || (types & SENTENCE_MASK(sentenceType))) {
+							newMessage->sentences.push_back(*it);
+						}
+					}
+				}
+				newMessage->sentenceTypes = types;
+				newMessage->traceId = traceId;
+				messages[j] = newMessage;
+				messageTypes[j] = types;
+				messageCount++;
+			}
+			subscriptions[i]->Push(messages[j]);
+		}
+	}
+}
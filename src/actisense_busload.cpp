@@ -0,0 +1,185 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseBusLoad - Estimates the bus load and its top talkers
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+// Version History: 
+// 1.0 Initial Release
+//
+
+#include "actisense_busload.h"
+
+ActisenseBusLoad::ActisenseBusLoad(void) {
+	Reset();
+}
+
+ActisenseBusLoad::~ActisenseBusLoad(void) {
+}
+
+void ActisenseBusLoad::Reset(void) {
+	total = {};
+	for (int i = 0; i < CONST_BUSLOAD_SOURCES; i++) {
+		sources[i] = {};
+		sources[i].id = i;
+	}
+	for (int i = 0; i < CONST_BUSLOAD_PGNS; i++) {
+		pgns[i] = {};
+	}
+	lastUpdate = 0;
+	peakUtilisation = 0;
+
+	wxMutexLocker lock(snapshotMutex);
+	snapshot = {};
+}
+
+// The first Fast Packet frame carries 6 data bytes and each subsequent frame 7.
+// An ISO Transport Protocol transfer is announced (BAM or RTS) then sent in 7 byte packets,
+// the receiver's CTS and EOMA are not counted
+unsigned int ActisenseBusLoad::CountFrames(const size_t payloadLength, const bool isFastPacket) {
+	if (isFastPacket) {
+		return (payloadLength <= 6) ? 1 : 1 + static_cast<unsigned int>(((payloadLength - 6) + 7 - 1) / 7);
+	}
+	if (payloadLength <= CONST_PAYLOAD_LENGTH) {
+		return 1;
+	}
+	return 1 + static_cast<unsigned int>((payloadLength + 6) / 7);
+}
+
+// A stuff bit is inserted after every 5 consecutive identical bits, in the worst case every 4 bits after the first
+unsigned int ActisenseBusLoad::FrameBits(const size_t dataLength) {
+	unsigned int stuffedBits = CONST_CAN_STUFFED_BITS + (8 * static_cast<unsigned int>(dataLength));
+	return stuffedBits + ((stuffedBits - 1) / 4) + CONST_CAN_UNSTUFFED_BITS;
+}
+
+void ActisenseBusLoad::Record(const CanHeader& header, const size_t payloadLength, const bool isFastPacket) {
+	unsigned int frames = CountFrames(payloadLength, isFastPacket);
+	// Multi frame messages are sent in full 8 byte frames
+	unsigned int bits = (frames == 1) ? FrameBits(payloadLength) : frames * FrameBits(CONST_PAYLOAD_LENGTH);
+
+	total.frames += frames;
+	total.bits += bits;
+
+	RateCounter *source = &sources[header.source];
+	source->inUse = TRUE;
+	source->frames += frames;
+	source->bits += bits;
+
+	RateCounter *pgn = FindPgn(header.pgn);
+	pgn->frames += frames;
+	pgn->bits += bits;
+}
+
+// Linear search, but the table is short. If the PGN has no counter, reuse the least active one
+ActisenseBusLoad::RateCounter *ActisenseBusLoad::FindPgn(const unsigned int pgn) {
+	RateCounter *leastActive = &pgns[0];
+	for (int i = 0; i < CONST_BUSLOAD_PGNS; i++) {
+		if ((pgns[i].inUse) && (pgns[i].id == pgn)) {
+			return &pgns[i];
+		}
+		if ((!pgns[i].inUse) || ((leastActive->inUse) && (pgns[i].bitsPerSecond + pgns[i].bits < leastActive->bitsPerSecond + leastActive->bits))) {
+			leastActive = &pgns[i];
+		}
+	}
+	*leastActive = {};
+	leastActive->id = pgn;
+	leastActive->inUse = TRUE;
+	return leastActive;
+}
+
+// Exponentially weighted moving average of the rate measured over each interval
+void ActisenseBusLoad::DecayCounter(RateCounter *counter, const double seconds) {
+	counter->framesPerSecond = (CONST_BUSLOAD_DECAY * counter->framesPerSecond) + ((1.0 - CONST_BUSLOAD_DECAY) * counter->frames / seconds);
+	counter->bitsPerSecond = (CONST_BUSLOAD_DECAY * counter->bitsPerSecond) + ((1.0 - CONST_BUSLOAD_DECAY) * counter->bits / seconds);
+	counter->frames = 0;
+	counter->bits = 0;
+}
+
+// The busiest counters first, omitting those that are idle
+void ActisenseBusLoad::Rank(const RateCounter *counters, const size_t count, const double totalBitsPerSecond, std::vector<TalkerRate>& talkers) {
+	talkers.clear();
+	for (size_t i = 0; i < count; i++) {
+		if ((counters[i].inUse) && (counters[i].bitsPerSecond >= 1.0)) {
+			TalkerRate talker;
+			talker.id = counters[i].id;
+			talker.framesPerSecond = counters[i].framesPerSecond;
+			talker.bitsPerSecond = counters[i].bitsPerSecond;
+			talker.share = (totalBitsPerSecond > 0) ? (100.0 * counters[i].bitsPerSecond) / totalBitsPerSecond : 0;
+			talkers.push_back(talker);
+		}
+	}
+	size_t topTalkers = std::min(talkers.size(), static_cast<size_t>(CONST_TOP_TALKERS));
+	std::partial_sort(talkers.begin(), talkers.begin() + topTalkers, talkers.end(),
+		[](const TalkerRate& a, const TalkerRate& b) { return a.bitsPerSecond > b.bitsPerSecond; });
+	talkers.resize(topTalkers);
+}
+
+void ActisenseBusLoad::Update(const unsigned long long now) {
+	if (lastUpdate == 0) {
+		lastUpdate = now;
+		return;
+	}
+	if ((now - lastUpdate) < CONST_BUSLOAD_INTERVAL) {
+		return;
+	}
+
+	double seconds = (now - lastUpdate) / 1000.0;
+	lastUpdate = now;
+
+	DecayCounter(&total, seconds);
+	for (int i = 0; i < CONST_BUSLOAD_SOURCES; i++) {
+		if (sources[i].inUse) {
+			DecayCounter(&sources[i], seconds);
+		}
+	}
+	for (int i = 0; i < CONST_BUSLOAD_PGNS; i++) {
+		if (pgns[i].inUse) {
+			DecayCounter(&pgns[i], seconds);
+		}
+	}
+
+	double utilisation = (100.0 * total.bitsPerSecond) / CONST_BUS_BIT_RATE;
+	peakUtilisation = std::max(peakUtilisation, utilisation);
+
+	BusLoadSnapshot latest;
+	latest.framesPerSecond = total.framesPerSecond;
+	latest.bitsPerSecond = total.bitsPerSecond;
+	latest.utilisation = utilisation;
+	latest.peakUtilisation = peakUtilisation;
+	Rank(sources, CONST_BUSLOAD_SOURCES, total.bitsPerSecond, latest.sources);
+	Rank(pgns, CONST_BUSLOAD_PGNS, total.bitsPerSecond, latest.pgns);
+
+	wxMutexLocker lock(snapshotMutex);
+	snapshot.framesPerSecond = latest.framesPerSecond;
+	snapshot.bitsPerSecond = latest.bitsPerSecond;
+	snapshot.utilisation = latest.utilisation;
+	snapshot.peakUtilisation = latest.peakUtilisation;
+	snapshot.sources.swap(latest.sources);
+	snapshot.pgns.swap(latest.pgns);
+}
+
+void ActisenseBusLoad::GetSnapshot(BusLoadSnapshot *busLoadSnapshot) {
+	wxMutexLocker lock(snapshotMutex);
+	*busLoadSnapshot = snapshot;
+}
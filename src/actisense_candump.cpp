@@ -0,0 +1,186 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseCanDump - Reads Linux candump log files
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+// Version History: 
+// 1.0 Initial Release
+//
+
+#include <actisense_candump.h>
+
+ActisenseCanDump::ActisenseCanDump(ActisenseQueue *messageQueue) : ActisenseInterface(messageQueue) {
+}
+
+ActisenseCanDump::~ActisenseCanDump() {
+}
+
+int ActisenseCanDump::Open(const wxString& fileName) {
+	// Open the log file
+	logFileName = wxStandardPaths::Get().GetDocumentsDir() + wxFileName::GetPathSeparator() + fileName;
+
+	wxLogMessage(_T("Actisense Candump, Attempting to open log file: %s"), logFileName.c_str());
+	
+	logFileStream.open(logFileName.c_str(), std::ifstream::in);
+	
+	if (logFileStream.fail()) {
+		wxLogMessage(_T("Actisense Candump, Failed to open file: %s"), logFileName.c_str());
+		return SET_ERROR(TWOCAN_RESULT_FATAL, TWOCAN_SOURCE_DRIVER,TWOCAN_ERROR_FILE_NOT_FOUND);
+	}
+	else {
+		wxLogMessage(_T("Actisense Candump, Successfully opened file: %s"), logFileName.c_str());
+		return TWOCAN_RESULT_SUCCESS;
+	}
+}
+
+int ActisenseCanDump::Close(void) {
+	if (logFileStream.is_open()) {
+		logFileStream.close();
+	}
+	return TWOCAN_RESULT_SUCCESS;
+}
+
+// Tokens are either the optional (timestamp), the interface name, then either Id#Data or Id [Length] Data bytes
+bool ActisenseCanDump::ParseLine(const std::string& line, std::vector<byte>& message, double *timestamp) {
+	std::istringstream lineStream(line);
+	std::vector<std::string> tokens;
+	std::string token;
+	unsigned long canId = 0;
+	std::vector<byte> data;
+
+	while (lineStream >> token) {
+		tokens.push_back(token);
+	}
+
+	*timestamp = -1;
+	if ((tokens.size() > 0) && (tokens[0].at(0) == '(')) {
+		*timestamp = strtod(tokens[0].c_str() + 1, NULL);
+	}
+
+	bool found = false;
+	for (size_t i = 0; (i < tokens.size()) && (!found); i++) {
+		size_t separator = tokens[i].find('#');
+		if (separator != std::string::npos) {
+			// candump -l format
+			canId = strtoul(tokens[i].substr(0, separator).c_str(), NULL, 16);
+			for (size_t j = separator + 1; j + 1 < tokens[i].size(); j += 2) {
+				data.push_back((byte)strtoul(tokens[i].substr(j, 2).c_str(), NULL, 16));
+			}
+			found = true;
+		}
+		else if ((i > 0) && (tokens[i].size() > 2) && (tokens[i].at(0) == '[')) {
+			// default format
+			canId = strtoul(tokens[i - 1].c_str(), NULL, 16);
+			unsigned long length = strtoul(tokens[i].c_str() + 1, NULL, 10);
+			for (size_t j = i + 1; (j < tokens.size()) && (data.size() < length); j++) {
+				data.push_back((byte)strtoul(tokens[j].c_str(), NULL, 16));
+			}
+			found = true;
+		}
+	}
+
+	if ((!found) || (data.size() == 0) || (data.size() > CONST_PAYLOAD_LENGTH)) {
+		return false;
+	}
+
+	// Drop unwanted PGN's before building the message
+	CanHeader header;
+	byte id[4] = { (byte)(canId & 0xFF), (byte)((canId >> 8) & 0xFF), (byte)((canId >> 16) & 0xFF), (byte)((canId >> 24) & 0xFF) };
+	TwoCanUtils::DecodeCanHeader(id, &header);
+	if (!pgnFilter.IsEnabled(header.pgn)) {
+		pgnFilter.CountFiltered();
+		return false;
+	}
+
+	unsigned int logTime = (*timestamp >= 0) ? (unsigned int)((unsigned long long)(*timestamp * 1000) & 0xFFFFFFFF) : 0;
+	message.clear();
+	message.push_back(CAN_RX_CMD);
+	message.push_back(canId & 0xFF);
+	message.push_back((canId >> 8) & 0xFF);
+	message.push_back((canId >> 16) & 0xFF);
+	message.push_back((canId >> 24) & 0xFF);
+	message.push_back(logTime & 0xFF);
+	message.push_back((logTime >> 8) & 0xFF);
+	message.push_back((logTime >> 16) & 0xFF);
+	message.push_back((logTime >> 24) & 0xFF);
+	message.push_back(data.size());
+	message.insert(message.end(), data.begin(), data.end());
+	return true;
+}
+
+void ActisenseCanDump::Read() {
+	std::string line;
+	std::vector<byte> message;
+	double timestamp;
+	double previousTimestamp = -1;
+
+	while (!TestDestroy()) {
+
+		if (std::getline(logFileStream, line)) {
+			if (ParseLine(line, message, &timestamp)) {
+				deviceQueue->Post(message);
+
+				// Replay at the rate the frames were logged, otherwise at the same rate as the EBL log reader
+				if ((timestamp >= 0) && (previousTimestamp >= 0) && (timestamp >= previousTimestamp)) {
+					double interval = (timestamp - previousTimestamp) * 1000;
+					if (interval >= 1) {
+						wxThread::Sleep((interval > 1000) ? 1000 : (unsigned long)interval);
+					}
+				}
+				else if (timestamp < 0) {
+					wxThread::Sleep(5);
+				}
+				previousTimestamp = timestamp;
+			}
+		}
+		else {
+			// If end of file, rewind to beginning
+			logFileStream.clear();
+			logFileStream.seekg(0, std::ios::beg);
+			previousTimestamp = -1;
+			wxLogMessage(_T("Actisense Candump, Rewinding Log File"));
+			wxThread::Sleep(5);
+		}
+
+	} // end while !TestDestroy
+
+	wxLogMessage(_T("Actisense Candump, Thread terminated"));
+}
+
+// Entry, the method that is executed upon thread start
+wxThread::ExitCode ActisenseCanDump::Entry() {
+	// Merely loops continuously reading the log file
+	wxLogMessage(_T("Actisense Candump, Read Thread Starting"));
+	Read();
+	return (wxThread::ExitCode)TWOCAN_RESULT_SUCCESS;
+}
+
+// OnExit, called when thread is being destroyed
+void ActisenseCanDump::OnExit() {
+}
+
+int ActisenseCanDump::Write(const unsigned int canId, const unsigned char payloadLength, const unsigned char *payload) {
+	// Not implemented for log reader
+	return TWOCAN_RESULT_SUCCESS;
+}
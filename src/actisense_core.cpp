@@ -0,0 +1,64 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseCore - Globals shared by the device, its interfaces and the plugin
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+
+#include "actisense_device.h"
+
+// Globally accessible variables used by the device, its interfaces, the plugin and the settings dialog.
+// Defined here, rather than in the plugin, so that tools linking the core library get them too.
+// The plugin loads them from its configuration, tools may set them before initializing the device
+wxString canAdapter;
+wxString adapterPortName;
+int supportedPGN = 0;
+bool deviceMode = FALSE;
+bool debugWindowActive = FALSE;
+bool enableHeartbeat = FALSE;
+bool enableGateway = FALSE;
+bool enableSignalK = FALSE;
+bool actisenseChecksum = TRUE;
+int logLevel = 0;
+int queuePolicy = QUEUE_POLICY_DROP_OLDEST;
+int queueSize = CONST_QUEUE_SIZE;
+// Whether the NGT-1 only receives the PGN's that are used, no UI, set manually in the config file
+bool adapterFilter = TRUE;
+// Frame latency tracing, no UI, set manually in the config file
+int traceSampling = 0;
+wxString traceFile;
+
+// global mutex used to control debug output (prevents interleaving of debug output)
+static wxMutex coreDebugMutex;
+wxMutex *debugMutex = &coreDebugMutex;
+
+unsigned long uniqueId = 0;
+int networkAddress = 0;
+ActisenseNetworkMap networkMap;
+ActisenseLastValues lastValues;
+ActisenseBus messageBus;
+ActisensePgnFilter pgnFilter;
+ActisenseBusLoad busLoad;
+ActisenseStatistics deviceStatistics;
+ActisenseTracer frameTracer;
@@ -0,0 +1,120 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseDecode - Decodes NMEA 2000 payloads into typed structures
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+// Version History: 
+// 1.0 Initial Release
+//
+
+#include "actisense_decode.h"
+
+bool ActisenseDecode::DecodeHeading(const std::vector<byte>& payload, Heading *heading) {
+	if (payload.size() < 8) {
+		return FALSE;
+	}
+	heading->sid = payload[0];
+	heading->heading = GetUnsignedShort(payload, 1);
+	heading->deviation = GetUnsignedShort(payload, 3);
+	heading->variation = GetUnsignedShort(payload, 5);
+	heading->reference = payload[7] & 0x03;
+	return TRUE;
+}
+
+bool ActisenseDecode::DecodePosition(const std::vector<byte>& payload, Position *position) {
+	if (payload.size() < 8) {
+		return FALSE;
+	}
+	position->latitude = GetUnsignedInt(payload, 0);
+	position->longitude = GetUnsignedInt(payload, 4);
+	return TRUE;
+}
+
+bool ActisenseDecode::DecodeCourseOverGround(const std::vector<byte>& payload, CourseOverGround *courseOverGround) {
+	if (payload.size() < 6) {
+		return FALSE;
+	}
+	courseOverGround->sid = payload[0];
+	courseOverGround->reference = payload[1] & 0x03;
+	courseOverGround->courseOverGround = GetUnsignedShort(payload, 2);
+	courseOverGround->speedOverGround = GetUnsignedShort(payload, 4);
+	return TRUE;
+}
+
+bool ActisenseDecode::DecodeGnssFix(const std::vector<byte>& payload, GnssFix *gnssFix) {
+	if (payload.size() < 43) {
+		return FALSE;
+	}
+	gnssFix->sid = payload[0];
+	gnssFix->daysSinceEpoch = GetUnsignedShort(payload, 1);
+	gnssFix->secondsSinceMidnight = GetUnsignedInt(payload, 3);
+	gnssFix->latitude = GetLongLong(payload, 7);
+	gnssFix->longitude = GetLongLong(payload, 15);
+	gnssFix->altitude = GetLongLong(payload, 23);
+	gnssFix->gnssType = payload[31] & 0x0F;
+	gnssFix->fixMethod = (payload[31] & 0xF0) >> 4;
+	gnssFix->fixIntegrity = payload[32] & 0x03;
+	gnssFix->numberOfSatellites = payload[33];
+	gnssFix->hDOP = GetUnsignedShort(payload, 34);
+	gnssFix->pDOP = GetUnsignedShort(payload, 36);
+	gnssFix->geoidalSeparation = GetUnsignedInt(payload, 38);
+	gnssFix->referenceStations = payload[42];
+	if ((gnssFix->referenceStations != 0xFF) && (gnssFix->referenceStations > 0) && (payload.size() >= 47)) {
+		gnssFix->referenceStationType = payload[43] & 0x0F;
+		gnssFix->referenceStationId = ((payload[43] & 0xF0) >> 4) | (payload[44] << 4);
+		gnssFix->referenceStationAge = GetUnsignedShort(payload, 45);
+	}
+	else {
+		gnssFix->referenceStationType = 0x0F;
+		gnssFix->referenceStationId = 0xFFFF;
+		gnssFix->referenceStationAge = 0xFFFF;
+	}
+	return TRUE;
+}
+
+bool ActisenseDecode::DecodeAisClassAReport(const std::vector<byte>& payload, AisClassAReport *report) {
+	if (payload.size() < 27) {
+		return FALSE;
+	}
+	report->messageId = payload[0] & 0x3F;
+	report->repeatIndicator = (payload[0] & 0xC0) >> 6;
+	report->userId = GetUnsignedInt(payload, 1);
+	report->longitude = GetUnsignedInt(payload, 5);
+	report->latitude = GetUnsignedInt(payload, 9);
+	report->positionAccuracy = payload[13] & 0x01;
+	report->raimFlag = (payload[13] & 0x02) >> 1;
+	report->timeStamp = (payload[13] & 0xFC) >> 2;
+	report->courseOverGround = GetUnsignedShort(payload, 14);
+	report->speedOverGround = GetUnsignedShort(payload, 16);
+	report->communicationState = (payload[18] | (payload[19] << 8) | (payload[20] << 16)) & 0x7FFFF;
+	report->transceiverInformation = (payload[20] & 0xF8) >> 3;
+	report->trueHeading = GetUnsignedShort(payload, 21);
+	report->rateOfTurn = GetUnsignedShort(payload, 23);
+	report->navigationalStatus = payload[25] & 0x0F;
+	report->manoeuverIndicator = (payload[25] & 0xC0) >> 6;
+	report->spare = payload[26] & 0x07;
+	report->sequenceId = (payload[26] & 0xC0) >> 6;
+	return TRUE;
+}
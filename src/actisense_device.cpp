@@ -29,30 +29,192 @@
 
 #include "actisense_device.h"
 
+// PGN's that produce NMEA 0183 sentences which may also come from another PGN or device, and their rank (lower rank is preferred).
+// Only producers of the same sentence type compete, so GGA from 129029 never suppresses GLL from 129025
+static const struct {
+	unsigned int pgn;
+	int sentenceType;
+	int rank;
+} sentenceProducers[] = {
+	{ 129033, SENTENCE_ZDA, 0 }, // Date & Time, usually from the GNSS
+	{ 126992, SENTENCE_ZDA, 1 }, // System Time, from any device with a clock
+	{ 129029, SENTENCE_GGA, 0 }, // GNSS Position, from more than one GNSS
+	{ 129025, SENTENCE_GLL, 0 }, // Position Rapid Update, likewise
+	{ 129026, SENTENCE_VTG, 0 }, // COG & SOG Rapid Update
+	{ 130577, SENTENCE_VTG, 1 } // Direction Data
+};
+
+// NMEA 0183 sentences that are reported as invalid if no PGN has produced them for CONST_DATA_STALE_PERIOD,
+// so that OpenCPN does not continue to display the last position, course or wind indefinitely.
+// Keyed by sentence type rather than PGN, so that VTG from 130577 keeps the sentence fresh when 129026 stops.
+// The PGN is the usual producer, reported to subscribers when the sentence goes stale
+static const struct {
+	int sentenceType;
+	unsigned int pgn;
+	const char *sentence;
+} staleDataSentences[] = {
+	{ SENTENCE_GLL, 129025, "$IIGLL,,,,,,V,N" }, // Position Rapid Update
+	{ SENTENCE_GGA, 129029, "$IIGGA,,,,,,0,,,,M,,M,," }, // GNSS Position, fix quality invalid
+	{ SENTENCE_VTG, 129026, "$IIVTG,,T,,M,,N,,K,N" }, // COG & SOG Rapid Update
+	{ SENTENCE_XTE, 129283, "$IIXTE,V,V,,,N,N" }, // Cross Track Error
+	{ SENTENCE_MWV, 130306, "$IIMWV,,R,,N,V" } // Wind
+};
+#define STALE_DATA_TIMERS (sizeof(staleDataSentences) / sizeof(staleDataSentences[0]))
+#define TIMER_TRANSPORT (TIMER_STALE_DATA + STALE_DATA_TIMERS)
+#define TIMER_ADAPTER_STATUS (TIMER_TRANSPORT + CONST_TP_SESSIONS)
+#define TIMER_STATISTICS (TIMER_ADAPTER_STATUS + 1)
+#define TIMERS (TIMER_STATISTICS + 1)
+
+// NMEA 0183 sentences that each PGN may produce, used to skip decoding PGN's whose sentences no subscriber wants
+static const struct {
+	unsigned int pgn;
+	SentenceMask sentences;
+} pgnSentences[] = {
+	{ 126992, SENTENCE_MASK(SENTENCE_ZDA) },
+	{ 127245, SENTENCE_MASK(SENTENCE_RSA) },
+	{ 127250, SENTENCE_MASK(SENTENCE_HDG) | SENTENCE_MASK(SENTENCE_HDM) | SENTENCE_MASK(SENTENCE_HDT) },
+	{ 127251, SENTENCE_MASK(SENTENCE_ROT) },
+	{ 127257, SENTENCE_MASK(SENTENCE_XDR) },
+	{ 127488, SENTENCE_MASK(SENTENCE_RPM) | SENTENCE_MASK(SENTENCE_XDR) },
+	{ 127489, SENTENCE_MASK(SENTENCE_XDR) },
+	{ 127505, SENTENCE_MASK(SENTENCE_XDR) },
+	{ 128259, SENTENCE_MASK(SENTENCE_VHW) },
+	{ 128267, SENTENCE_MASK(SENTENCE_DBT) | SENTENCE_MASK(SENTENCE_DPT) },
+	{ 128275, SENTENCE_MASK(SENTENCE_VLW) },
+	{ 129025, SENTENCE_MASK(SENTENCE_GLL) },
+	{ 129026, SENTENCE_MASK(SENTENCE_VTG) },
+	{ 129029, SENTENCE_MASK(SENTENCE_GGA) },
+	{ 129033, SENTENCE_MASK(SENTENCE_ZDA) },
+	{ 129038, SENTENCE_MASK(SENTENCE_VDM) },
+	{ 129039, SENTENCE_MASK(SENTENCE_VDM) },
+	{ 129040, SENTENCE_MASK(SENTENCE_VDM) },
+	{ 129041, SENTENCE_MASK(SENTENCE_VDM) },
+	{ 129283, SENTENCE_MASK(SENTENCE_XTE) },
+	{ 129284, SENTENCE_MASK(SENTENCE_BOD) | SENTENCE_MASK(SENTENCE_BWC) | SENTENCE_MASK(SENTENCE_BWR) | SENTENCE_MASK(SENTENCE_WCV) },
+	{ 129285, SENTENCE_MASK(SENTENCE_RTE) | SENTENCE_MASK(SENTENCE_WPL) },
+	{ 129793, SENTENCE_MASK(SENTENCE_VDM) },
+	{ 129794, SENTENCE_MASK(SENTENCE_VDM) },
+	{ 129798, SENTENCE_MASK(SENTENCE_VDM) },
+	{ 129809, SENTENCE_MASK(SENTENCE_VDM) },
+	{ 129810, SENTENCE_MASK(SENTENCE_VDM) },
+	{ 130306, SENTENCE_MASK(SENTENCE_MWV) },
+	{ 130310, SENTENCE_MASK(SENTENCE_MTW) },
+	{ 130311, SENTENCE_MASK(SENTENCE_MTW) },
+	{ 130312, SENTENCE_MASK(SENTENCE_MTW) },
+	{ 130316, SENTENCE_MASK(SENTENCE_MTW) },
+	{ 130577, SENTENCE_MASK(SENTENCE_VTG) }
+};
+
+// PGN's processed by ProcessMessage and the supportedPGN flag that enables each of them, 0 if they are always processed
+static const struct {
+	unsigned int pgn;
+	int flag;
+} pgnFlags[] = {
+	{ 59392, 0 }, { 59904, 0 }, { 60160, 0 }, { 60416, 0 }, { 60928, 0 }, { 65240, 0 }, 
+	{ 126464, 0 }, { 126993, 0 }, { 126996, 0 }, { 127258, 0 },
+	{ 126992, FLAGS_ZDA }, { 129033, FLAGS_ZDA },
+	{ 127245, FLAGS_RDR },
+	{ 127250, FLAGS_HDG },
+	{ 127251, FLAGS_ROT },
+	{ 127257, FLAGS_XDR },
+	{ 127488, FLAGS_ENG }, { 127489, FLAGS_ENG },
+	{ 127505, FLAGS_TNK },
+	{ 128259, FLAGS_VHW },
+	{ 128267, FLAGS_DPT },
+	{ 129025, FLAGS_GLL },
+	{ 129026, FLAGS_VTG }, { 130577, FLAGS_VTG },
+	{ 129029, FLAGS_GGA },
+	{ 129038, FLAGS_AIS }, { 129039, FLAGS_AIS }, { 129040, FLAGS_AIS }, { 129041, FLAGS_AIS }, { 129793, FLAGS_AIS }, 
+	{ 129794, FLAGS_AIS }, { 129798, FLAGS_AIS }, { 129809, FLAGS_AIS }, { 129810, FLAGS_AIS },
+	{ 129283, FLAGS_XTE },
+	{ 129284, FLAGS_NAV },
+	{ 129285, FLAGS_RTE },
+	{ 129808, FLAGS_DSC },
+	{ 130306, FLAGS_MWV },
+	{ 130310, FLAGS_MWT }, { 130311, FLAGS_MWT }, { 130312, FLAGS_MWT }, { 130316, FLAGS_MWT }
+};
+
+// PGN's transmitted as Fast Packets, in ascending order. 
+// Excludes the manufacturer proprietary ranges, which are tested separately
+static constexpr unsigned int fastPacketPGNs[] = {
+	126208, 126464, 126983, 126984, 126985, 126986, 126987, 126988, 126996, 126998,
+	127233, 127237, 127489, 127496, 127497, 127498, 127503, 127504, 127506, 127507,
+	127509, 127510, 127511, 127512, 127513, 127514, 128275, 128520, 129029, 129038,
+	129039, 129040, 129041, 129044, 129045, 129284, 129285, 129301, 129302, 129538,
+	129540, 129541, 129542, 129545, 129547, 129549, 129551, 129556, 129792, 129793,
+	129794, 129795, 129796, 129797, 129798, 129799, 129800, 129801, 129802, 129803,
+	129804, 129805, 129806, 129807, 129808, 129809, 129810, 130052, 130053, 130054,
+	130060, 130061, 130064, 130065, 130066, 130067, 130068, 130069, 130070, 130071,
+	130072, 130073, 130074, 130320, 130321, 130322, 130323, 130324, 130330, 130560,
+	130567, 130577, 130578
+};
+
+// Checked at compile time, as IsFastMessage performs a binary search
+constexpr bool IsAscending(const unsigned int *values, const size_t count) {
+	return (count < 2) || ((values[0] < values[1]) && IsAscending(values + 1, count - 1));
+}
+static_assert(IsAscending(fastPacketPGNs, sizeof(fastPacketPGNs) / sizeof(fastPacketPGNs[0])), "fastPacketPGNs must be in ascending order");
+
 ActisenseDevice::ActisenseDevice(wxEvtHandler *handler) : wxThread(wxTHREAD_JOINABLE) {
 	// Save a reference to our "parent", the plugin event handler so we can pass events to it
 	eventHandlerAddress = handler;
 	
 	// initialise Message Queue to receive frames from either an Actisense EBL log file or Actisense NGT-1 device
-	canQueue = new wxMessageQueue<std::vector<byte>>();
+	// Bounded so that memory and latency are predictable if OpenCPN stalls or a log file is replayed too quickly
+	canQueue = new ActisenseQueue(queueSize, queuePolicy);
 	
 	// Initialize the statistics
-	// BUG BUG Get around to actually doing something with these !!
-	receivedFrames = 0;
-	transmittedFrames = 0;
-	droppedFrames = 0;
-	fastFrames = 0;
-	errorFrames = 0;
-	standardFrames = 0;
-	averageProcessingTime = 0;
-	minimumProcessingTime = 0;
-	maximumProcessingTime = 0;
+	deviceStatistics.Reset();
+	currentPgn = CONST_OTHER_PGNS;
+	frameTracer.Reset(traceSampling);
+	currentTrace = 0;
+
+	// Created by Init
+	deviceInterface = NULL;
+	currentLane = QUEUE_LANE_NORMAL;
+	currentPostedTime = 0;
+	for (int i = 0; i < QUEUE_LANES; i++) {
+		deliveryStatistics[i] = {};
+	}
+	currentTimestamp = 0;
+	adapterStatistics = {};
+	adapterTimeValid = FALSE;
+	lastAdapterTime = 0;
+	adapterEpoch = 0;
+	adapterOffset = 0;
+	windowOffset = 0;
+	windowStart = 0;
 	
 	// Each AIS multi sentence message has a sequential Message ID
 	AISsequentialMessageId = 0;
 
 	// Until engineInstance > 0 then assume a single engined vessel
 	IsMultiEngineVessel = FALSE;
+
+	// No producers of equivalent NMEA 0183 sentences seen yet
+	for (int i = 0; i < SENTENCE_TYPES; i++) {
+		arbitrationTable[i] = {};
+	}
+
+	// Nothing decoded yet
+	decodedMessage = {};
+
+	// Nor any bus load
+	busLoad.Reset();
+	droppedFrameTime = 0;
+	droppedFrameCount = 0;
+
+	// Nothing to publish yet
+	wantedSentences = 0;
+	publishedTypes = 0;
+
+	// Heartbeat and data staleness deadlines
+	timerWheel = new ActisenseTimerWheel(TIMERS, TwoCanUtils::GetMonotonicMillis());
+
+	// Fast Packet and ISO Transport Protocol reassembly, for raw CAN frames
+	MapInitialize();
+	lastGarbageCollection = 0;
+	transport = new ActisenseTransport(timerWheel, TIMER_TRANSPORT);
 		
 	// BUG BUG - Need to finalize use case and reflect in the preferences dialog
 	// BUG BUG - Logging not currently exposed in the Preferences dialog
@@ -75,7 +237,10 @@ ActisenseDevice::ActisenseDevice(wxEvtHandler *handler) : wxThread(wxTHREAD_JOIN
 }
 
 ActisenseDevice::~ActisenseDevice(void) {
-	// Anything to do in the destructor ??
+	// The interface that posted to the queue has already been deleted in OnExit
+	delete canQueue;
+	delete transport;
+	delete timerWheel;
 }
 
 // Init, Load the Actisense NGT-1 adapter driver or the Actisense EBL Log File Reader
@@ -84,6 +249,9 @@ int ActisenseDevice::Init(wxString driverPath) {
 
 	driverName = driverPath;
 
+	// Before the interface starts reading
+	BuildPgnFilter();
+
 	if (driverName.CmpNoCase(CONST_LOG_READER) == 0) {
 		// Load the Actisense EBL log file reader
 		deviceInterface = new ActisenseEBL(canQueue);
@@ -97,6 +265,18 @@ int ActisenseDevice::Init(wxString driverPath) {
 		returnCode = deviceInterface->Open(adapterPortName);
 	}
 
+	else if (driverName.CmpNoCase(CONST_CANDUMP_READER) == 0) {
+		// Load the candump log file reader
+		deviceInterface = new ActisenseCanDump(canQueue);
+		returnCode = deviceInterface->Open(CONST_CANDUMP_NAME);
+	}
+
+	else if (driverName.CmpNoCase(CONST_MEMORY_READER) == 0) {
+		// In memory interface, fed by the caller
+		deviceInterface = new ActisenseMemory(canQueue);
+		returnCode = deviceInterface->Open(_T(""));
+	}
+
 	else {
 		// BUG BUG Should not reach this condition
 		returnCode = SET_ERROR(TWOCAN_RESULT_FATAL, TWOCAN_SOURCE_DEVICE, TWOCAN_ERROR_DRIVER_NOT_FOUND);
@@ -115,6 +295,7 @@ int ActisenseDevice::DeInit() {
 // Entry, the method that is executed upon thread start
 // Merely loops continuously waiting for frames to be received by the NGT-1 Adapter or EBL Log Reader
 wxThread::ExitCode ActisenseDevice::Entry() {
+	ACTISENSE_PROFILE_THREAD("Device");
 	return (wxThread::ExitCode)ReadActisenseDriver();
 }
 
@@ -145,11 +326,75 @@ void ActisenseDevice::OnExit() {
 		wxMessageOutputDebug().Printf(_T("Actisense Device, Error closing interface (%lu)\n"),returnCode);
 	}
 	
+	// The serial link, between the adapter and the plugin
+	SerialStatistics serial;
+	if (deviceInterface->GetSerialStatistics(&serial)) {
+		wxLogMessage(_T("Actisense Device, Serial link, Bytes: %llu, Peak: %u bytes/sec (%d%%), Overruns: %llu, Buffer Overruns: %llu, Framing: %llu, Parity: %llu"),
+			serial.rxBytes, serial.peakBytesPerSecond, serial.peakUtilisation, serial.overruns, serial.bufferOverruns, serial.framingErrors, serial.parityErrors);
+		wxLogMessage(_T("Actisense Device, Serial link, Resyncs: %llu, Escape errors: %llu, Discarded bytes: %llu"),
+			serial.resyncs, serial.escapeErrors, serial.discardedBytes);
+	}
+
 	// only delete the interface if it is a joinable thread.
 	delete deviceInterface;
 
 	eventHandlerAddress = NULL;
 
+	// Report the per lane latencies
+	const char *laneNames[QUEUE_LANES] = { "Safety", "Network", "Normal" };
+	for (int i = 0; i < QUEUE_LANES; i++) {
+		LaneStatistics queued = canQueue->GetLaneStatistics(i);
+		if (queued.frames > 0) {
+			wxLogMessage(_T("Actisense Device, %s lane, Frames: %llu, Queued (usec) Average: %llu, Maximum: %llu"),
+				laneNames[i], queued.frames, queued.totalLatency / queued.frames, queued.maximumLatency);
+		}
+		if (deliveryStatistics[i].frames > 0) {
+			wxLogMessage(_T("Actisense Device, %s lane, Sentences: %llu, Delivered (usec) Average: %llu, Maximum: %llu"),
+				laneNames[i], deliveryStatistics[i].frames, deliveryStatistics[i].totalLatency / deliveryStatistics[i].frames, deliveryStatistics[i].maximumLatency);
+		}
+	}
+	if (adapterStatistics.frames > 0) {
+		wxLogMessage(_T("Actisense Device, Adapter to sentence (msec) Average: %llu, Maximum: %llu"),
+			adapterStatistics.totalLatency / adapterStatistics.frames, adapterStatistics.maximumLatency);
+	}
+	wxLogMessage(_T("Actisense Device, Frames dropped by the PGN filter: %llu"), pgnFilter.GetFilteredFrames());
+	// Where frames were lost, on the adapter or in the plugin
+	NgtStatistics adapter = ngtStatus.GetStatistics();
+	if (adapter.statusReports > 0) {
+		wxLogMessage(_T("Actisense Device, NGT-1 Dropped: %llu, Deleted: %llu, Filtered: %llu, Maximum Rx Load: %d%%, Maximum Buffer Loading: %d%%"),
+			adapter.rxDropped, adapter.deleted, adapter.rxFiltered, adapter.maximumRxLoad, adapter.maximumBufferLoading);
+	}
+	if (adapter.invalidResponses > 0) {
+		wxLogMessage(_T("Actisense Device, NGT-1 Invalid responses: %llu"), adapter.invalidResponses);
+	}
+	wxLogMessage(_T("Actisense Device, Frames dropped by the queue: %llu"), canQueue->GetDroppedFrames());
+
+	// Frame counts and processing times
+	wxLogMessage(_T("Actisense Device, Frames received: %llu, Transmitted: %llu, Standard: %llu, Fast Packet: %llu, Errors: %llu"),
+		deviceStatistics.GetReceivedFrames(), deviceStatistics.GetTransmittedFrames(), deviceStatistics.GetStandardFrames(), 
+		deviceStatistics.GetFastFrames(), deviceStatistics.GetErrorFrames());
+	const ActisenseHistogram& decodeTime = deviceStatistics.GetDecodeTime();
+	const ActisenseHistogram& queueTime = deviceStatistics.GetQueueTime();
+	wxLogMessage(_T("Actisense Device, Decode (usec) Minimum: %llu, Average: %llu, 99%%: %llu, Maximum: %llu"),
+		decodeTime.GetMinimum(), decodeTime.GetMean(), decodeTime.GetPercentile(99), decodeTime.GetMaximum());
+	wxLogMessage(_T("Actisense Device, Queued (usec) Minimum: %llu, Average: %llu, 99%%: %llu, Maximum: %llu"),
+		queueTime.GetMinimum(), queueTime.GetMean(), queueTime.GetPercentile(99), queueTime.GetMaximum());
+
+	// Those sources and PGN's losing the most messages
+	std::vector<LossEntry> losses;
+	lossTracker.GetLosses(losses, 10);
+	wxLogMessage(_T("Actisense Device, Messages received: %llu, Lost: %llu, Untracked (source, PGN) pairs: %llu"),
+		lossTracker.GetReceivedMessages(), lossTracker.GetLostMessages(), lossTracker.GetOverflows());
+	for (auto it = losses.begin(); it != losses.end(); ++it) {
+		wxLogMessage(_T("Actisense Device, Source: %d, PGN: %u, Received: %llu, Lost: %llu (%.1f%%), SID gaps: %llu, Late: %llu, Fast Packet gaps: %llu, Incomplete: %llu"),
+			it->source, it->pgn, it->received, it->lost, 100.0 * ActisenseLossTracker::LossRatio(*it), it->sidGaps, it->late, it->sequenceGaps, it->incomplete);
+	}
+	TransportStatistics transportStatistics = transport->GetStatistics();
+	if ((transportStatistics.completed + transportStatistics.discarded) > 0) {
+		wxLogMessage(_T("Actisense Device, ISO Transport Protocol, Completed: %llu, Aborted: %llu, Timed out: %llu, Discarded: %llu"),
+			transportStatistics.completed, transportStatistics.aborted, transportStatistics.timedOut, transportStatistics.discarded);
+	}
+
 	// If logging, close log file
 	if (logLevel > FLAGS_LOG_NONE) {
 		if (rawLogFile.IsOpened()) {
@@ -183,15 +428,21 @@ int ActisenseDevice::ReadActisenseDriver(void) {
 	deviceInterface->Run();
 	wxLogMessage(_T("Actisense Device, Started interface thread"));
 	wxMessageOutputDebug().Printf(_T("Actisense Device, Started interface thread\n"));
+
+	// Periodically query the NGT-1's status. The responses are queued and parsed like any other message
+	if (driverName.CmpNoCase(CONST_NGT_READER) == 0) {
+		timerWheel->Arm(TIMER_ADAPTER_STATUS, TwoCanUtils::GetMonotonicMillis() + CONST_NGT_STATUS_INTERVAL);
+	}
+	timerWheel->Arm(TIMER_STATISTICS, TwoCanUtils::GetMonotonicMillis() + CONST_STATISTICS_INTERVAL);
 	
 	while (!TestDestroy()) {
 		
-		// Wait for a CAN Frame
-		queueError = canQueue->ReceiveTimeout(100,receivedFrame);
+		// Wait for a CAN Frame, safety PGN's are received ahead of anything else queued
+		queueError = canQueue->ReceiveTimeout(100, receivedFrame, &currentLane, &currentPostedTime);
 		
 		switch (queueError) {
 			case wxMSGQUEUE_NO_ERROR:
-				ParseMessage(receivedFrame);
+				ProcessQueuedMessage(receivedFrame);
 				break;
 			case wxMSGQUEUE_TIMEOUT:
 				break;
@@ -200,6 +451,9 @@ int ActisenseDevice::ReadActisenseDriver(void) {
 				break;
 		}
 
+		// At least every 100 msec, given the receive timeout
+		SuperviseTimers();
+
 	} // end while
 
 	wxLogMessage(_T("Actisense Device, Read thread exiting"));
@@ -208,12 +462,73 @@ int ActisenseDevice::ReadActisenseDriver(void) {
 	return TWOCAN_RESULT_SUCCESS;	
 }
 
+// Time spent waiting in the queue and then decoding, ParseMessage sets the PGN once it is known
+void ActisenseDevice::ProcessQueuedMessage(const std::vector<byte>& receivedFrame) {
+	deviceStatistics.CountReceived();
+	currentPgn = CONST_OTHER_PGNS;
+	unsigned long long decodeStart = TwoCanUtils::GetMonotonicMicros();
+	currentTrace = frameTracer.Begin(currentPostedTime, decodeStart);
+	ParseMessage(receivedFrame);
+	deviceStatistics.RecordFrame(currentPgn, TwoCanUtils::GetMonotonicMicros() - decodeStart, 
+		((currentPostedTime > 0) && (decodeStart > currentPostedTime)) ? decodeStart - currentPostedTime : 0);
+	frameTracer.End(currentTrace, currentPgn);
+	// Messages published by the timers are not traced
+	currentTrace = 0;
+}
+
+// The same as an iteration of the read loop, but without waiting, so that a tool feeding the in memory interface
+// receives the sentences for the messages it has fed before this returns. Never called whilst the device thread is running
+int ActisenseDevice::ProcessPendingMessages(void) {
+	std::vector<byte> receivedFrame;
+	int messages = 0;
+	while (canQueue->ReceiveTimeout(0, receivedFrame, &currentLane, &currentPostedTime) == wxMSGQUEUE_NO_ERROR) {
+		ProcessQueuedMessage(receivedFrame);
+		messages++;
+	}
+	SuperviseTimers();
+	return messages;
+}
+
 
-// Queue the SENTENCE_RECEIVED_EVENT to the plugin where it will push the NMEA 0183 sentence into OpenCPN
-void ActisenseDevice::RaiseEvent(wxString sentence) {
-	wxCommandEvent *event = new wxCommandEvent(wxEVT_SENTENCE_RECEIVED_EVENT, SENTENCE_RECEIVED_EVENT);
-	event->SetString(sentence);
-	wxQueueEvent(eventHandlerAddress, event);
+// Subscribers, such as the plugin which pushes the NMEA 0183 sentences into OpenCPN, receive the message in a single batch
+void ActisenseDevice::PublishMessage(const CanHeader header, const std::vector<byte>& payload) {
+	frameTracer.Stamp(currentTrace, TRACE_STAGE_DECODED);
+	messageBus.Publish(header, payload, decodedMessage, publishedSentences, publishedTypes, currentTrace);
+	frameTracer.Stamp(currentTrace, TRACE_STAGE_PUBLISHED);
+	publishedSentences.clear();
+	publishedTypes = 0;
+	decodedMessage.pgn = 0;
+}
+
+// Enable the network management PGN's, those enabled by supportedPGN and those that bus subscribers want
+void ActisenseDevice::BuildPgnFilter(void) {
+	pgnFilter.DisableAll();
+	for (size_t i = 0; i < sizeof(pgnFlags) / sizeof(pgnFlags[0]); i++) {
+		if ((pgnFlags[i].flag == 0) || (supportedPGN & pgnFlags[i].flag)) {
+			pgnFilter.Enable(pgnFlags[i].pgn);
+		}
+	}
+	messageBus.EnableSubscribedPgns();
+}
+
+// Linear search, but the table is short. PGN's not in the table are always processed
+bool ActisenseDevice::IsFormatWanted(const unsigned int pgn) {
+	for (size_t i = 0; i < sizeof(pgnSentences) / sizeof(pgnSentences[0]); i++) {
+		if (pgnSentences[i].pgn == pgn) {
+			return ((pgnSentences[i].sentences & wantedSentences) != 0);
+		}
+	}
+	return TRUE;
+}
+
+// Record which member of the decoded message is valid, so that it is published with the payload
+bool ActisenseDevice::DecodeTyped(const CanHeader header, const bool isDecoded) {
+	decodedMessage.pgn = isDecoded ? header.pgn : 0;
+	return isDecoded;
+}
+
+bool ActisenseDevice::IsSentenceWanted(const int sentenceType) {
+	return ((SENTENCE_MASK(sentenceType) & wantedSentences) != 0);
 }
 
 // Big switch statement to parse received NMEA 2000 messages
@@ -234,12 +549,12 @@ void ActisenseDevice::RaiseEvent(wxString sentence) {
 // No overall length value and no checksum. Seems as though when using Linux these are not used ?
 
 void ActisenseDevice::ParseMessage(std::vector<byte> receivedFrame) {
+	ACTISENSE_PROFILE_FUNCTION();
 	CanHeader header;
 	std::vector<byte> payload;
-	std::vector<wxString> nmeaSentences;
-	bool result = FALSE;
 	bool hasChecksum = TRUE;
 	bool isValidFrame = FALSE;
+	unsigned int adapterTime = 0;
 	
 	// From Hubert's dumps some message have and some do not have checksums, aarrgghhh!
 	
@@ -248,11 +563,7 @@ void ActisenseDevice::ParseMessage(std::vector<byte> receivedFrame) {
 		if (receivedFrame.at(1) == receivedFrame.size() - 3) {
 			// the checksum character at the end of the message
 			// ensures that the sum of all characters modulo 256 equals 0
-			int checksum = 0;
-			for (auto it : receivedFrame) {
-				checksum += it;
-			}
-			if ((checksum % 256) == 0) {
+			if (TwoCanUtils::ActisenseChecksum(receivedFrame.data(), receivedFrame.size()) == 0) {
 				hasChecksum = TRUE;
 				isValidFrame = TRUE;
 			}
@@ -269,30 +580,44 @@ void ActisenseDevice::ParseMessage(std::vector<byte> receivedFrame) {
 			isValidFrame = TRUE;
 		}
 						
-		// debug hex dump of received message
-		int j = 0;
-		wxString debugString;
-		debugMutex->Lock();
-		wxMessageOutputDebug().Printf(_T("Received Frame\n"));
-		for (size_t i = 0; i < receivedFrame.size(); i++) {
-			debugString.Append(wxString::Format("%02X ",receivedFrame.at(i)));
-			j++;
-			if ((j % 8) == 0) {
+		// debug hex dump of received message, only whilst the debug tab is running or frames are being logged,
+		// as formatting it for every frame costs more than decoding most PGN's
+		bool isDumped = ((debugWindowActive) || (logLevel != FLAGS_LOG_NONE));
+		if (isDumped) {
+			int j = 0;
+			wxString debugString;
+			debugMutex->Lock();
+			wxMessageOutputDebug().Printf(_T("Received Frame\n"));
+			for (size_t i = 0; i < receivedFrame.size(); i++) {
+				debugString.Append(wxString::Format("%02X ",receivedFrame.at(i)));
+				j++;
+				if ((j % 8) == 0) {
+					wxMessageOutputDebug().Printf(_T("%s\n"),debugString.c_str());
+					j = 0;
+					debugString.Clear();
+				}
+			}
+			
+			if (!debugString.IsEmpty()) {	
 				wxMessageOutputDebug().Printf(_T("%s\n"),debugString.c_str());
-				j = 0;
 				debugString.Clear();
 			}
+			wxMessageOutputDebug().Printf(_T("\n"));
+			// unlock once we have prnted out the header debugMutex->Unlock();
 		}
-		
-		if (!debugString.IsEmpty()) {	
-			wxMessageOutputDebug().Printf(_T("%s\n"),debugString.c_str());
-			debugString.Clear();
-		}
-		wxMessageOutputDebug().Printf(_T("\n"));
-		// unlock once we have prnted out the header debugMutex->Unlock();
 		// end of debugging
+
+		// Failed the checksum. Neither the header nor the adapter's timestamp can be trusted,
+		// so the frame must not disturb the mapping of the adapter's clock
+		if (isValidFrame == FALSE) {
+			if (isDumped) {
+				debugMutex->Unlock();
+			}
+			deviceStatistics.CountErrors(1);
+			return;
+		}
 	
-		if ((hasChecksum == TRUE) && (isValidFrame == TRUE)) {
+		if (hasChecksum == TRUE) {
 		
 		// Construct the CAN Header
 		header.pgn = receivedFrame.at(3) + (receivedFrame.at(4)<< 8) + (receivedFrame.at(5) << 16);
@@ -301,8 +626,8 @@ void ActisenseDevice::ParseMessage(std::vector<byte> receivedFrame) {
 		header.priority = receivedFrame.at(2);
 		
 			
-		// Timestamp is encoded over bytes 8,9,10,11
-		// BUG BUG if we are logging, use this as the time stamp ??
+		// Timestamp is encoded over bytes 8,9,10,11, little endian milliseconds
+		adapterTime = receivedFrame.at(8) | (receivedFrame.at(9) << 8) | (receivedFrame.at(10) << 16) | (receivedFrame.at(11) << 24);
 	
 		// Data Length is stored in byte 12
 		// Copy the CAN data
@@ -310,7 +635,7 @@ void ActisenseDevice::ParseMessage(std::vector<byte> receivedFrame) {
 				payload.push_back(receivedFrame[13 + i]);
 			}
 		}
-		else if ((hasChecksum == FALSE) && (isValidFrame == TRUE)) {
+		else {
 			// No checksum and no overall length. Alter indexes as appropriate.
 			// Construct the CAN Header
 			header.pgn = receivedFrame.at(2) + (receivedFrame.at(3) << 8) + (receivedFrame.at(4) << 16);
@@ -319,7 +644,7 @@ void ActisenseDevice::ParseMessage(std::vector<byte> receivedFrame) {
 			header.priority = receivedFrame.at(1);
 	
 			// Timestamp is encoded over bytes 7,8,9,10
-			// BUG BUG if we are logging, use this as the time stamp ??
+			adapterTime = receivedFrame.at(7) | (receivedFrame.at(8) << 8) | (receivedFrame.at(9) << 16) | (receivedFrame.at(10) << 24);
 	
 			// Data Length is stored in byte 11
 			// Copy the CAN data
@@ -328,426 +653,828 @@ void ActisenseDevice::ParseMessage(std::vector<byte> receivedFrame) {
 			}
 		}
 	
-		// If we receive a frame from a device, then by definition it is still alive!
-		networkMap[header.source].timestamp = wxDateTime::Now();
+		// Use the adapter's timestamp, rather than when we got around to parsing the frame. 
+		// The time the interface posted the frame is the closest host time to its arrival
+		header.timestamp = ConvertAdapterTimestamp(adapterTime, (currentPostedTime > 0) ? currentPostedTime / 1000 : TwoCanUtils::GetMonotonicMillis());
+		currentTimestamp = header.timestamp;
+
+		if (isDumped) {
+			// debugMutex->Lock();
+			wxMessageOutputDebug().Printf(_T("Source: %lu\n"),header.source);
+			wxMessageOutputDebug().Printf(_T("PGN: %lu\n"),header.pgn);
+			wxMessageOutputDebug().Printf(_T("Destination: %lu\n"),header.destination);
+			wxMessageOutputDebug().Printf(_T("Priority: %lu\n\n"),header.priority);
+			debugMutex->Unlock();	
+		}
+		
+		ProcessMessage(header, payload);
+	}
+	else if (receivedFrame.at(0) == NGT_RX_CMD) {
+		ngtStatus.ProcessResponse(receivedFrame);
+	}
+	else if (receivedFrame.at(0) == CAN_RX_CMD) {
+		ParseRawFrame(receivedFrame);
+	}
+}
+
+// receivedFrame[0] - CAN_RX_CMD
+// receivedFrame[1..4] - CAN Id, little endian
+// receivedFrame[5..8] - Timestamp (msec), zero if the source has none
+// receivedFrame[9] - Data length
+// receivedFrame[10..] - Data
+void ActisenseDevice::ParseRawFrame(const std::vector<byte>& receivedFrame) {
+	CanHeader header;
+
+	if ((receivedFrame.size() < 11) || (receivedFrame[9] > CONST_PAYLOAD_LENGTH) || (receivedFrame.size() < (size_t)(10 + receivedFrame[9]))) {
+		deviceStatistics.CountErrors(1);
+		return;
+	}
+
+	TwoCanUtils::DecodeCanHeader(&receivedFrame[1], &header);
+	currentPgn = header.pgn;
+
+	unsigned int logTime = receivedFrame[5] | (receivedFrame[6] << 8) | (receivedFrame[7] << 16) | (receivedFrame[8] << 24);
+	unsigned long long hostTime = (currentPostedTime > 0) ? currentPostedTime / 1000 : TwoCanUtils::GetMonotonicMillis();
+	header.timestamp = (logTime > 0) ? ConvertAdapterTimestamp(logTime, hostTime) : hostTime;
+	currentTimestamp = header.timestamp;
+
+	if ((header.pgn == CONST_TP_CM_PGN) || (header.pgn == CONST_TP_DT_PGN)) {
+		deviceStatistics.CountStandard();
+		if (transport->ProcessFrame(header, &receivedFrame[10], receivedFrame[9])) {
+			ProcessMessage(transport->GetHeader(), transport->GetPayload());
+		}
+	}
+	else if (IsFastMessage(header)) {
+		// Fast Packet frames are always 8 bytes, pad any that are short
+		byte frame[CONST_PAYLOAD_LENGTH];
+		memset(frame, 0xFF, CONST_PAYLOAD_LENGTH);
+		memcpy(frame, &receivedFrame[10], receivedFrame[9]);
+		deviceStatistics.CountFast();
+		AssembleFastMessage(header, frame);
+	}
+	else {
+		deviceStatistics.CountStandard();
+		ProcessMessage(header, std::vector<byte>(receivedFrame.begin() + 10, receivedFrame.begin() + 10 + receivedFrame[9]));
+	}
+}
+
+bool ActisenseDevice::IsFastMessage(const CanHeader header) {
+	// Manufacturer proprietary Fast Packet PGN's
+	if ((header.pgn == 126720) || ((header.pgn >= 130816) && (header.pgn <= 131071))) {
+		return TRUE;
+	}
+	return std::binary_search(std::begin(fastPacketPGNs), std::end(fastPacketPGNs), header.pgn);
+}
+
+// The first frame's byte 0 holds the sequence identifier (bits 5 - 7) and a frame counter of zero (bits 0 - 4),
+// byte 1 the total length and bytes 2 - 7 the first six bytes of data. 
+// Subsequent frames hold the sequence identifier and frame counter in byte 0, followed by seven bytes of data
+void ActisenseDevice::AssembleFastMessage(const CanHeader header, const byte *message) {
+	unsigned int sid = (message[0] & 0xE0) >> 5;
+	byte frameCounter = message[0] & 0x1F;
+	int position = MapFindMatchingEntry(header, sid);
+
+	if (frameCounter == 0) {
+		lossTracker.RecordSequence(header, sid);
+		if (position != NOT_FOUND) {
+			// The previous message with this sequence identifier was never completed
+			deviceStatistics.CountErrors(1);
+			lossTracker.RecordIncomplete(header);
+		}
+		else {
+			position = MapFindFreeEntry(header, sid);
+			if (position == NOT_FOUND) {
+				// Buffer is full
+				deviceStatistics.CountErrors(1);
+				return;
+			}
+		}
+		MapInsertEntry(header, message, position);
+	}
+	else {
+		if (position == NOT_FOUND) {
+			// Missed the first frame
+			deviceStatistics.CountErrors(1);
+			return;
+		}
+		if (MapAppendEntry(header, message, position) == NOT_FOUND) {
+			// Missed a frame
+			deviceStatistics.CountErrors(1);
+			lossTracker.RecordIncomplete(header);
+			return;
+		}
+	}
+
+	if (fastMessages[position].cursor >= fastMessages[position].expectedLength) {
+		std::vector<byte> payload(fastMessages[position].data, fastMessages[position].data + fastMessages[position].expectedLength);
+		MapRemoveEntry(position);
+		ProcessMessage(header, payload);
+	}
+}
+
+void ActisenseDevice::MapInitialize(void) {
+	for (int i = 0; i < CONST_MAX_MESSAGES; i++) {
+		fastMessages[i].IsFree = TRUE;
+	}
+	fastMessageCount = 0;
+}
+
+// Home position of a (source, PGN, sequence identifier) in the Fast Packet buffer
+int ActisenseDevice::MapHash(const CanHeader header, const unsigned int sid) {
+	unsigned int key = (header.pgn << 11) ^ (header.source << 3) ^ sid;
+	return ((key * 2654435769U) >> 16) & (CONST_MAX_MESSAGES - 1);
+}
+
+// Linear probing, a free entry terminates the search
+int ActisenseDevice::MapFindMatchingEntry(const CanHeader header, const unsigned int sid) {
+	int position = MapHash(header, sid);
+	for (int i = 0; i < CONST_MAX_MESSAGES; i++) {
+		if (fastMessages[position].IsFree) {
+			return NOT_FOUND;
+		}
+		if ((fastMessages[position].header.pgn == header.pgn) && (fastMessages[position].header.source == header.source) && (fastMessages[position].sid == sid)) {
+			return position;
+		}
+		position = (position + 1) & (CONST_MAX_MESSAGES - 1);
+	}
+	return NOT_FOUND;
+}
+
+int ActisenseDevice::MapFindFreeEntry(const CanHeader header, const unsigned int sid) {
+	int position = MapHash(header, sid);
+	for (int i = 0; i < CONST_MAX_MESSAGES; i++) {
+		if (fastMessages[position].IsFree) {
+			return position;
+		}
+		position = (position + 1) & (CONST_MAX_MESSAGES - 1);
+	}
+	return NOT_FOUND;
+}
+
+void ActisenseDevice::MapInsertEntry(const CanHeader header, const byte *data, const int position) {
+	if (fastMessages[position].IsFree) {
+		fastMessageCount++;
+	}
+	fastMessages[position].IsFree = FALSE;
+	fastMessages[position].header = header;
+	fastMessages[position].sid = (data[0] & 0xE0) >> 5;
+	fastMessages[position].expectedLength = (data[1] > CONST_MAX_FAST_PACKET_LENGTH) ? CONST_MAX_FAST_PACKET_LENGTH : data[1];
+	fastMessages[position].cursor = (fastMessages[position].expectedLength < 6) ? fastMessages[position].expectedLength : 6;
+	memcpy(fastMessages[position].data, &data[2], fastMessages[position].cursor);
+	fastMessages[position].frameCounter = 1;
+	fastMessages[position].timeArrived = TwoCanUtils::GetMonotonicMillis();
+}
+
+// Returns NOT_FOUND, and discards the entry, if the frame is out of sequence
+int ActisenseDevice::MapAppendEntry(const CanHeader header, const byte *data, const int position) {
+	if ((data[0] & 0x1F) != fastMessages[position].frameCounter) {
+		MapRemoveEntry(position);
+		return NOT_FOUND;
+	}
+	unsigned int remaining = fastMessages[position].expectedLength - fastMessages[position].cursor;
+	unsigned int length = (remaining < 7) ? remaining : 7;
+	memcpy(&fastMessages[position].data[fastMessages[position].cursor], &data[1], length);
+	fastMessages[position].cursor += length;
+	fastMessages[position].frameCounter++;
+	fastMessages[position].timeArrived = TwoCanUtils::GetMonotonicMillis();
+	return position;
+}
+
+// Backward shift deletion, so that no tombstones are required to keep probe sequences intact
+void ActisenseDevice::MapRemoveEntry(const int position) {
+	int hole = position;
+	int next = position;
+	fastMessages[hole].IsFree = TRUE;
+	fastMessageCount--;
+	while (TRUE) {
+		next = (next + 1) & (CONST_MAX_MESSAGES - 1);
+		if (fastMessages[next].IsFree) {
+			return;
+		}
+		int home = MapHash(fastMessages[next].header, fastMessages[next].sid);
+		// Leave the entry if its home position lies cyclically within (hole, next]
+		bool inPlace = (hole <= next) ? ((hole < home) && (home <= next)) : ((hole < home) || (home <= next));
+		if (!inPlace) {
+			fastMessages[hole] = fastMessages[next];
+			fastMessages[next].IsFree = TRUE;
+			hole = next;
+		}
+	}
+}
+
+// Remove entries whose next frame has not arrived within CONST_TIME_EXCEEDED. Returns the number removed
+int ActisenseDevice::MapGarbageCollector(void) {
+	unsigned long long now = TwoCanUtils::GetMonotonicMillis();
+	int removed = 0;
+	int i = 0;
+	while (i < CONST_MAX_MESSAGES) {
+		if ((!fastMessages[i].IsFree) && ((now - fastMessages[i].timeArrived) > CONST_TIME_EXCEEDED)) {
+			// Another entry may be shifted into this position, so check it again
+			lossTracker.RecordIncomplete(fastMessages[i].header);
+			MapRemoveEntry(i);
+			removed++;
+		}
+		else {
+			i++;
+		}
+	}
+	deviceStatistics.CountErrors(removed);
+	return removed;
+}
+
+// Process a complete NMEA 2000 message, whether received from an Actisense device or reassembled from raw CAN frames
+void ActisenseDevice::ProcessMessage(const CanHeader header, const std::vector<byte>& payload) {
+	std::vector<wxString> nmeaSentences;
+	bool result = FALSE;
+
+	currentPgn = header.pgn;
+
+	// If we receive a frame from a device, then by definition it is still alive!
+	networkMap.Touch(header.source, header.timestamp);
+
+	// Bus load and who is using it
+	busLoad.Record(header, payload.size(), IsFastMessage(header));
+
+	// And any messages missing since the previous one
+	lossTracker.Record(header, payload);
+
+	// Retain the latest payload for consumers that cannot keep up with the bus rate, such as the metrics endpoint
+	lastValues.Update(header, payload.data(), payload.size(), header.timestamp);
+
+	// Don't bother formatting sentences that no subscriber wants
+	wantedSentences = messageBus.GetWantedSentences();
+	bool isFormatWanted = IsFormatWanted(header.pgn);
+	
+	switch (header.pgn) {
 		
-		// debugMutex->Lock();
-		wxMessageOutputDebug().Printf(_T("Source: %lu\n"),header.source);
-		wxMessageOutputDebug().Printf(_T("PGN: %lu\n"),header.pgn);
-		wxMessageOutputDebug().Printf(_T("Destination: %lu\n"),header.destination);
-		wxMessageOutputDebug().Printf(_T("Priority: %lu\n\n"),header.priority);
-		debugMutex->Unlock();	
+	case 59392: // ISO Ack
+		// No need for us to do anything as we don't send any requests (yet)!
+		// No NMEA 0183 sentences to pass onto OpenCPN
+		result = FALSE;
+		break;
 		
-		switch (header.pgn) {
-			
-		case 59392: // ISO Ack
-			// No need for us to do anything as we don't send any requests (yet)!
-			// No NMEA 0183 sentences to pass onto OpenCPN
-			result = FALSE;
-			break;
-			
-		case 59904: // ISO Request
-			unsigned int requestedPGN;
-			
-			DecodePGN59904(payload, &requestedPGN);
-			// What has been requested from us ?
-			switch (requestedPGN) {
-			
-				case 60928: // Address Claim
-					// BUG BUG The bastards are using an address claim as a heartbeat !!
-					if ((header.destination == networkAddress) || (header.destination == CONST_GLOBAL_ADDRESS)) {
-						int returnCode;
-						returnCode = SendAddressClaim(networkAddress);
-						if (returnCode != TWOCAN_RESULT_SUCCESS) {
-							wxLogMessage(_T("Actisense Device, Error Sending Address Claim (%lu)"), returnCode);
-						}
+	case 59904: // ISO Request
+		unsigned int requestedPGN;
+		
+		DecodePGN59904(payload, &requestedPGN);
+		// What has been requested from us ?
+		switch (requestedPGN) {
+		
+			case 60928: // Address Claim
+				// BUG BUG The bastards are using an address claim as a heartbeat !!
+				if ((header.destination == networkAddress) || (header.destination == CONST_GLOBAL_ADDRESS)) {
+					int returnCode;
+					returnCode = SendAddressClaim(networkAddress);
+					if (returnCode != TWOCAN_RESULT_SUCCESS) {
+						wxLogMessage(_T("Actisense Device, Error Sending Address Claim (%lu)"), returnCode);
 					}
-					break;
-			
-				case 126464: // Supported PGN
-					if ((header.destination == networkAddress) || (header.destination == CONST_GLOBAL_ADDRESS)) {
-						int returnCode;
-						returnCode = SendSupportedPGN();
-						if (returnCode != TWOCAN_RESULT_SUCCESS) {
-							wxLogMessage(_T("Actisense Device, Error Sending Supported PGN (%lu)"), returnCode);
-						}
+				}
+				break;
+		
+			case 126464: // Supported PGN
+				if ((header.destination == networkAddress) || (header.destination == CONST_GLOBAL_ADDRESS)) {
+					int returnCode;
+					returnCode = SendSupportedPGN();
+					if (returnCode != TWOCAN_RESULT_SUCCESS) {
+						wxLogMessage(_T("Actisense Device, Error Sending Supported PGN (%lu)"), returnCode);
 					}
-					break;
-			
-				case 126993: // Heartbeat
-					// BUG BUG I don't think an ISO Request is allowed to request a heartbeat ??
-					break;
-			
-				case 126996: // Product Information 
-					if ((header.destination == networkAddress) || (header.destination == CONST_GLOBAL_ADDRESS)) {
-						int returnCode;
-						returnCode = SendProductInformation();
-						if (returnCode != TWOCAN_RESULT_SUCCESS) {
-							wxLogMessage(_T("Actisense Device, Error Sending Product Information (%lu)"), returnCode);
-						}
+				}
+				break;
+		
+			case 126993: // Heartbeat
+				// BUG BUG I don't think an ISO Request is allowed to request a heartbeat ??
+				break;
+		
+			case 126996: // Product Information 
+				if ((header.destination == networkAddress) || (header.destination == CONST_GLOBAL_ADDRESS)) {
+					int returnCode;
+					returnCode = SendProductInformation();
+					if (returnCode != TWOCAN_RESULT_SUCCESS) {
+						wxLogMessage(_T("Actisense Device, Error Sending Product Information (%lu)"), returnCode);
 					}
-					break;
+				}
+				break;
+		
+			default:
+				// BUG BUG For other requested PG's send a NACK/Not supported
+				break;
+		}
+		// No NMEA 0183 sentences to pass onto OpenCPN
+		result = FALSE;
+		break;
+		
+	case 60928: // ISO Address Claim
+		DecodePGN60928(payload, &deviceInformation);
+		// if another device is not claiming our address, just log it
+		if (header.source != networkAddress) {
 			
-				default:
-					// BUG BUG For other requested PG's send a NACK/Not supported
-					break;
-			}
-			// No NMEA 0183 sentences to pass onto OpenCPN
-			result = FALSE;
-			break;
+			// Add the source address so that we can  construct a "map" of the NMEA2000 network
+			deviceInformation.networkAddress = header.source;
 			
-		case 60928: // ISO Address Claim
-			DecodePGN60928(payload, &deviceInformation);
-			// if another device is not claiming our address, just log it
-			if (header.source != networkAddress) {
-				
-				// Add the source address so that we can  construct a "map" of the NMEA2000 network
-				deviceInformation.networkAddress = header.source;
-				
-				// BUG BUG Extraneous Noise Remove for production
-				
-	#ifndef NDEBUG
-
-				wxLogMessage(_T("Actisense Network, Address: %d"), deviceInformation.networkAddress);
-				wxLogMessage(_T("Actisense Network, Manufacturer: %d"), deviceInformation.manufacturerId);
-				wxLogMessage(_T("Actisense Network, Unique ID: %lu"), deviceInformation.uniqueId);
-				wxLogMessage(_T("Actisense Network, Class: %d"), deviceInformation.deviceClass);
-				wxLogMessage(_T("Actisense Network, Function: %d"), deviceInformation.deviceFunction);
-				wxLogMessage(_T("Actisense Network, Industry %d"), deviceInformation.industryGroup);
-				
-	#endif
+			// BUG BUG Extraneous Noise Remove for production
+			
+#ifndef NDEBUG
+
+			wxLogMessage(_T("Actisense Network, Address: %d"), deviceInformation.networkAddress);
+			wxLogMessage(_T("Actisense Network, Manufacturer: %d"), deviceInformation.manufacturerId);
+			wxLogMessage(_T("Actisense Network, Unique ID: %lu"), deviceInformation.uniqueId);
+			wxLogMessage(_T("Actisense Network, Class: %d"), deviceInformation.deviceClass);
+			wxLogMessage(_T("Actisense Network, Function: %d"), deviceInformation.deviceFunction);
+			wxLogMessage(_T("Actisense Network, Industry %d"), deviceInformation.industryGroup);
 			
-				// Maintain the map of the NMEA 2000 network.
-				// either this is a newly discovered device, or it is resending its address claim
-				if ((networkMap[header.source].uniqueId == deviceInformation.uniqueId) || (networkMap[header.source].uniqueId == 0)) {
-					networkMap[header.source].manufacturerId = deviceInformation.manufacturerId;
-					networkMap[header.source].uniqueId = deviceInformation.uniqueId;
-					networkMap[header.source].timestamp = wxDateTime::Now();
+#endif
+		
+			// Maintain the map of the NMEA 2000 network.
+			// either this is a newly discovered device, or it is resending its address claim
+			// or it has moved from another address, in which case it retains its product info, statistics etc.
+			// Heartbeat timers are indexed by address, but supervise the device using it.
+			// If another device was using this address it has lost it, so it can no longer miss a heartbeat here
+			NetworkInformation addressInformation;
+			if ((networkMap.Read(header.source, &addressInformation)) && (addressInformation.deviceName != 0) && 
+				(addressInformation.deviceName != deviceInformation.deviceName)) {
+				timerWheel->Cancel(TIMER_HEARTBEAT + header.source);
+			}
+			byte previousAddress = networkMap.UpdateAddressClaim(header.source, &deviceInformation);
+			if (previousAddress != CONST_NULL_ADDRESS) {
+				wxLogMessage(_T("Actisense Network, Device %llu moved from address %d to %d"), deviceInformation.deviceName, previousAddress, header.source);
+				// It remains the producer of any NMEA 0183 sentences it was providing
+				ReassignArbitration(previousAddress, header.source);
+				// And its heartbeat supervision moves with it, rather than expiring on whichever device next uses its old address
+				if (timerWheel->IsArmed(TIMER_HEARTBEAT + previousAddress)) {
+					timerWheel->Cancel(TIMER_HEARTBEAT + previousAddress);
+					if (networkMap.Read(header.source, &addressInformation)) {
+						ArmHeartbeatTimer(header.source, addressInformation.heartbeatInterval);
+					}
+				}
+			}
+		}
+		else {
+			// Another device is claiming our address
+			// If our NAME is less than theirs, reclaim our current address 
+			if (deviceName < deviceInformation.deviceName) {
+				int returnCode;
+				returnCode = SendAddressClaim(networkAddress);
+				if (returnCode == TWOCAN_RESULT_SUCCESS) {
+					wxLogMessage(_T("Actisense Device, Reclaimed network address %lu"), networkAddress);
 				}
 				else {
-					// or another device is claiming the address that an existing device had used, so clear out any product info entries
-					networkMap[header.source].manufacturerId = deviceInformation.manufacturerId;
-					networkMap[header.source].uniqueId = deviceInformation.uniqueId;
-					networkMap[header.source].timestamp = wxDateTime::Now();
-					networkMap[header.source].productInformation = {}; // I think this should initialize the product information struct;
+					wxLogMessage(_T("Actisense Device, Error reclaming network address %lu (%lu)"), networkAddress, returnCode);
 				}
 			}
+			// Our uniqueId is larger (or equal), so increment our network address and see if we can claim the new address
 			else {
-				// Another device is claiming our address
-				// If our NAME is less than theirs, reclaim our current address 
-				if (deviceName < deviceInformation.deviceName) {
+				networkAddress += 1;
+				if (networkAddress <= CONST_MAX_DEVICES) {
 					int returnCode;
 					returnCode = SendAddressClaim(networkAddress);
 					if (returnCode == TWOCAN_RESULT_SUCCESS) {
-						wxLogMessage(_T("Actisense Device, Reclaimed network address %lu"), networkAddress);
+						wxLogMessage(_T("Actisense Device, Claimed network address %lu"), networkAddress);
 					}
 					else {
-						wxLogMessage(_T("Actisense Device, Error reclaming network address %lu (%lu)"), networkAddress, returnCode);
+						wxLogMessage(_T("Actisense Device, Error claiming network address %lu (%lu)"), networkAddress, returnCode);
 					}
 				}
-				// Our uniqueId is larger (or equal), so increment our network address and see if we can claim the new address
 				else {
-					networkAddress += 1;
-					if (networkAddress <= CONST_MAX_DEVICES) {
-						int returnCode;
-						returnCode = SendAddressClaim(networkAddress);
-						if (returnCode == TWOCAN_RESULT_SUCCESS) {
-							wxLogMessage(_T("Actisense Device, Claimed network address %lu"), networkAddress);
-						}
-						else {
-							wxLogMessage(_T("Actisense Device, Error claiming network address %lu (%lu)"), networkAddress, returnCode);
-						}
+					// BUG BUG More than 253 devices on the network, we send an unable to claim address frame (source address = 254)
+					// Chuckles to self. What a nice DOS attack vector! Kick everyone else off the network!
+					// I guess NMEA never thought anyone would hack a boat! What were they (not) thinking!
+					wxLogError(_T("Actisense Device, Unable to claim address, more than %d devices"), CONST_MAX_DEVICES);
+					networkAddress = 0;
+					int returnCode;
+					returnCode = SendAddressClaim(CONST_NULL_ADDRESS);
+					if (returnCode == TWOCAN_RESULT_SUCCESS) {
+						wxLogMessage(_T("Actisense Device, Claimed network address %lu"), networkAddress);
 					}
 					else {
-						// BUG BUG More than 253 devices on the network, we send an unable to claim address frame (source address = 254)
-						// Chuckles to self. What a nice DOS attack vector! Kick everyone else off the network!
-						// I guess NMEA never thought anyone would hack a boat! What were they (not) thinking!
-						wxLogError(_T("Actisense Device, Unable to claim address, more than %d devices"), CONST_MAX_DEVICES);
-						networkAddress = 0;
-						int returnCode;
-						returnCode = SendAddressClaim(CONST_NULL_ADDRESS);
-						if (returnCode == TWOCAN_RESULT_SUCCESS) {
-							wxLogMessage(_T("Actisense Device, Claimed network address %lu"), networkAddress);
-						}
-						else {
-							wxLogMessage(_T("Actisense Device, Error claiming network address %lu (%lu)"), networkAddress, returnCode);
-						}
+						wxLogMessage(_T("Actisense Device, Error claiming network address %lu (%lu)"), networkAddress, returnCode);
 					}
 				}
 			}
-			// No NMEA 0183 sentences to pass onto OpenCPN
-			result = FALSE;
-			break;
-			
-		case 65240: // ISO Commanded address
-			// A device is commanding another device to use a specific address
-			DecodePGN65240(payload, &deviceInformation);
-			// If we are being commanded to use a specific address
-			// BUG BUG Not sure if an ISO Commanded Address frame is broadcast or if header.destination == networkAddress
-			if (deviceInformation.uniqueId == uniqueId) {
-				// Update our network address to the commanded address and send an address claim
-				networkAddress = deviceInformation.networkAddress;
-				int returnCode;
-				returnCode = SendAddressClaim(networkAddress);
-				if (returnCode == TWOCAN_RESULT_SUCCESS) {
-					wxLogMessage(_T("Actisense Device, Claimed commanded network address: %lu"), networkAddress);
-				}
-				else {
-					wxLogMessage("Actisense Device, Error claiming commanded network address %lu: %lu", networkAddress, returnCode);
-				}
-			}
-			// No NMEA 0183 sentences to pass onto OpenCPN
-			result = FALSE;
-			break;
-			
-		case 126992: // System Time
-			if (supportedPGN & FLAGS_ZDA) {
-				result = DecodePGN126992(payload, &nmeaSentences);
-			}
-			break;
-			
-		case 126993: // Heartbeat
-			DecodePGN126993(header.source, payload);
-			// Update the matching entry in the network map
-			// BUG BUG what happens if we are yet to have populated this entry with the device details ?? Probably nothing...
-			networkMap[header.source].timestamp = wxDateTime::Now();
-			result = FALSE;
-			break;
-			
-		case 126996: // Product Information
-			DecodePGN126996(payload, &productInformation);
-			
-			// BUG BUG Extraneous Noise
-			
-	#ifndef NDEBUG
-			wxLogMessage(_T("Actisense Node, Network Address %d"), header.source);
-			wxLogMessage(_T("Actisense Node, DB Ver: %d"), productInformation.dataBaseVersion);
-			wxLogMessage(_T("Actisense Node, Product Code: %d"), productInformation.productCode);
-			wxLogMessage(_T("Actisense Node, Cert Level: %d"), productInformation.certificationLevel);
-			wxLogMessage(_T("Actisense Node, Load Level: %d"), productInformation.loadEquivalency);
-			wxLogMessage(_T("Actisense Node, Model ID: %s"), productInformation.modelId);
-			wxLogMessage(_T("Actisense Node, Model Version: %s"), productInformation.modelVersion);
-			wxLogMessage(_T("Actisense Node, Software Version: %s"), productInformation.softwareVersion);
-			wxLogMessage(_T("Actisense Node, Serial Number: %s"), productInformation.serialNumber);
-	#endif
-			
-			// Maintain the map of the NMEA 2000 network.
-			networkMap[header.source].productInformation = productInformation;
-			networkMap[header.source].timestamp = wxDateTime::Now();
-
-			// No NMEA 0183 sentences to pass onto OpenCPN
-			result = FALSE;
-			break;
-
-		case 127245: // Rudder
-			if (supportedPGN & FLAGS_RDR) {
-				result = DecodePGN127245(payload, &nmeaSentences);
-			}
-			break;
-			
-		case 127250: // Heading
-			if (supportedPGN & FLAGS_HDG) {
-				result = DecodePGN127250(payload, &nmeaSentences);
-			}
-			break;
-			
-		case 127251: // Rate of Turn
-			if (supportedPGN & FLAGS_ROT) {
-				result = DecodePGN127251(payload, &nmeaSentences);
-			}
-			break;
-			
-		case 127257: // Attitude
-			if (supportedPGN & FLAGS_XDR) {
-				result = DecodePGN127257(payload, &nmeaSentences);
-			}
-			break;
-			
-		case 127258: // Magnetic Variation
-			// BUG BUG needs flags 
-			// BUG BUG Not actually used anywhere
-			result = DecodePGN127258(payload, &nmeaSentences);
-			break;
-
-		case 127488: // Engine Parameters, Rapid Update
-			if (supportedPGN & FLAGS_ENG) {
-				result = DecodePGN127488(payload, &nmeaSentences);
-			}
-			break;
-
-		case 127489: // Engine Parameters, Dynamic
-			if (supportedPGN & FLAGS_ENG) {
-				result = DecodePGN127489(payload, &nmeaSentences);
-			}
-			break;
-
-		case 127505: // Fluid Levels
-			if (supportedPGN & FLAGS_TNK) {
-				result = DecodePGN127505(payload, &nmeaSentences);
-			}
-			break;
-			
-		case 128259: // Boat Speed
-			if (supportedPGN & FLAGS_VHW) {
-				result = DecodePGN128259(payload, &nmeaSentences);
-			}
-			break;
-			
-		case 128267: // Water Depth
-			if (supportedPGN & FLAGS_DPT) {
-				result = DecodePGN128267(payload, &nmeaSentences);
+		}
+		// No NMEA 0183 sentences to pass onto OpenCPN
+		result = FALSE;
+		break;
+		
+	case 65240: // ISO Commanded address
+		// A device is commanding another device to use a specific address
+		DecodePGN65240(payload, &deviceInformation);
+		// If we are being commanded to use a specific address
+		// BUG BUG Not sure if an ISO Commanded Address frame is broadcast or if header.destination == networkAddress
+		if (deviceInformation.uniqueId == uniqueId) {
+			// Update our network address to the commanded address and send an address claim
+			networkAddress = deviceInformation.networkAddress;
+			int returnCode;
+			returnCode = SendAddressClaim(networkAddress);
+			if (returnCode == TWOCAN_RESULT_SUCCESS) {
+				wxLogMessage(_T("Actisense Device, Claimed commanded network address: %lu"), networkAddress);
 			}
-			break;
-			
-		case 129025: // Position - Rapid Update
-			if (supportedPGN & FLAGS_GLL) {
-				result = DecodePGN129025(payload, &nmeaSentences);
+			else {
+				wxLogMessage("Actisense Device, Error claiming commanded network address %lu: %lu", networkAddress, returnCode);
 			}
-			break;
+		}
+		// No NMEA 0183 sentences to pass onto OpenCPN
+		result = FALSE;
+		break;
 		
-		case 129026: // COG, SOG - Rapid Update
-			if (supportedPGN & FLAGS_VTG) {
-				result = DecodePGN129026(payload, &nmeaSentences);
-			}
-			break;
+	case 126992: // System Time
+		if ((supportedPGN & FLAGS_ZDA) && (isFormatWanted)) {
+			result = DecodePGN126992(payload, &nmeaSentences);
+		}
+		break;
+		
+	case 126993: // Heartbeat
+		unsigned int heartbeatInterval;
+		if (DecodePGN126993(header.source, payload, &heartbeatInterval)) {
+			// The network map has already been updated with the time the device was last seen
+			networkMap.UpdateHeartbeat(header.source, heartbeatInterval);
+			ArmHeartbeatTimer(header.source, heartbeatInterval);
+		}
+		result = FALSE;
+		break;
 		
-		case 129029: // GNSS Position
-			if (supportedPGN & FLAGS_GGA) {
-				result = DecodePGN129029(payload, &nmeaSentences);
-			}
-			break;
+	case 126996: // Product Information
+		DecodePGN126996(payload, &productInformation);
 		
-		case 129033: // Time & Date
-			if (supportedPGN & FLAGS_ZDA) {
-				result = DecodePGN129033(payload, &nmeaSentences);
-			}
-			break;
-			
-		case 129038: // AIS Class A Position Report
-			if (supportedPGN & FLAGS_AIS) {
-				result = DecodePGN129038(payload, &nmeaSentences);
-			}
-			break;
+		// BUG BUG Extraneous Noise
 		
-		case 129039: // AIS Class B Position Report
-			if (supportedPGN & FLAGS_AIS) {
-				result = DecodePGN129039(payload, &nmeaSentences);
-			}
-			break;
+#ifndef NDEBUG
+		wxLogMessage(_T("Actisense Node, Network Address %d"), header.source);
+		wxLogMessage(_T("Actisense Node, DB Ver: %d"), productInformation.dataBaseVersion);
+		wxLogMessage(_T("Actisense Node, Product Code: %d"), productInformation.productCode);
+		wxLogMessage(_T("Actisense Node, Cert Level: %d"), productInformation.certificationLevel);
+		wxLogMessage(_T("Actisense Node, Load Level: %d"), productInformation.loadEquivalency);
+		wxLogMessage(_T("Actisense Node, Model ID: %s"), productInformation.modelId);
+		wxLogMessage(_T("Actisense Node, Model Version: %s"), productInformation.modelVersion);
+		wxLogMessage(_T("Actisense Node, Software Version: %s"), productInformation.softwareVersion);
+		wxLogMessage(_T("Actisense Node, Serial Number: %s"), productInformation.serialNumber);
+#endif
 		
-		case 129040: // AIS Class B Extended Position Report
-			if (supportedPGN & FLAGS_AIS) {
-				result = DecodePGN129040(payload, &nmeaSentences);
-			}
-			break;
+		// Maintain the map of the NMEA 2000 network.
+		networkMap.UpdateProductInformation(header.source, &productInformation);
+
+		// No NMEA 0183 sentences to pass onto OpenCPN
+		result = FALSE;
+		break;
+
+	case 127245: // Rudder
+		if ((supportedPGN & FLAGS_RDR) && (isFormatWanted)) {
+			result = DecodePGN127245(payload, &nmeaSentences);
+		}
+		break;
 		
-		case 129041: // AIS Aids To Navigation (AToN) Position Report
-			if (supportedPGN & FLAGS_AIS) {
-				result = DecodePGN129041(payload, &nmeaSentences);
-			}
-			break;
+	case 127250: // Heading
+		if (DecodeTyped(header, ActisenseDecode::DecodeHeading(payload, &decodedMessage.heading)) && (supportedPGN & FLAGS_HDG) && (isFormatWanted)) {
+			result = FormatHeading(decodedMessage.heading, &nmeaSentences);
+		}
+		break;
 		
-		case 129283: // Cross Track Error
-			if (supportedPGN & FLAGS_XTE) {
-				result = DecodePGN129283(payload, &nmeaSentences);
-			}
-			break;
-			
-		case 129284: // Navigation Information
-			if (supportedPGN & FLAGS_NAV) {
-				result = DecodePGN129284(payload, &nmeaSentences);
-			}
-			break;
-			
-		case 129285: // Route & Waypoint Information
-			if (supportedPGN & FLAGS_RTE) {
-				result = DecodePGN129285(payload, &nmeaSentences);
-			}
-			break;
+	case 127251: // Rate of Turn
+		if ((supportedPGN & FLAGS_ROT) && (isFormatWanted)) {
+			result = DecodePGN127251(payload, &nmeaSentences);
+		}
+		break;
+		
+	case 127257: // Attitude
+		if ((supportedPGN & FLAGS_XDR) && (isFormatWanted)) {
+			result = DecodePGN127257(payload, &nmeaSentences);
+		}
+		break;
+		
+	case 127258: // Magnetic Variation
+		// BUG BUG needs flags 
+		// BUG BUG Not actually used anywhere
+		result = DecodePGN127258(payload, &nmeaSentences);
+		break;
 
-		case 129793: // AIS Position and Date Report
-			if (supportedPGN & FLAGS_AIS) {
-				result = DecodePGN129793(payload, &nmeaSentences);
-			}
-			break;
+	case 127488: // Engine Parameters, Rapid Update
+		if ((supportedPGN & FLAGS_ENG) && (isFormatWanted)) {
+			result = DecodePGN127488(payload, &nmeaSentences);
+		}
+		break;
+
+	case 127489: // Engine Parameters, Dynamic
+		if ((supportedPGN & FLAGS_ENG) && (isFormatWanted)) {
+			result = DecodePGN127489(payload, &nmeaSentences);
+		}
+		break;
+
+	case 127505: // Fluid Levels
+		if ((supportedPGN & FLAGS_TNK) && (isFormatWanted)) {
+			result = DecodePGN127505(payload, &nmeaSentences);
+		}
+		break;
 		
-		case 129794: // AIS Class A Static & Voyage Related Data
-			if (supportedPGN & FLAGS_AIS) {
-				result = DecodePGN129794(payload, &nmeaSentences);
-			}
-			break;
+	case 128259: // Boat Speed
+		if ((supportedPGN & FLAGS_VHW) && (isFormatWanted)) {
+			result = DecodePGN128259(payload, &nmeaSentences);
+		}
+		break;
 		
-		case 129798: // AIS Search and Rescue (SAR) Position Report
-			if (supportedPGN & FLAGS_AIS) {
-				result = DecodePGN129798(payload, &nmeaSentences);
-			}
-			break;
+	case 128267: // Water Depth
+		if ((supportedPGN & FLAGS_DPT) && (isFormatWanted)) {
+			result = DecodePGN128267(payload, &nmeaSentences);
+		}
+		break;
 		
-		case 129808: // Digital Selective Calling (DSC)
-			if (supportedPGN & FLAGS_DSC) {
-				result = DecodePGN129808(payload, &nmeaSentences);
-			}
-			break;
+	case 129025: // Position - Rapid Update
+		if (DecodeTyped(header, ActisenseDecode::DecodePosition(payload, &decodedMessage.position)) && (supportedPGN & FLAGS_GLL) && (isFormatWanted)) {
+			result = FormatPosition(decodedMessage.position, &nmeaSentences);
+		}
+		break;
+	
+	case 129026: // COG, SOG - Rapid Update
+		if (DecodeTyped(header, ActisenseDecode::DecodeCourseOverGround(payload, &decodedMessage.courseOverGround)) && (supportedPGN & FLAGS_VTG) && (isFormatWanted)) {
+			result = FormatCourseOverGround(decodedMessage.courseOverGround, &nmeaSentences);
+		}
+		break;
+	
+	case 129029: // GNSS Position
+		if (DecodeTyped(header, ActisenseDecode::DecodeGnssFix(payload, &decodedMessage.gnssFix)) && (supportedPGN & FLAGS_GGA) && (isFormatWanted)) {
+			result = FormatGnssFix(decodedMessage.gnssFix, &nmeaSentences);
+		}
+		break;
+	
+	case 129033: // Time & Date
+		if ((supportedPGN & FLAGS_ZDA) && (isFormatWanted)) {
+			result = DecodePGN129033(payload, &nmeaSentences);
+		}
+		break;
 		
-		case 129809: // AIS Class B Static Data, Part A
-			if (supportedPGN & FLAGS_AIS) {
-				result = DecodePGN129809(payload, &nmeaSentences);
-			}
-			break;
+	case 129038: // AIS Class A Position Report
+		if (DecodeTyped(header, ActisenseDecode::DecodeAisClassAReport(payload, &decodedMessage.aisClassAReport)) && (supportedPGN & FLAGS_AIS) && (isFormatWanted)) {
+			result = FormatAisClassAReport(decodedMessage.aisClassAReport, &nmeaSentences);
+		}
+		break;
+	
+	case 129039: // AIS Class B Position Report
+		if ((supportedPGN & FLAGS_AIS) && (isFormatWanted)) {
+			result = DecodePGN129039(payload, &nmeaSentences);
+		}
+		break;
+	
+	case 129040: // AIS Class B Extended Position Report
+		if ((supportedPGN & FLAGS_AIS) && (isFormatWanted)) {
+			result = DecodePGN129040(payload, &nmeaSentences);
+		}
+		break;
+	
+	case 129041: // AIS Aids To Navigation (AToN) Position Report
+		if ((supportedPGN & FLAGS_AIS) && (isFormatWanted)) {
+			result = DecodePGN129041(payload, &nmeaSentences);
+		}
+		break;
+	
+	case 129283: // Cross Track Error
+		if ((supportedPGN & FLAGS_XTE) && (isFormatWanted)) {
+			result = DecodePGN129283(payload, &nmeaSentences);
+		}
+		break;
 		
-		case 129810: // Class B Static Data, Part B
-			if (supportedPGN & FLAGS_AIS) {
-				result = DecodePGN129810(payload, &nmeaSentences);
-			}
-			break;
+	case 129284: // Navigation Information
+		if ((supportedPGN & FLAGS_NAV) && (isFormatWanted)) {
+			result = DecodePGN129284(payload, &nmeaSentences);
+		}
+		break;
 		
-		case 130306: // Wind data
-			if (supportedPGN & FLAGS_MWV) {
-				result = DecodePGN130306(payload, &nmeaSentences);
-			}
-			break;
+	case 129285: // Route & Waypoint Information
+		if ((supportedPGN & FLAGS_RTE) && (isFormatWanted)) {
+			result = DecodePGN129285(payload, &nmeaSentences);
+		}
+		break;
+
+	case 129793: // AIS Position and Date Report
+		if ((supportedPGN & FLAGS_AIS) && (isFormatWanted)) {
+			result = DecodePGN129793(payload, &nmeaSentences);
+		}
+		break;
+	
+	case 129794: // AIS Class A Static & Voyage Related Data
+		if ((supportedPGN & FLAGS_AIS) && (isFormatWanted)) {
+			result = DecodePGN129794(payload, &nmeaSentences);
+		}
+		break;
+	
+	case 129798: // AIS Search and Rescue (SAR) Position Report
+		if ((supportedPGN & FLAGS_AIS) && (isFormatWanted)) {
+			result = DecodePGN129798(payload, &nmeaSentences);
+		}
+		break;
+	
+	case 129808: // Digital Selective Calling (DSC)
+		if ((supportedPGN & FLAGS_DSC) && (isFormatWanted)) {
+			result = DecodePGN129808(payload, &nmeaSentences);
+		}
+		break;
+	
+	case 129809: // AIS Class B Static Data, Part A
+		if ((supportedPGN & FLAGS_AIS) && (isFormatWanted)) {
+			result = DecodePGN129809(payload, &nmeaSentences);
+		}
+		break;
+	
+	case 129810: // Class B Static Data, Part B
+		if ((supportedPGN & FLAGS_AIS) && (isFormatWanted)) {
+			result = DecodePGN129810(payload, &nmeaSentences);
+		}
+		break;
+	
+	case 130306: // Wind data
+		if ((supportedPGN & FLAGS_MWV) && (isFormatWanted)) {
+			result = DecodePGN130306(payload, &nmeaSentences);
+		}
+		break;
+	
+	case 130310: // Environmental Parameters
+		if ((supportedPGN & FLAGS_MWT) && (isFormatWanted)) {
+			result = DecodePGN130310(payload, &nmeaSentences);
+		}
+		break;
 		
-		case 130310: // Environmental Parameters
-			if (supportedPGN & FLAGS_MWT) {
-				result = DecodePGN130310(payload, &nmeaSentences);
+	case 130311: // Environmental Parameters (supercedes 130310)
+		if ((supportedPGN & FLAGS_MWT) && (isFormatWanted)) {
+			result = DecodePGN130311(payload, &nmeaSentences);
+		}
+		break;
+	
+	case 130312: // Temperature
+		if ((supportedPGN & FLAGS_MWT) && (isFormatWanted)) {
+			result = DecodePGN130312(payload, &nmeaSentences);
+		}
+		break;
+		
+	case 130316: // Temperature Extended Range
+		if ((supportedPGN & FLAGS_MWT) && (isFormatWanted)) {
+			result = DecodePGN130316(payload, &nmeaSentences);
+		}
+		break;
+
+	case 130577: // Direction Data, its VTG is suppressed whilst 129026 is providing one
+		if ((supportedPGN & FLAGS_VTG) && (isFormatWanted)) {
+			result = DecodePGN130577(payload, &nmeaSentences);
+		}
+		break;
+			
+	default:
+		// BUG BUG Should we log an unsupported PGN error ??
+		// No NMEA 0183 sentences to pass onto OpenCPN
+		result = FALSE;
+		break;
+	}
+	// Send each NMEA 0183 Sentence to OpenCPN
+	if (result == TRUE) {
+		for (std::vector<wxString>::iterator it = nmeaSentences.begin(); it != nmeaSentences.end(); ++it) {
+			// The data is fresh even if another producer's sentence is sent in its place
+			int sentenceType = ActisenseBus::GetSentenceType(*it);
+			ArmStaleDataTimer(sentenceType);
+			// Unless another PGN or device is already providing the same sentence, the PGN's other sentences are unaffected
+			if ((sentenceType != NOT_FOUND) && (IsRedundantSentence(header, sentenceType))) {
+				continue;
 			}
-			break;
+			UpdateArbitration(header, sentenceType);
+			SendNMEASentence(*it);
+		}
+	}
+	PublishMessage(header, payload);
+}
+
+// Determine whether a fresher or higher ranked producer has already supplied this type of NMEA 0183 sentence.
+// The current producer retains ownership of a sentence type until it goes quiet for CONST_ARBITRATION_PERIOD,
+// so that two GPS's or a GPS and a chartplotter's clock don't generate interleaved, contradictory sentences.
+bool ActisenseDevice::IsRedundantSentence(const CanHeader header, const int sentenceType) {
+	for (size_t i = 0; i < sizeof(sentenceProducers) / sizeof(sentenceProducers[0]); i++) {
+		if ((sentenceProducers[i].pgn == header.pgn) && (sentenceProducers[i].sentenceType == sentenceType)) {
+			ArbitrationEntry *entry = &arbitrationTable[sentenceType];
 			
-		case 130311: // Environmental Parameters (supercedes 130310)
-			if (supportedPGN & FLAGS_MWT) {
-				result = DecodePGN130311(payload, &nmeaSentences);
+			// No producer yet, or the same producer
+			if ((entry->pgn == 0) || ((entry->pgn == header.pgn) && (entry->source == header.source))) {
+				return FALSE;
 			}
-			break;
-		
-		case 130312: // Temperature
-			if (supportedPGN & FLAGS_MWT) {
-				result = DecodePGN130312(payload, &nmeaSentences);
+			
+			// Current producer has gone quiet, anyone may take over
+			if ((TwoCanUtils::GetMonotonicMillis() - entry->timestamp) > CONST_ARBITRATION_PERIOD) {
+				return FALSE;
 			}
-			break;
 			
-		case 130316: // Temperature Extended Range
-			if (supportedPGN & FLAGS_MWT) {
-				result = DecodePGN130316(payload, &nmeaSentences);
+			// A better producer always takes over, otherwise the current producer keeps it
+			return (sentenceProducers[i].rank >= entry->rank);
+		}
+	}
+	// Not a PGN whose sentences are produced elsewhere
+	return FALSE;
+}
+
+// The device is presumed to have left the network if it misses its next heartbeats
+void ActisenseDevice::ArmHeartbeatTimer(const byte deviceAddress, const unsigned int heartbeatInterval) {
+	timerWheel->Arm(TIMER_HEARTBEAT + deviceAddress, TwoCanUtils::GetMonotonicMillis() + 
+		(CONST_HEARTBEAT_MISSED * ((heartbeatInterval > 0) ? heartbeatInterval : CONST_HEARTBEAT_INTERVAL)));
+}
+
+// Linear search, but the table is short
+void ActisenseDevice::ArmStaleDataTimer(const int sentenceType) {
+	for (size_t i = 0; i < STALE_DATA_TIMERS; i++) {
+		if (staleDataSentences[i].sentenceType == sentenceType) {
+			timerWheel->Arm(TIMER_STALE_DATA + i, TwoCanUtils::GetMonotonicMillis() + CONST_DATA_STALE_PERIOD);
+			return;
+		}
+	}
+}
+
+// Once a second, rather than for every frame, as the queue and the serial statistics are guarded by mutexes
+void ActisenseDevice::SampleStatistics(void) {
+	deviceStatistics.SetDropped(canQueue->GetDroppedFrames());
+	deviceStatistics.SetQueue(canQueue->GetCount(), canQueue->GetHighWaterMark(), canQueue->GetCapacity(), canQueue->GetCoalescedFrames());
+	deviceStatistics.SetAdapterDropped(ngtStatus.GetStatistics().rxDropped);
+	SerialStatistics serial;
+	if (deviceInterface->GetSerialStatistics(&serial)) {
+		deviceStatistics.SetSerial(serial);
+	}
+}
+
+// Each expired timer is reported once, it is re-armed when the next heartbeat or data is received
+void ActisenseDevice::SuperviseTimers(void) {
+	unsigned long long now = TwoCanUtils::GetMonotonicMillis();
+
+	// Decay the bus load rates
+	busLoad.Update(now);
+
+	// Warn if messages are being lost in quantity
+	if ((now - droppedFrameTime) >= (CONST_DROPPEDFRAME_PERIOD * CONST_ONE_SECOND)) {
+		unsigned long long lost = lossTracker.GetLostMessages() - droppedFrameCount;
+		if ((droppedFrameTime > 0) && (lost > CONST_DROPPEDFRAME_THRESHOLD)) {
+			wxLogMessage(_T("Actisense Device, %llu messages lost in the last %d seconds"), lost, CONST_DROPPEDFRAME_PERIOD);
+		}
+		droppedFrameTime = now;
+		droppedFrameCount = lossTracker.GetLostMessages();
+	}
+
+	// Incomplete Fast Packets
+	if ((fastMessageCount > 0) && ((now - lastGarbageCollection) >= CONST_WHEEL_TICK)) {
+		MapGarbageCollector();
+		lastGarbageCollection = now;
+	}
+
+	if (timerWheel->Advance(now, expiredTimers) > 0) {
+		// Sentences raised here are not the result of a received frame, so exclude them from the latency statistics
+		currentPostedTime = 0;
+		currentTimestamp = 0;
+		wantedSentences = messageBus.GetWantedSentences();
+		for (std::vector<int>::iterator it = expiredTimers.begin(); it != expiredTimers.end(); ++it) {
+			if (*it < TIMER_STALE_DATA) {
+				byte deviceAddress = *it - TIMER_HEARTBEAT;
+				networkMap.ExpireHeartbeat(deviceAddress);
+				wxLogMessage(_T("Actisense Network, Device at address %d missed its heartbeat"), deviceAddress);
 			}
-			break;
-				
-		default:
-			// BUG BUG Should we log an unsupported PGN error ??
-			// No NMEA 0183 sentences to pass onto OpenCPN
-			result = FALSE;
-			break;
-		}
-		// Send each NMEA 0183 Sentence to OpenCPN
-		if (result == TRUE) {
-			for (std::vector<wxString>::iterator it = nmeaSentences.begin(); it != nmeaSentences.end(); ++it) {
-				SendNMEASentence(*it);
+			else if (transport->IsTransportTimer(*it)) {
+				transport->Expire(*it);
+			}
+			else if (*it == TIMER_ADAPTER_STATUS) {
+				// The serial port is non blocking, so the query does not hold up the frames that follow
+				deviceInterface->WriteCommand({ NGT_CMD_SYSTEM_STATUS });
+				timerWheel->Arm(TIMER_ADAPTER_STATUS, now + CONST_NGT_STATUS_INTERVAL);
+			}
+			else if (*it == TIMER_STATISTICS) {
+				SampleStatistics();
+				timerWheel->Arm(TIMER_STATISTICS, now + CONST_STATISTICS_INTERVAL);
+			}
+			else {
+				wxLogMessage(_T("Actisense Device, No data received for %s"), staleDataSentences[*it - TIMER_STALE_DATA].sentence);
+				SendNMEASentence(staleDataSentences[*it - TIMER_STALE_DATA].sentence);
+				CanHeader header = {};
+				header.pgn = staleDataSentences[*it - TIMER_STALE_DATA].pgn;
+				header.source = CONST_GLOBAL_ADDRESS;
+				header.destination = CONST_GLOBAL_ADDRESS;
+				PublishMessage(header, std::vector<byte>());
 			}
 		}
 	}
 }
 
+// A producer that has moved to another address remains the producer of its sentences
+void ActisenseDevice::ReassignArbitration(const byte previousAddress, const byte networkAddress) {
+	for (int i = 0; i < SENTENCE_TYPES; i++) {
+		if ((arbitrationTable[i].pgn != 0) && (arbitrationTable[i].source == previousAddress)) {
+			arbitrationTable[i].source = networkAddress;
+		}
+	}
+}
+
+// Record the PGN & source that has just produced a sentence
+void ActisenseDevice::UpdateArbitration(const CanHeader header, const int sentenceType) {
+	for (size_t i = 0; i < sizeof(sentenceProducers) / sizeof(sentenceProducers[0]); i++) {
+		if ((sentenceProducers[i].pgn == header.pgn) && (sentenceProducers[i].sentenceType == sentenceType)) {
+			ArbitrationEntry *entry = &arbitrationTable[sentenceType];
+			entry->pgn = header.pgn;
+			entry->source = header.source;
+			entry->rank = sentenceProducers[i].rank;
+			entry->timestamp = TwoCanUtils::GetMonotonicMillis();
+			return;
+		}
+	}
+}
+
 // Decode PGN 59904 ISO Request
 int ActisenseDevice::DecodePGN59904(std::vector<byte> payload, unsigned int *requestedPGN) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 		*requestedPGN = payload[0] | (payload[1] << 8) | (payload[2] << 16);
 		return TRUE;
@@ -759,6 +1486,7 @@ int ActisenseDevice::DecodePGN59904(std::vector<byte> payload, unsigned int *req
 
 // Decode PGN 60928 ISO Address Claim
 int ActisenseDevice::DecodePGN60928(std::vector<byte> payload, DeviceInformation *deviceInformation) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if ((payload.size() > 0) && (deviceInformation != NULL)) {
 		
 		// Unique Identity Number 21 bits
@@ -792,7 +1520,7 @@ int ActisenseDevice::DecodePGN60928(std::vector<byte> payload, DeviceInformation
 		//payload[7] & 0x80) >> 7
 
 		// NAME
-		deviceInformation->deviceName = (unsigned long long)payload[0] | ((unsigned long long)payload[1] << 8) | ((unsigned long long)payload[2] << 16) | ((unsigned long long)payload[3] << 24) | ((unsigned long long)payload[4] << 32) | ((unsigned long long)payload[5] << 40) | ((unsigned long long)payload[6] << 48) | ((unsigned long long)payload[7] << 54);
+		deviceInformation->deviceName = (unsigned long long)payload[0] | ((unsigned long long)payload[1] << 8) | ((unsigned long long)payload[2] << 16) | ((unsigned long long)payload[3] << 24) | ((unsigned long long)payload[4] << 32) | ((unsigned long long)payload[5] << 40) | ((unsigned long long)payload[6] << 48) | ((unsigned long long)payload[7] << 56);
 		
 		return TRUE;
 	}
@@ -803,6 +1531,7 @@ int ActisenseDevice::DecodePGN60928(std::vector<byte> payload, DeviceInformation
 
 // Decode PGN 65240 ISO Commanded Address
 int ActisenseDevice::DecodePGN65240(std::vector<byte> payload, DeviceInformation *deviceInformation) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if ((payload.size() > 0) && (deviceInformation != NULL)) {
 		
 		// Unique Id 21 bits
@@ -848,6 +1577,7 @@ int ActisenseDevice::DecodePGN65240(std::vector<byte> payload, DeviceInformation
 // Decode PGN 126992 NMEA System Time
 // $--ZDA, hhmmss.ss, xx, xx, xxxx, xx, xx*hh<CR><LF>
 bool ActisenseDevice::DecodePGN126992(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte sid;
@@ -881,11 +1611,14 @@ bool ActisenseDevice::DecodePGN126992(std::vector<byte> payload, std::vector<wxS
 }
 
 // Decode PGN 126993 NMEA Heartbeat
-bool ActisenseDevice::DecodePGN126993(const int source, std::vector<byte> payload) {
-	if (payload.size() > 0) {
+bool ActisenseDevice::DecodePGN126993(const int source, std::vector<byte> payload, unsigned int *heartbeatInterval) {
+	ACTISENSE_PROFILE_FUNCTION();
+	if ((payload.size() > 0) && (heartbeatInterval != NULL)) {
 
+		// Interval between heartbeats, milliseconds
 		unsigned short timeOffset;
 		timeOffset = payload[0] | (payload[1] << 8);
+		*heartbeatInterval = TwoCanUtils::IsDataValid(timeOffset) ? timeOffset : 0;
 		
 		byte counter;
 		counter = payload[2];
@@ -915,6 +1648,7 @@ bool ActisenseDevice::DecodePGN126993(const int source, std::vector<byte> payloa
 
 // Decode PGN 126996 NMEA Product Information
 int ActisenseDevice::DecodePGN126996(std::vector<byte> payload, ProductInformation *productInformation) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if ((payload.size() > 0) && (productInformation != NULL)) {
 
 		// Should divide by 100 to get the correct displayable version
@@ -969,6 +1703,7 @@ int ActisenseDevice::DecodePGN126996(std::vector<byte> payload, ProductInformati
 // Decode PGN 127245 NMEA Rudder
 // $--RSA, x.x, A, x.x, A*hh<CR><LF>
 bool ActisenseDevice::DecodePGN127245(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte instance;
@@ -1005,88 +1740,68 @@ bool ActisenseDevice::DecodePGN127245(std::vector<byte> payload, std::vector<wxS
 	}
 }
 
-// Decode PGN 127250 NMEA Vessel Heading
+// Format PGN 127250 NMEA Vessel Heading
 // $--HDG, x.x, x.x, a, x.x, a*hh<CR><LF>
 // $--HDT,x.x,T*hh<CR><LF>
-bool ActisenseDevice::DecodePGN127250(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
-	if (payload.size() > 0) {
-
-		byte sid;
-		sid = payload[0];
-
-		unsigned short heading;
-		heading = payload[1] | (payload[2] << 8);
-
-		short deviation;
-		deviation = payload[3] | (payload[4] << 8);
-
-		short variation;
-		variation = payload[5] | (payload[6] << 8);
+bool ActisenseDevice::FormatHeading(const Heading& heading, std::vector<wxString> *nmeaSentences) {
+	// Sign of variation and deviation corresponds to East (E) or West (W)
+	
+	if (heading.reference == HEADING_MAGNETIC) {
+	
+		if (TwoCanUtils::IsDataValid(heading.heading)) {
+			
+			if (IsSentenceWanted(SENTENCE_HDM)) {
+				nmeaSentences->push_back(wxString::Format("$IIHDM,%.2f", RADIANS_TO_DEGREES((float)heading.heading / 10000)));
+			}
 
-		byte headingReference;
-		headingReference = (payload[7] & 0x03);
-		
-		// Sign of variation and deviation corresponds to East (E) or West (W)
-		
-		if (headingReference == HEADING_MAGNETIC) {
+			if (!IsSentenceWanted(SENTENCE_HDG)) {
+				return TRUE;
+			}
 		
-			if (TwoCanUtils::IsDataValid(heading)) {
-				
-				nmeaSentences->push_back(wxString::Format("$IIHDM,%.2f", RADIANS_TO_DEGREES((float)heading / 10000)));
+			if (TwoCanUtils::IsDataValid(heading.deviation)) {
 			
-				if (TwoCanUtils::IsDataValid(deviation)) {
-				
-					if (TwoCanUtils::IsDataValid(variation)) {
-						// heading, deviation and variation all valid
-						nmeaSentences->push_back(wxString::Format("$IIHDG,%.2f,%.2f,%c,%.2f,%c", RADIANS_TO_DEGREES((float)heading / 10000), \
-							RADIANS_TO_DEGREES((float)deviation / 10000), deviation >= 0 ? 'E' : 'W', \
-							RADIANS_TO_DEGREES((float)variation / 10000), variation >= 0 ? 'E' : 'W'));
-						return TRUE;
-					}
-				
-					else {
-						// heading, deviation are valid, variation invalid
-						nmeaSentences->push_back(wxString::Format("$IIHDG,%.2f,%.2f,%c,,", RADIANS_TO_DEGREES((float)heading / 10000), \
-							RADIANS_TO_DEGREES((float)deviation / 10000), deviation >= 0 ? 'E' : 'W'));
-						return TRUE;
-					}
+				if (TwoCanUtils::IsDataValid(heading.variation)) {
+					// heading, deviation and variation all valid
+					nmeaSentences->push_back(wxString::Format("$IIHDG,%.2f,%.2f,%c,%.2f,%c", RADIANS_TO_DEGREES((float)heading.heading / 10000), \
+						RADIANS_TO_DEGREES((float)heading.deviation / 10000), heading.deviation >= 0 ? 'E' : 'W', \
+						RADIANS_TO_DEGREES((float)heading.variation / 10000), heading.variation >= 0 ? 'E' : 'W'));
+					return TRUE;
 				}
-				
+			
 				else {
-					if (TwoCanUtils::IsDataValid(variation)) {
-						// heading and variation valid, deviation invalid
-						nmeaSentences->push_back(wxString::Format("$IIHDG,%.2f,,,%.2f,%c", RADIANS_TO_DEGREES((float)heading / 10000), \
-							RADIANS_TO_DEGREES((float)variation / 10000), variation >= 0 ? 'E' : 'W'));
-						return TRUE;
-					}
-					else {
-						// heading valid, deviation and variation both invalid
-						nmeaSentences->push_back(wxString::Format("$IIHDG,%.2f,,,,", RADIANS_TO_DEGREES((float)heading / 10000)));
-						return TRUE;
-		
-					}	
-					
+					// heading, deviation are valid, variation invalid
+					nmeaSentences->push_back(wxString::Format("$IIHDG,%.2f,%.2f,%c,,", RADIANS_TO_DEGREES((float)heading.heading / 10000), \
+						RADIANS_TO_DEGREES((float)heading.deviation / 10000), heading.deviation >= 0 ? 'E' : 'W'));
+					return TRUE;
 				}
-			
 			}
+			
 			else {
-				return FALSE;
+				if (TwoCanUtils::IsDataValid(heading.variation)) {
+					// heading and variation valid, deviation invalid
+					nmeaSentences->push_back(wxString::Format("$IIHDG,%.2f,,,%.2f,%c", RADIANS_TO_DEGREES((float)heading.heading / 10000), \
+						RADIANS_TO_DEGREES((float)heading.variation / 10000), heading.variation >= 0 ? 'E' : 'W'));
+					return TRUE;
+				}
+				else {
+					// heading valid, deviation and variation both invalid
+					nmeaSentences->push_back(wxString::Format("$IIHDG,%.2f,,,,", RADIANS_TO_DEGREES((float)heading.heading / 10000)));
+					return TRUE;
+				}	
 			}
 		}
-		else if (headingReference == HEADING_TRUE) {
-			if (TwoCanUtils::IsDataValid(heading)) {
-				nmeaSentences->push_back(wxString::Format("$IIHDT,%.2f", RADIANS_TO_DEGREES((float)heading / 10000)));
-				return TRUE;
-			}
-			else {
-				return FALSE;
-			}
-			
+		else {
+			return FALSE;
+		}
+	}
+	else if (heading.reference == HEADING_TRUE) {
+		if (TwoCanUtils::IsDataValid(heading.heading)) {
+			nmeaSentences->push_back(wxString::Format("$IIHDT,%.2f", RADIANS_TO_DEGREES((float)heading.heading / 10000)));
+			return TRUE;
 		}
 		else {
 			return FALSE;
 		}
-		
 	}
 	else {
 		return FALSE;
@@ -1096,6 +1811,7 @@ bool ActisenseDevice::DecodePGN127250(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 127251 NMEA Rate of Turn (ROT)
 // $--ROT,x.x,A*hh<CR><LF>
 bool ActisenseDevice::DecodePGN127251(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte sid;
@@ -1132,6 +1848,7 @@ bool ActisenseDevice::DecodePGN127251(std::vector<byte> payload, std::vector<wxS
 // Yaw, Pitch & Roll - Transducer type is A (Angular displacement), Units of measure is D (degrees)
 
 bool ActisenseDevice::DecodePGN127257(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte sid;
@@ -1162,7 +1879,7 @@ bool ActisenseDevice::DecodePGN127257(std::vector<byte> payload, std::vector<wxS
 		}
 
 		if (xdrString.length() > 0) {
-			xdrString.Prepend("IIXDR,");
+			xdrString.Prepend("$IIXDR,");
 			nmeaSentences->push_back(xdrString);
 			return TRUE;
 		}
@@ -1178,6 +1895,7 @@ bool ActisenseDevice::DecodePGN127257(std::vector<byte> payload, std::vector<wxS
 
 // Decode PGN 127258 NMEA Magnetic Variation
 bool ActisenseDevice::DecodePGN127258(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte sid;
@@ -1205,6 +1923,7 @@ bool ActisenseDevice::DecodePGN127258(std::vector<byte> payload, std::vector<wxS
 
 // Decode PGN 127488 NMEA Engine Parameters, Rapid Update
 bool ActisenseDevice::DecodePGN127488(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte engineInstance;
@@ -1292,6 +2011,7 @@ bool ActisenseDevice::DecodePGN127488(std::vector<byte> payload, std::vector<wxS
 
 // Decode PGN 127489 NMEA Engine Parameters, Dynamic
 bool ActisenseDevice::DecodePGN127489(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte engineInstance;
@@ -1407,6 +2127,7 @@ bool ActisenseDevice::DecodePGN127489(std::vector<byte> payload, std::vector<wxS
 
 // Decode PGN 127505 NMEA Fluid Levels
 bool ActisenseDevice::DecodePGN127505(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte instance;
@@ -1456,6 +2177,7 @@ bool ActisenseDevice::DecodePGN127505(std::vector<byte> payload, std::vector<wxS
 
 // Decode PGN 127508 NMEA Battery Status
 bool ActisenseDevice::DecodePGN127508(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte batteryInstance;
@@ -1499,6 +2221,7 @@ bool ActisenseDevice::DecodePGN127508(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 128259 NMEA Speed & Heading
 // $--VHW, x.x, T, x.x, M, x.x, N, x.x, K*hh<CR><LF>
 bool ActisenseDevice::DecodePGN128259(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte sid;
@@ -1530,6 +2253,7 @@ bool ActisenseDevice::DecodePGN128259(std::vector<byte> payload, std::vector<wxS
 // $--DPT,x.x,x.x,x.x*hh<CR><LF>
 // $--DBT,x.x,f,x.x,M,x.x,F*hh<CR><LF>
 bool ActisenseDevice::DecodePGN128267(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte sid;
@@ -1571,13 +2295,15 @@ bool ActisenseDevice::DecodePGN128267(std::vector<byte> payload, std::vector<wxS
 //          Ground distance since reset, Nm
 
 bool ActisenseDevice::DecodePGN128275(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
-	if (payload.size() > 0) {
+	ACTISENSE_PROFILE_FUNCTION();
+	// Date, time, log and trip log, 14 bytes
+	if (payload.size() >= 14) {
 
 		unsigned short daysSinceEpoch;
-		daysSinceEpoch = payload[1] | (payload[2] << 8);
+		daysSinceEpoch = payload[0] | (payload[1] << 8);
 
 		unsigned int secondsSinceMidnight;
-		secondsSinceMidnight = payload[3] | (payload[4] << 8) | (payload[5] << 16) | (payload[6] << 24);
+		secondsSinceMidnight = payload[2] | (payload[3] << 8) | (payload[4] << 16) | (payload[5] << 24);
 
 		wxDateTime tm;
 		tm.ParseDateTime("00:00:00 01-01-1970");
@@ -1585,10 +2311,10 @@ bool ActisenseDevice::DecodePGN128275(std::vector<byte> payload, std::vector<wxS
 		tm += wxTimeSpan::Seconds((wxLongLong)secondsSinceMidnight / 10000);
 
 		unsigned int cumulativeDistance;
-		cumulativeDistance = payload[7] | (payload[8] << 8) | (payload[9] << 16) | (payload[10] << 24);
+		cumulativeDistance = payload[6] | (payload[7] << 8) | (payload[8] << 16) | (payload[9] << 24);
 
 		unsigned int tripDistance;
-		tripDistance = payload[11] | (payload[12] << 8) | (payload[13] << 16) | (payload[14] << 24);
+		tripDistance = payload[10] | (payload[11] << 8) | (payload[12] << 16) | (payload[13] << 24);
 
 		if (TwoCanUtils::IsDataValid(cumulativeDistance)) {
 			if (TwoCanUtils::IsDataValid(tripDistance)) {
@@ -1617,234 +2343,104 @@ bool ActisenseDevice::DecodePGN128275(std::vector<byte> payload, std::vector<wxS
 	}
 }
 
-// Decode PGN 129025 NMEA Position Rapid Update
+// Format PGN 129025 NMEA Position Rapid Update
 // $--GLL, llll.ll, a, yyyyy.yy, a, hhmmss.ss, A, a*hh<CR><LF>
 //                                           Status A valid, V invalid
 //                                               mode - note Status = A if Mode is A (autonomous) or D (differential)
-bool ActisenseDevice::DecodePGN129025(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
-	if (payload.size() > 0) {
-		
-		int latitude;
-		latitude = (int)payload[0] | ((int)payload[1] << 8) | ((int)payload[2] << 16) | ((int)payload[3] << 24);
-
-		int longitude;
-		longitude = (int)payload[4] | ((int)payload[5] << 8) | ((int)payload[6] << 16) | ((int)payload[7] << 24);
+bool ActisenseDevice::FormatPosition(const Position& position, std::vector<wxString> *nmeaSentences) {
+	if (TwoCanUtils::IsDataValid(position.latitude) && TwoCanUtils::IsDataValid(position.longitude)) {
 
-		if (TwoCanUtils::IsDataValid(latitude) && TwoCanUtils::IsDataValid(longitude)) {
+		double latitudeDouble = ((double)position.latitude * 1e-7);
+		double latitudeDegrees = trunc(latitudeDouble);
+		double latitudeMinutes = (latitudeDouble - latitudeDegrees) * 60;
 
-			double latitudeDouble = ((double)latitude * 1e-7);
-			double latitudeDegrees = trunc(latitudeDouble);
-			double latitudeMinutes = (latitudeDouble - latitudeDegrees) * 60;
+		double longitudeDouble = ((double)position.longitude * 1e-7);
+		double longitudeDegrees = trunc(longitudeDouble);
+		double longitudeMinutes = (longitudeDouble - longitudeDegrees) * 60;
 
-			double longitudeDouble = ((double)longitude * 1e-7);
-			double longitudeDegrees = trunc(longitudeDouble);
-			double longitudeMinutes = (longitudeDouble - longitudeDegrees) * 60;
+		char gpsMode;
+		gpsMode = 'A';
 
-			char gpsMode;
-			gpsMode = 'A';
+		// BUG BUG Mode & Status are not available in PGN 129025
+		// BUG BUG UTC Time is not available in  PGN 129025
 
-			// BUG BUG Verify S & W values are indeed negative
-			// BUG BUG Mode & Status are not available in PGN 129025
-			// BUG BUG UTC Time is not available in  PGN 129025
-
-			wxDateTime tm;
-			tm = wxDateTime::Now();
+		wxDateTime tm;
+		tm = wxDateTime::Now();
 
-			nmeaSentences->push_back(wxString::Format("$IIGLL,%02.0f%07.4f,%c,%03.0f%07.4f,%c,%s,%c,%c", abs(latitudeDegrees), fabs(latitudeMinutes), latitude >= 0 ? 'N' : 'S', \
-				abs(longitudeDegrees), fabs(longitudeMinutes), longitude >= 0 ? 'E' : 'W', tm.Format("%H%M%S.00").ToAscii(), gpsMode, ((gpsMode == 'A') || (gpsMode == 'D')) ? 'A' : 'V'));
-			return TRUE;
-		}
-		else {
-			return FALSE;
-		}
+		nmeaSentences->push_back(wxString::Format("$IIGLL,%02.0f%07.4f,%c,%03.0f%07.4f,%c,%s,%c,%c", fabs(latitudeDegrees), fabs(latitudeMinutes), position.latitude >= 0 ? 'N' : 'S', \
+			fabs(longitudeDegrees), fabs(longitudeMinutes), position.longitude >= 0 ? 'E' : 'W', tm.Format("%H%M%S.00").ToAscii(), gpsMode, ((gpsMode == 'A') || (gpsMode == 'D')) ? 'A' : 'V'));
+		return TRUE;
 	}
 	else {
 		return FALSE;
 	}
 }
 
-// Decode PGN 129026 NMEA COG SOG Rapid Update
+// Format PGN 129026 NMEA COG SOG Rapid Update
 // $--VTG,x.x,T,x.x,M,x.x,N,x.x,K,a*hh<CR><LF>
-bool ActisenseDevice::DecodePGN129026(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
-	if (payload.size() > 0) {
-
-		byte sid;
-		sid = payload[0];
-
-		// True = 0, Magnetic = 1
-		byte headingReference;
-		headingReference = (payload[1] & 0x03);
-
-		unsigned short courseOverGround;
-		courseOverGround = (payload[2] | (payload[3] << 8));
-
-		unsigned short speedOverGround;
-		speedOverGround = (payload[4] | (payload[5] << 8));
+bool ActisenseDevice::FormatCourseOverGround(const CourseOverGround& course, std::vector<wxString> *nmeaSentences) {
+	// BUG BUG GPS Mode should be obtained rather than assumed
+	
+	// Course is either true (T) or magnetic (M)
+	if ((course.reference != HEADING_TRUE) && (course.reference != HEADING_MAGNETIC)) {
+		return FALSE;
+	}
 
-		// BUG BUG if Heading Ref = True (0), then ignore %.2f,M and vice versa if Heading Ref = Magnetic (1), ignore %.2f,T
-		// BUG BUG GPS Mode should be obtained rather than assumed
-		
-		if (headingReference == HEADING_TRUE) {
-			if (TwoCanUtils::IsDataValid(courseOverGround)) {
-				if (TwoCanUtils::IsDataValid(speedOverGround)) {
-					nmeaSentences->push_back(wxString::Format("$IIVTG,%.2f,T,,M,%.2f,N,%.2f,K,%c", RADIANS_TO_DEGREES((float)courseOverGround / 10000), \
-					(float)speedOverGround * CONVERT_MS_KNOTS / 100, (float)speedOverGround * CONVERT_MS_KMH / 100, GPS_MODE_AUTONOMOUS));
-					return TRUE;								
-				}
-				else {
-					nmeaSentences->push_back(wxString::Format("$IIVTG,%.2f,T,,M,,N,,K,%c", RADIANS_TO_DEGREES((float)courseOverGround / 10000), GPS_MODE_AUTONOMOUS));
-					return TRUE;								
-				}
-			}
-			else {
-				if (TwoCanUtils::IsDataValid(speedOverGround)) {
-					nmeaSentences->push_back(wxString::Format("$IIVTG,,T,,M,%.2f,N,%.2f,K,%c", \
-					(float)speedOverGround * CONVERT_MS_KNOTS / 100, (float)speedOverGround * CONVERT_MS_KMH / 100, GPS_MODE_AUTONOMOUS));
-					return TRUE;
-				}
-				else {
-					return FALSE;
-				}
-				
-			}
-			
-		}
-		
-		else if (headingReference == HEADING_MAGNETIC) {
-			if (TwoCanUtils::IsDataValid(courseOverGround)) {
-				if (TwoCanUtils::IsDataValid(speedOverGround)) {
-					nmeaSentences->push_back(wxString::Format("$IIVTG,,T,%.2f,M,%.2f,N,%.2f,K,%c", RADIANS_TO_DEGREES((float)courseOverGround / 10000), \
-					(float)speedOverGround * CONVERT_MS_KNOTS / 100, (float)speedOverGround * CONVERT_MS_KMH / 100, GPS_MODE_AUTONOMOUS));
-					return TRUE;								
-				}
-				else {
-					nmeaSentences->push_back(wxString::Format("$IIVTG,,T,%.2f,M,,N,,K,%c", RADIANS_TO_DEGREES((float)courseOverGround / 10000), GPS_MODE_AUTONOMOUS));
-					return TRUE;								
-				}
-			}
-			else {
-				if (TwoCanUtils::IsDataValid(speedOverGround)) {
-					nmeaSentences->push_back(wxString::Format("$IIVTG,,T,,M,%.2f,N,%.2f,K,%c", \
-					(float)speedOverGround * CONVERT_MS_KNOTS / 100, (float)speedOverGround * CONVERT_MS_KMH / 100, GPS_MODE_AUTONOMOUS));
-					return TRUE;
-				}
-				else {
-					return FALSE;
-				}
-				
-			}
-			
-			
+	wxString trueCourse;
+	wxString magneticCourse;
+	if (TwoCanUtils::IsDataValid(course.courseOverGround)) {
+		if (course.reference == HEADING_TRUE) {
+			trueCourse = wxString::Format("%.2f", RADIANS_TO_DEGREES((float)course.courseOverGround / 10000));
 		}
 		else {
-			return FALSE;
+			magneticCourse = wxString::Format("%.2f", RADIANS_TO_DEGREES((float)course.courseOverGround / 10000));
 		}
 	}
+
+	if (TwoCanUtils::IsDataValid(course.speedOverGround)) {
+		nmeaSentences->push_back(wxString::Format("$IIVTG,%s,T,%s,M,%.2f,N,%.2f,K,%c", trueCourse, magneticCourse, \
+			(float)course.speedOverGround * CONVERT_MS_KNOTS / 100, (float)course.speedOverGround * CONVERT_MS_KMH / 100, GPS_MODE_AUTONOMOUS));
+		return TRUE;
+	}
+	else if (TwoCanUtils::IsDataValid(course.courseOverGround)) {
+		nmeaSentences->push_back(wxString::Format("$IIVTG,%s,T,%s,M,,N,,K,%c", trueCourse, magneticCourse, GPS_MODE_AUTONOMOUS));
+		return TRUE;
+	}
 	else {
 		return FALSE;
-	}	
+	}
 }
 
-// Decode PGN 129029 NMEA GNSS Position
+// Format PGN 129029 NMEA GNSS Position
 // $--GGA, hhmmss.ss, llll.ll, a, yyyyy.yy, a, x, xx, x.x, x.x, M, x.x, M, x.x, xxxx*hh<CR><LF>
 //                                             |  |   hdop         geoidal  age refID 
 //                                             |  |        Alt
 //                                             | sats
 //                                           fix Qualty
 
-bool ActisenseDevice::DecodePGN129029(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
-	if (payload.size() > 0) {
-
-		byte sid;
-		sid = payload[0];
-
-		unsigned short daysSinceEpoch;
-		daysSinceEpoch = payload[1] | (payload[2] << 8);
-
-		unsigned int secondsSinceMidnight;
-		secondsSinceMidnight = payload[3] | (payload[4] << 8) | (payload[5] << 16) | (payload[6] << 24);
+bool ActisenseDevice::FormatGnssFix(const GnssFix& gnssFix, std::vector<wxString> *nmeaSentences) {
+	if (TwoCanUtils::IsDataValid(gnssFix.latitude) && TwoCanUtils::IsDataValid(gnssFix.longitude)) {
 
 		wxDateTime tm;
 		tm.ParseDateTime("00:00:00 01-01-1970");
-		tm += wxDateSpan::Days(daysSinceEpoch);
-		tm += wxTimeSpan::Seconds((wxLongLong)secondsSinceMidnight / 10000);
-
-		long long latitude;
-		latitude = (((long long)payload[7] | ((long long)payload[8] << 8) | ((long long)payload[9] << 16) | ((long long)payload[10] << 24) \
-			| ((long long)payload[11] << 32) | ((long long)payload[12] << 40) | ((long long)payload[13] << 48) | ((long long)payload[14] << 56)));
-
-
-		long long longitude;
-		longitude = (((long long)payload[15] | ((long long)payload[16] << 8) | ((long long)payload[17] << 16) | ((long long)payload[18] << 24) \
-			| ((long long)payload[19] << 32) | ((long long)payload[20] << 40) | ((long long)payload[21] << 48) | ((long long)payload[22] << 56)));
-
-		if (TwoCanUtils::IsDataValid(latitude) && TwoCanUtils::IsDataValid(longitude)) {
-
-			double latitudeDouble = ((double)latitude * 1e-16);
-			double latitudeDegrees = trunc(latitudeDouble);
-			double latitudeMinutes = (latitudeDouble - latitudeDegrees) * 60;
-
-			double longitudeDouble = ((double)longitude * 1e-16);
-			double longitudeDegrees = trunc(longitudeDouble);
-			double longitudeMinutes = (longitudeDouble - longitudeDegrees) * 60;
-
-			double altitude;
-			altitude = 1e-6 * (((long long)payload[23] | ((long long)payload[24] << 8) | ((long long)payload[25] << 16) | ((long long)payload[26] << 24) \
-				| ((long long)payload[27] << 32) | ((long long)payload[28] << 40) | ((long long)payload[29] << 48) | ((long long)payload[30] << 56)));
-
-
-			byte fixType;
-			byte fixMethod;
-
-			fixType = (payload[31] & 0xF0) >> 4;
-			fixMethod = payload[31] & 0x0F;
-
-			byte fixIntegrity;
-			fixIntegrity = payload[32] & 0x03;
-
-			byte numberOfSatellites;
-			numberOfSatellites = payload[33];
-
-			unsigned short hDOP;
-			hDOP = payload[34] | (payload[35] << 8);
-
-			unsigned short pDOP;
-			pDOP = payload[36] | (payload[37] << 8);
-
-			unsigned long geoidalSeparation; //0.01
-			geoidalSeparation = payload[38] | (payload[39] << 8);
-
-			byte referenceStations;
-			referenceStations = payload[40];
-
-			unsigned short referenceStationType;
-			unsigned short referenceStationID;
-			unsigned short referenceStationAge;
-
-			// We only need one reference station for the GGA sentence
-			if (referenceStations != 0xFF && referenceStations > 0) {
-				// BUG BUG Check this, may have bit orders wrong
-				referenceStationType = payload[43] & 0xF0 >> 4;
-				referenceStationID = (payload[43] & 0xF) << 4 | payload[44];
-				referenceStationAge = (payload[45] | (payload[46] << 8));
-			}
-
-			nmeaSentences->push_back(wxString::Format("$IIGGA,%s,%02.0f%07.4f,%c,%03.0f%07.4f,%c,%d,%d,%.2f,%.1f,M,%.1f,M,,", \
-				tm.Format("%H%M%S").ToAscii(), fabs(latitudeDegrees), fabs(latitudeMinutes), latitudeDegrees >= 0 ? 'N' : 'S', \
-				fabs(longitudeDegrees), fabs(longitudeMinutes), longitudeDegrees >= 0 ? 'E' : 'W', \
-				fixType, numberOfSatellites, (double)hDOP * 0.01f, (double)altitude * 1e-6, \
-				(double)geoidalSeparation * 0.01f));
-			return TRUE;
-
-			// BUG BUG for the time being ignore reference stations, too lazy to code this
-			//, \
-			//	((referenceStations != 0xFF) && (referenceStations > 0)) ? referenceStationAge : "", \
-			//	((referenceStations != 0xFF) && (referenceStations > 0)) ? referenceStationID : "");
-			//
-		}
-		else {
-			return FALSE;
-		}
+		tm += wxDateSpan::Days(gnssFix.daysSinceEpoch);
+		tm += wxTimeSpan::Seconds((wxLongLong)gnssFix.secondsSinceMidnight / 10000);
+
+		double latitudeDouble = ((double)gnssFix.latitude * 1e-16);
+		double latitudeDegrees = trunc(latitudeDouble);
+		double latitudeMinutes = (latitudeDouble - latitudeDegrees) * 60;
+
+		double longitudeDouble = ((double)gnssFix.longitude * 1e-16);
+		double longitudeDegrees = trunc(longitudeDouble);
+		double longitudeMinutes = (longitudeDouble - longitudeDegrees) * 60;
+
+		// BUG BUG for the time being ignore reference stations, age and id of the differential corrections
+		nmeaSentences->push_back(wxString::Format("$IIGGA,%s,%02.0f%07.4f,%c,%03.0f%07.4f,%c,%d,%d,%.2f,%.1f,M,%.1f,M,,", \
+			tm.Format("%H%M%S").ToAscii(), fabs(latitudeDegrees), fabs(latitudeMinutes), latitudeDegrees >= 0 ? 'N' : 'S', \
+			fabs(longitudeDegrees), fabs(longitudeMinutes), longitudeDegrees >= 0 ? 'E' : 'W', \
+			gnssFix.fixMethod, gnssFix.numberOfSatellites, (double)gnssFix.hDOP * 0.01f, (double)gnssFix.altitude * 1e-6, \
+			(double)gnssFix.geoidalSeparation * 0.01f));
+		return TRUE;
 	}
 	else {
 		return FALSE;
@@ -1854,6 +2450,7 @@ bool ActisenseDevice::DecodePGN129029(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 129033 NMEA Date & Time
 // $--ZDA, hhmmss.ss, xx, xx, xxxx, xx, xx*hh<CR><LF>
 bool ActisenseDevice::DecodePGN129033(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 		unsigned short daysSinceEpoch;
 		daysSinceEpoch = payload[0] | (payload[1] << 8);
@@ -1887,134 +2484,69 @@ bool ActisenseDevice::DecodePGN129033(std::vector<byte> payload, std::vector<wxS
 //      Total Number of sentences
 
 
-// Decode PGN 129038 NMEA AIS Class A Position Report
+// Format PGN 129038 NMEA AIS Class A Position Report
 // AIS Message Types 1,2 or 3
-bool ActisenseDevice::DecodePGN129038(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
-	if (payload.size() > 0) {
-
-		std::vector<bool> binaryData(168);
-
-		int messageID;
-		messageID = payload[0] & 0x3F;
-
-		int repeatIndicator;
-		repeatIndicator = (payload[0] & 0xC0) >> 6;
-
-		int userID; // aka sender's MMSI
-		userID = payload[1] | (payload[2] << 8) | (payload[3] << 16) | (payload[4] << 24);
-
-		double longitude;
-		longitude = ((payload[5] | (payload[6] << 8) | (payload[7] << 16) | (payload[8] << 24))) * 1e-7;
-
-		int longitudeDegrees = trunc(longitude);
-		double longitudeMinutes = fabs((longitude - longitudeDegrees) * 60);
-
-		double latitude;
-		latitude = ((payload[9] | (payload[10] << 8) | (payload[11] << 16) | (payload[12] << 24))) * 1e-7;
-
-		int latitudeDegrees = trunc(latitude);
-		double latitudeMinutes = fabs((latitude - latitudeDegrees) * 60);
-
-		int positionAccuracy;
-		positionAccuracy = payload[13] & 0x01;
-
-		int raimFlag;
-		raimFlag = (payload[13] & 0x02) >> 1;
-
-		int timeStamp;
-		timeStamp = (payload[13] & 0xFC) >> 2;
-
-		int courseOverGround;
-		courseOverGround = payload[14] | (payload[15] << 8);
-
-		int speedOverGround;
-		speedOverGround = payload[16] | (payload[17] << 8);
-
-		int communicationState;
-		communicationState = (payload[18] | (payload[19] << 8) | (payload[20] << 16) & 0x7FFFF);
-
-		int transceiverInformation; // unused in NMEA183 conversion
-		transceiverInformation = (payload[20] & 0xF8) >> 3;
-
-		int trueHeading;
-		trueHeading = payload[21] | (payload[22] << 8);
-
-		int rateOfTurn;
-		rateOfTurn = payload[23] | (payload[24] << 8);
-
-		int navigationalStatus;
-		navigationalStatus = payload[25] & 0x0F;
-		
-		int reserved;
-		reserved = payload[25] & 0x30 >> 4;
-
-		int manoeuverIndicator;
-		manoeuverIndicator = (payload[25] & 0xC0) >> 6;
-
-		int spare;
-		spare = (payload[26] & 0x07);
-
-		int reservedForRegionalApplications;
-		reservedForRegionalApplications = (payload[26] & 0xF8) >> 3;
+bool ActisenseDevice::FormatAisClassAReport(const AisClassAReport& report, std::vector<wxString> *nmeaSentences) {
+	std::vector<bool> binaryData(168);
 
-		int sequenceID;
-		sequenceID = (payload[26] & 0xC0) >> 6;
+	double longitude = report.longitude * 1e-7;
+	int longitudeDegrees = trunc(longitude);
+	double longitudeMinutes = fabs((longitude - longitudeDegrees) * 60);
 
-		// Encode correct AIS rate of turn from sensor data as per ITU M.1371 standard
-		// BUG BUG fix this up to remove multiple calculations. 
-		int AISRateOfTurn;
+	double latitude = report.latitude * 1e-7;
+	int latitudeDegrees = trunc(latitude);
+	double latitudeMinutes = fabs((latitude - latitudeDegrees) * 60);
 
-		// Undefined/not available
-		if (rateOfTurn == 0xFFFF) {
-			AISRateOfTurn = -128;
-		}
-		// Greater or less than 708 degrees/min
-		else if ((RADIANS_TO_DEGREES((float)rateOfTurn * 3.125e-8) * 60) > 708) {
-			AISRateOfTurn = 127;
-		}
-
-		else if ((RADIANS_TO_DEGREES((float)rateOfTurn * 3.125e-8) * 60) < -708) {
-			AISRateOfTurn = -127;
-		}
-
-		else {
-			AISRateOfTurn = 4.733 * sqrt(RADIANS_TO_DEGREES((float)rateOfTurn * 3.125e-8) * 60);
-		}
-
-
-		// Encode VDM message using 6 bit ASCII 
-
-		AISInsertInteger(binaryData, 0, 6, messageID);
-		AISInsertInteger(binaryData, 6, 2, repeatIndicator);
-		AISInsertInteger(binaryData, 8, 30, userID);
-		AISInsertInteger(binaryData, 38, 4, navigationalStatus);
-		AISInsertInteger(binaryData, 42, 8, AISRateOfTurn);
-		AISInsertInteger(binaryData, 50, 10, CONVERT_MS_KNOTS * speedOverGround * 0.1f);
-		AISInsertInteger(binaryData, 60, 1, positionAccuracy);
-		AISInsertInteger(binaryData, 61, 28, ((longitudeDegrees * 60) + longitudeMinutes) * 10000);
-		AISInsertInteger(binaryData, 89, 27, ((latitudeDegrees * 60) + latitudeMinutes) * 10000);
-		AISInsertInteger(binaryData, 116, 12, RADIANS_TO_DEGREES((float)courseOverGround) * 0.001f);
-		AISInsertInteger(binaryData, 128, 9, RADIANS_TO_DEGREES((float)trueHeading) * 0.0001f);
-		AISInsertInteger(binaryData, 137, 6, timeStamp);
-		AISInsertInteger(binaryData, 143, 2, manoeuverIndicator);
-		AISInsertInteger(binaryData, 145, 3, spare);
-		AISInsertInteger(binaryData, 148, 1, raimFlag);
-		AISInsertInteger(binaryData, 149, 19, communicationState);
+	// Encode correct AIS rate of turn from sensor data as per ITU M.1371 standard
+	// BUG BUG fix this up to remove multiple calculations. 
+	int AISRateOfTurn;
 
-		// Send a single VDM sentence, note no fillbits nor a sequential message Id
-		nmeaSentences->push_back(wxString::Format("!AIVDM,1,1,,A,%s,0", AISEncodePayload(binaryData)));
+	// Undefined/not available
+	if (report.rateOfTurn == 0xFFFF) {
+		AISRateOfTurn = -128;
+	}
+	// Greater or less than 708 degrees/min
+	else if ((RADIANS_TO_DEGREES((float)report.rateOfTurn * 3.125e-8) * 60) > 708) {
+		AISRateOfTurn = 127;
+	}
 
-		return TRUE;
+	else if ((RADIANS_TO_DEGREES((float)report.rateOfTurn * 3.125e-8) * 60) < -708) {
+		AISRateOfTurn = -127;
 	}
 
 	else {
-		return FALSE;
+		AISRateOfTurn = 4.733 * sqrt(RADIANS_TO_DEGREES((float)report.rateOfTurn * 3.125e-8) * 60);
 	}
+
+	// Encode VDM message using 6 bit ASCII 
+
+	AISInsertInteger(binaryData, 0, 6, report.messageId);
+	AISInsertInteger(binaryData, 6, 2, report.repeatIndicator);
+	AISInsertInteger(binaryData, 8, 30, report.userId);
+	AISInsertInteger(binaryData, 38, 4, report.navigationalStatus);
+	AISInsertInteger(binaryData, 42, 8, AISRateOfTurn);
+	AISInsertInteger(binaryData, 50, 10, CONVERT_MS_KNOTS * report.speedOverGround * 0.1f);
+	AISInsertInteger(binaryData, 60, 1, report.positionAccuracy);
+	AISInsertInteger(binaryData, 61, 28, ((longitudeDegrees * 60) + longitudeMinutes) * 10000);
+	AISInsertInteger(binaryData, 89, 27, ((latitudeDegrees * 60) + latitudeMinutes) * 10000);
+	AISInsertInteger(binaryData, 116, 12, RADIANS_TO_DEGREES((float)report.courseOverGround) * 0.001f);
+	AISInsertInteger(binaryData, 128, 9, RADIANS_TO_DEGREES((float)report.trueHeading) * 0.0001f);
+	AISInsertInteger(binaryData, 137, 6, report.timeStamp);
+	AISInsertInteger(binaryData, 143, 2, report.manoeuverIndicator);
+	AISInsertInteger(binaryData, 145, 3, report.spare);
+	AISInsertInteger(binaryData, 148, 1, report.raimFlag);
+	AISInsertInteger(binaryData, 149, 19, report.communicationState);
+
+	// Send a single VDM sentence, note no fillbits nor a sequential message Id
+	nmeaSentences->push_back(wxString::Format("!AIVDM,1,1,,A,%s,0", AISEncodePayload(binaryData)));
+
+	return TRUE;
 }
 
 // Decode PGN 129039 NMEA AIS Class B Position Report
 // AIS Message Type 18
 bool ActisenseDevice::DecodePGN129039(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		std::vector<bool> binaryData(168);
@@ -2129,6 +2661,7 @@ bool ActisenseDevice::DecodePGN129039(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 129040 AIS Class B Extended Position Report
 // AIS Message Type 19
 bool ActisenseDevice::DecodePGN129040(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		std::vector<bool> binaryData(312);
@@ -2277,7 +2810,9 @@ bool ActisenseDevice::DecodePGN129040(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 129041 AIS Aids To Navigation (AToN) Report
 // AIS Message Type 21
 bool ActisenseDevice::DecodePGN129041(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
-	if (payload.size() > 0) {
+	ACTISENSE_PROFILE_FUNCTION();
+	// Fixed fields followed by at least the name's length and encoding
+	if (payload.size() >= 28) {
 
 		std::vector<bool> binaryData(358);
 
@@ -2355,9 +2890,10 @@ bool ActisenseDevice::DecodePGN129041(std::vector<byte> payload, std::vector<wxS
 
 		// BUG BUG This is variable up to 20 + 14 (34) characters
 		std::string AToNName;
+		// The length includes itself and the encoding byte, and is checked so that a malformed name is not read beyond the payload
 		int AToNNameLength = payload[26];
-		if (payload[27] == 1) { // First byte indicates encoding, 0 for Unicode, 1 for ASCII
-			for (int i = 0; i < AToNNameLength - 1; i++) {
+		if ((payload[27] == 1) && ((size_t)(26 + AToNNameLength) <= payload.size())) { // First byte indicates encoding, 0 for Unicode, 1 for ASCII
+			for (int i = 0; i < AToNNameLength - 2; i++) {
 				AToNName += static_cast<char>(payload[28 + i]);
 			}
 		} 
@@ -2434,6 +2970,7 @@ bool ActisenseDevice::DecodePGN129041(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 129283 NMEA Cross Track Error
 // $--XTE, A, A, x.x, a, N, a*hh<CR><LF>
 bool ActisenseDevice::DecodePGN129283(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte sid;
@@ -2470,6 +3007,7 @@ bool ActisenseDevice::DecodePGN129283(std::vector<byte> payload, std::vector<wxS
 
 // Not sure of this use case, as it implies there is already a chartplotter on board
 bool ActisenseDevice::DecodePGN129284(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 		byte sid;
 		sid = payload[0];
@@ -2599,6 +3137,7 @@ bool ActisenseDevice::DecodePGN129284(std::vector<byte> payload, std::vector<wxS
 // and 
 // $--WPL,llll.ll,a,yyyyy.yy,a,c--c
 bool ActisenseDevice::DecodePGN129285(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 		// BUG BUG, Should calculate how many sentences to send based on the number of waypoints
 		// rather than just assuming a single sentence.
@@ -2695,6 +3234,7 @@ bool ActisenseDevice::DecodePGN129285(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 129793 AIS Date and Time report
 // AIS Message Type 4 and if date is present also Message Type 11
 bool ActisenseDevice::DecodePGN129793(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		std::vector<bool> binaryData(168);
@@ -2796,6 +3336,7 @@ bool ActisenseDevice::DecodePGN129793(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 129794 NMEA AIS Class A Static and Voyage Related Data
 // AIS Message Type 5
 bool ActisenseDevice::DecodePGN129794(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		std::vector<bool> binaryData(426,0);
@@ -2914,6 +3455,7 @@ bool ActisenseDevice::DecodePGN129794(std::vector<byte> payload, std::vector<wxS
 //	Decode PGN 129798 AIS SAR Aircraft Position Report
 // AIS Message Type 9
 bool ActisenseDevice::DecodePGN129798(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		std::vector<bool> binaryData(168);
@@ -3021,6 +3563,7 @@ bool ActisenseDevice::DecodePGN129798(std::vector<byte> payload, std::vector<wxS
 //	Decode PGN 129801 AIS Addressed Safety Related Message
 // AIS Message Type 12
 bool ActisenseDevice::DecodePGN129801(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		std::vector<bool> binaryData(1008);
@@ -3111,6 +3654,7 @@ bool ActisenseDevice::DecodePGN129801(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 129802 AIS Broadcast Safety Related Message 
 // AIS Message Type 14
 bool ActisenseDevice::DecodePGN129802(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		std::vector<bool> binaryData(1008);
@@ -3208,6 +3752,7 @@ bool ActisenseDevice::DecodePGN129802(std::vector<byte> payload, std::vector<wxS
 // $--DSE
 
 bool ActisenseDevice::DecodePGN129808(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte formatSpecifier;
@@ -3216,8 +3761,9 @@ bool ActisenseDevice::DecodePGN129808(std::vector<byte> payload, std::vector<wxS
 		byte dscCategory;
 		dscCategory = payload[1];
 
-		char mmsiAddress[5];
-		sprintf(mmsiAddress, "%02d%02d%02d%02d%02d", payload[2], payload[3], payload[4], payload[5], payload[6]);
+		// Five bytes of up to three digits each, plus the terminator
+		char mmsiAddress[16];
+		snprintf(mmsiAddress, sizeof(mmsiAddress), "%02d%02d%02d%02d%02d", payload[2], payload[3], payload[4], payload[5], payload[6]);
 
 		byte firstTeleCommand; // or Nature of Distress
 		firstTeleCommand = payload[7];
@@ -3254,8 +3800,9 @@ bool ActisenseDevice::DecodePGN129808(std::vector<byte> payload, std::vector<wxS
 		secondsSinceMidnight = payload[2] | (payload[3] << 8) | (payload[4] << 16) | (payload[5] << 24);
 
 		// note payload index.....
-		char vesselInDistress[5];
-		sprintf(vesselInDistress, "%02d%02d%02d%02d%02d", payload[2], payload[3], payload[4], payload[5], payload[6]);
+		// Five bytes of up to three digits each, plus the terminator
+		char vesselInDistress[16];
+		snprintf(vesselInDistress, sizeof(vesselInDistress), "%02d%02d%02d%02d%02d", payload[2], payload[3], payload[4], payload[5], payload[6]);
 
 		byte endOfSequence;
 		endOfSequence = payload[101]; // 1 byte
@@ -3328,6 +3875,7 @@ bool ActisenseDevice::DecodePGN129808(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 129809 AIS Class B Static Data Report, Part A 
 // AIS Message Type 24, Part A
 bool ActisenseDevice::DecodePGN129809(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 		
 		std::vector<bool> binaryData(164);
@@ -3374,6 +3922,7 @@ bool ActisenseDevice::DecodePGN129809(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 129810 AIS Class B Static Data Report, Part B 
 // AIS Message Type 24, Part B
 bool ActisenseDevice::DecodePGN129810(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		std::vector<bool> binaryData(168);
@@ -3449,6 +3998,7 @@ bool ActisenseDevice::DecodePGN129810(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 130306 NMEA Wind
 // $--MWV,x.x,a,x.x,a,A*hh<CR><LF>
 bool ActisenseDevice::DecodePGN130306(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte sid;
@@ -3496,6 +4046,7 @@ bool ActisenseDevice::DecodePGN130306(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 130310 NMEA Water & Air Temperature and Pressure
 // $--MTW,x.x,C*hh<CR><LF>
 bool ActisenseDevice::DecodePGN130310(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte sid;
@@ -3526,6 +4077,7 @@ bool ActisenseDevice::DecodePGN130310(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 130311 NMEA Environment  (supercedes 130311)
 // $--MTW,x.x,C*hh<CR><LF>
 bool ActisenseDevice::DecodePGN130311(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte sid;
@@ -3564,6 +4116,7 @@ bool ActisenseDevice::DecodePGN130311(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 130312 NMEA Temperature
 // $--MTW,x.x,C*hh<CR><LF>
 bool ActisenseDevice::DecodePGN130312(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte sid;
@@ -3597,6 +4150,7 @@ bool ActisenseDevice::DecodePGN130312(std::vector<byte> payload, std::vector<wxS
 // Decode PGN 130316 NMEA Temperature Extended Range
 // $--MTW,x.x,C*hh<CR><LF>
 bool ActisenseDevice::DecodePGN130316(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
+	ACTISENSE_PROFILE_FUNCTION();
 	if (payload.size() > 0) {
 
 		byte sid;
@@ -3629,9 +4183,10 @@ bool ActisenseDevice::DecodePGN130316(std::vector<byte> payload, std::vector<wxS
 
 
 // Decode PGN 130577 NMEA Direction Data
-// BUG BUG Work out what to convert this to
+// Only the course & speed over ground are converted, to VTG, the lower ranked alternative to 129026
 bool ActisenseDevice::DecodePGN130577(std::vector<byte> payload, std::vector<wxString> *nmeaSentences) {
-	if (payload.size() > 0) {
+	ACTISENSE_PROFILE_FUNCTION();
+	if (payload.size() >= 14) {
 
 		// 0 - Autonomous, 1 - Differential enhanced, 2 - Estimated, 3 - Simulated, 4 - Manual
 		byte dataMode;
@@ -3663,6 +4218,10 @@ bool ActisenseDevice::DecodePGN130577(std::vector<byte> payload, std::vector<wxS
 		drift = (payload[12] | (payload[13] << 8));
 
 
+		if ((!TwoCanUtils::IsDataValid(courseOverGround)) || (!TwoCanUtils::IsDataValid(speedOverGround))) {
+			return FALSE;
+		}
+
 		nmeaSentences->push_back(wxString::Format("$IIVTG,%.2f,T,%.2f,M,%.2f,N,%.2f,K,%c", RADIANS_TO_DEGREES((float)courseOverGround / 10000), \
 			RADIANS_TO_DEGREES((float)courseOverGround / 10000), (float)speedOverGround * CONVERT_MS_KNOTS / 100, \
 			(float)speedOverGround * CONVERT_MS_KMH / 100, GPS_MODE_AUTONOMOUS));
@@ -3690,11 +4249,11 @@ int ActisenseDevice::SendISORequest(const byte destination, const unsigned int p
 	payload[2] = (pgn >> 16) & 0xFF;
 	
 #ifdef __WXMSW__
-	return (deviceInterface->Write(id, 3, payload));
+	return (TransmitFrame(id, 3, payload));
 #endif
 	
 #ifdef __LINUX__
-	return (deviceInterface->Write(id,3,payload));
+	return (TransmitFrame(id,3,payload));
 #endif
 }
 
@@ -3726,20 +4285,23 @@ int ActisenseDevice::SendAddressClaim(const unsigned int sourceAddress) {
 	payload[6] = deviceClass << 1;
 	payload[7] = 0x80 | (CONST_MARINE_INDUSTRY << 4) | systemInstance;
 
-	// Add my entry to the network map
-	networkMap[header.source].manufacturerId = manufacturerCode;
-	networkMap[header.source].uniqueId = uniqueId;
-	// BUG BUG What to do for my time stamp ??
-
 	// And while we're at it, calculate my deviceName (aka NMEA 'NAME')
-	deviceName = (unsigned long long)payload[0] | ((unsigned long long)payload[1] << 8) | ((unsigned long long)payload[2] << 16) | ((unsigned long long)payload[3] << 24) | ((unsigned long long)payload[4] << 32) | ((unsigned long long)payload[5] << 40) | ((unsigned long long)payload[6] << 48) | ((unsigned long long)payload[7] << 54);
+	deviceName = (unsigned long long)payload[0] | ((unsigned long long)payload[1] << 8) | ((unsigned long long)payload[2] << 16) | ((unsigned long long)payload[3] << 24) | ((unsigned long long)payload[4] << 32) | ((unsigned long long)payload[5] << 40) | ((unsigned long long)payload[6] << 48) | ((unsigned long long)payload[7] << 56);
+
+	// Add my entry to the network map
+	// We don't receive our own frames, so our entry is never marked as seen
+	DeviceInformation myDeviceInformation = {};
+	myDeviceInformation.uniqueId = uniqueId;
+	myDeviceInformation.manufacturerId = manufacturerCode;
+	myDeviceInformation.deviceName = deviceName;
+	networkMap.UpdateAddressClaim(header.source, &myDeviceInformation);
 	
 #ifdef __WXMSW__
-	return (deviceInterface->Write(id, CONST_PAYLOAD_LENGTH, &payload[0]));
+	return (TransmitFrame(id, CONST_PAYLOAD_LENGTH, &payload[0]));
 #endif
 	
 #ifdef __LINUX__
-	return (deviceInterface->Write(id,CONST_PAYLOAD_LENGTH,&payload[0]));
+	return (TransmitFrame(id,CONST_PAYLOAD_LENGTH,&payload[0]));
 #endif
 }
 
@@ -3774,11 +4336,11 @@ int ActisenseDevice::SendHeartbeat() {
 	}
 	
 #ifdef __WXMSW__
-	return (deviceInterface->Write(id, CONST_PAYLOAD_LENGTH, &payload[0]));
+	return (TransmitFrame(id, CONST_PAYLOAD_LENGTH, &payload[0]));
 #endif
 
 #ifdef __LINUX__
-	return (deviceInterface->Write(id, CONST_PAYLOAD_LENGTH, &payload[0]));
+	return (TransmitFrame(id, CONST_PAYLOAD_LENGTH, &payload[0]));
 #endif
 
 }
@@ -3825,10 +4387,18 @@ int ActisenseDevice::SendProductInformation() {
 	
 	payload[133] = CONST_LOAD_EQUIVALENCY;
 
-	wxString *mid;
-	mid = new wxString(CONST_MODEL_ID);
-		
-	strcpy(networkMap[header.source].productInformation.modelId,mid->c_str());
+	// Add my product information to the network map
+	ProductInformation myProductInformation = {};
+	myProductInformation.dataBaseVersion = CONST_DATABASE_VERSION;
+	myProductInformation.productCode = CONST_PRODUCT_CODE;
+	strncpy(myProductInformation.modelId, hwVersion, 32);
+	strncpy(myProductInformation.softwareVersion, swVersion, 32);
+	strncpy(myProductInformation.modelVersion, hwVersion, 32);
+	strncpy(myProductInformation.serialNumber, tmp.c_str(), 32);
+	myProductInformation.certificationLevel = CONST_CERTIFICATION_LEVEL;
+	myProductInformation.loadEquivalency = CONST_LOAD_EQUIVALENCY;
+	networkMap.UpdateProductInformation(header.source, &myProductInformation);
+
 	return FragmentFastMessage(&header,sizeof(payload),&payload[0]);
 
 }
@@ -3906,23 +4476,107 @@ int ActisenseDevice::SendISOResponse(unsigned int sender, unsigned int pgn) {
 	payload[7] = (pgn >> 16) & 0xFF;
 	
 #ifdef __WXMSW__
-	return (deviceInterface->Write(id, CONST_PAYLOAD_LENGTH, &payload[0]));
+	return (TransmitFrame(id, CONST_PAYLOAD_LENGTH, &payload[0]));
 #endif
 	
 #ifdef __LINUX__
-	return (deviceInterface->Write(id,CONST_PAYLOAD_LENGTH,&payload[0]));
+	return (TransmitFrame(id,CONST_PAYLOAD_LENGTH,&payload[0]));
 #endif
  
 }
 
 // Shamelessly copied from somewhere, another plugin ?
 void ActisenseDevice::SendNMEASentence(wxString sentence) {
+	ACTISENSE_PROFILE_FUNCTION();
+	// Sentences from PGN's that produce several types may still include some that no one wants
+	int sentenceType = ActisenseBus::GetSentenceType(sentence);
+	if (sentenceType != NOT_FOUND) {
+		if (!IsSentenceWanted(sentenceType)) {
+			return;
+		}
+		publishedTypes |= SENTENCE_MASK(sentenceType);
+	}
 	sentence.Trim();
 	wxString checksum = ComputeChecksum(sentence);
 	sentence = sentence.Append(wxT("*"));
 	sentence = sentence.Append(checksum);
 	sentence = sentence.Append(wxT("\r\n"));
-	RaiseEvent(sentence);
+	publishedSentences.push_back(sentence);
+	UpdateDeliveryStatistics();
+}
+
+// Latency from the interface posting the frame until its sentence is published
+void ActisenseDevice::UpdateDeliveryStatistics(void) {
+	if ((currentLane >= 0) && (currentLane < QUEUE_LANES) && (currentPostedTime > 0)) {
+		unsigned long long latency = TwoCanUtils::GetMonotonicMicros() - currentPostedTime;
+		deliveryStatistics[currentLane].frames++;
+		deliveryStatistics[currentLane].totalLatency += latency;
+		if (latency > deliveryStatistics[currentLane].maximumLatency) {
+			deliveryStatistics[currentLane].maximumLatency = latency;
+		}
+	}
+	if (currentTimestamp > 0) {
+		unsigned long long now = TwoCanUtils::GetMonotonicMillis();
+		unsigned long long latency = (now > currentTimestamp) ? now - currentTimestamp : 0;
+		adapterStatistics.frames++;
+		adapterStatistics.totalLatency += latency;
+		if (latency > adapterStatistics.maximumLatency) {
+			adapterStatistics.maximumLatency = latency;
+		}
+	}
+}
+
+// The adapter's clock is unrelated to ours, other than by the frames it sends. The smallest (host - adapter)
+// difference corresponds to the least delayed frame, so is used as the offset between the two clocks.
+// It is re-estimated each window so that drift between the clocks does not accumulate
+unsigned long long ActisenseDevice::ConvertAdapterTimestamp(const unsigned int adapterTime, const unsigned long long hostTime) {
+	if (adapterTimeValid) {
+		if (adapterTime < lastAdapterTime) {
+			if ((lastAdapterTime - adapterTime) > (CONST_ADAPTER_TIME_WRAP / 2)) {
+				adapterEpoch += CONST_ADAPTER_TIME_WRAP;
+				lastAdapterTime = adapterTime;
+			}
+			else if ((lastAdapterTime - adapterTime) > CONST_ADAPTER_TIME_REORDER) {
+				// Adapter restarted or EBL log file rewound
+				adapterTimeValid = FALSE;
+			}
+			// Otherwise a slightly out of order frame
+		}
+		else if ((adapterTime - lastAdapterTime) < (CONST_ADAPTER_TIME_WRAP / 2)) {
+			lastAdapterTime = adapterTime;
+		}
+		// Otherwise a late frame from before the wrap
+	}
+
+	if (!adapterTimeValid) {
+		adapterEpoch = 0;
+		lastAdapterTime = adapterTime;
+		adapterOffset = (long long)hostTime - (long long)adapterTime;
+		windowOffset = adapterOffset;
+		windowStart = hostTime;
+		adapterTimeValid = TRUE;
+	}
+
+	unsigned long long extendedTime = adapterEpoch + adapterTime;
+	// A frame that arrives before the wrap has been detected belongs to the previous epoch
+	if ((adapterTime > lastAdapterTime) && ((adapterTime - lastAdapterTime) > (CONST_ADAPTER_TIME_WRAP / 2)) && (adapterEpoch > 0)) {
+		extendedTime -= CONST_ADAPTER_TIME_WRAP;
+	}
+
+	long long offset = (long long)hostTime - (long long)extendedTime;
+	if (offset < adapterOffset) {
+		adapterOffset = offset;
+	}
+	if (offset < windowOffset) {
+		windowOffset = offset;
+	}
+	if ((hostTime - windowStart) > CONST_ADAPTER_TIME_WINDOW) {
+		adapterOffset = windowOffset;
+		windowOffset = offset;
+		windowStart = hostTime;
+	}
+
+	return extendedTime + adapterOffset;
 }
 
 // Shamelessly copied from somewhere, another plugin ?
@@ -3934,6 +4588,15 @@ wxString ActisenseDevice::ComputeChecksum(wxString sentence) {
 	return(wxString::Format(wxT("%02X"), calculatedChecksum));
 }
 
+// Every frame transmitted by this device, so that it is counted
+int ActisenseDevice::TransmitFrame(const unsigned int id, const unsigned char payloadLength, const unsigned char *payload) {
+	int returnCode = deviceInterface->Write(id, payloadLength, payload);
+	if (returnCode == TWOCAN_RESULT_SUCCESS) {
+		deviceStatistics.CountTransmitted();
+	}
+	return returnCode;
+}
+
 // Fragment a Fast Packet Message into 8 byte payload chunks
 int ActisenseDevice::FragmentFastMessage(CanHeader *header, unsigned int payloadLength, byte *payload) {
 	unsigned int id;
@@ -3950,11 +4613,11 @@ int ActisenseDevice::FragmentFastMessage(CanHeader *header, unsigned int payload
 	memcpy(&data[2], &payload[0], 6);
 	
 #ifdef __WXMSW__
-		returnCode = deviceInterface->Write(id, CONST_PAYLOAD_LENGTH, &data[0]);
+		returnCode = TransmitFrame(id, CONST_PAYLOAD_LENGTH, &data[0]);
 #endif
 	
 #ifdef __LINUX__
-	returnCode = deviceInterface->Write(id,CONST_PAYLOAD_LENGTH,&data[0]);
+	returnCode = TransmitFrame(id,CONST_PAYLOAD_LENGTH,&data[0]);
 #endif
 
 	if (returnCode != TWOCAN_RESULT_SUCCESS) {
@@ -3975,12 +4638,12 @@ int ActisenseDevice::FragmentFastMessage(CanHeader *header, unsigned int payload
 		memcpy(&data[1],&payload[6 + (i * 7)],7);
 		
 #ifdef __WXMSW__
-		returnCode = deviceInterface->Write(id, CONST_PAYLOAD_LENGTH, &data[0]);
+		returnCode = TransmitFrame(id, CONST_PAYLOAD_LENGTH, &data[0]);
 #endif
 
 		
 #ifdef __LINUX__
-		returnCode = deviceInterface->Write(id,CONST_PAYLOAD_LENGTH,&data[0]);
+		returnCode = TransmitFrame(id,CONST_PAYLOAD_LENGTH,&data[0]);
 #endif
 
 		if (returnCode != TWOCAN_RESULT_SUCCESS) {
@@ -4002,12 +4665,12 @@ int ActisenseDevice::FragmentFastMessage(CanHeader *header, unsigned int payload
 		memcpy(&data[1], &payload[payloadLength - remainingBytes], remainingBytes );
 		
 #ifdef __WXMSW__
-		returnCode = deviceInterface->Write(id, CONST_PAYLOAD_LENGTH, &data[0]);
+		returnCode = TransmitFrame(id, CONST_PAYLOAD_LENGTH, &data[0]);
 #endif
 
 		
 #ifdef __LINUX__
-		returnCode = deviceInterface->Write(id,CONST_PAYLOAD_LENGTH,&data[0]);
+		returnCode = TransmitFrame(id,CONST_PAYLOAD_LENGTH,&data[0]);
 #endif
 		if (returnCode != TWOCAN_RESULT_SUCCESS) {
 			wxLogError(_T("Actisense Device, Error sending fast message frame"));
@@ -4035,6 +4698,7 @@ char ActisenseDevice::AISDecodeCharacter(char value) {
 
 // Create the NMEA 0183 AIS VDM/VDO payload from the 6 bit encoded binary data
 wxString ActisenseDevice::AISEncodePayload(std::vector<bool>& binaryData) {
+	ACTISENSE_PROFILE_FUNCTION();
 	wxString result;
 	int j = 6;
 	char temp = 0;
@@ -4075,6 +4739,7 @@ std::vector<bool> ActisenseDevice::AISDecodePayload(wxString SixBitData) {
 
 // Insert an integer value into AIS binary data, prior to AIS encoding
 void ActisenseDevice::AISInsertInteger(std::vector<bool>& binaryData, int start, int length, int value) {
+	ACTISENSE_PROFILE_FUNCTION();
 	for (int i = 0; i < length; i++) {
 		// set the bit values, storing as MSB
 		binaryData[start + length - i - 1] = (value & (1 << i));
@@ -4084,6 +4749,7 @@ void ActisenseDevice::AISInsertInteger(std::vector<bool>& binaryData, int start,
 
 // Insert a date value, DDMMhhmm into AIS binary data, prior to AIS encoding
 void ActisenseDevice::AISInsertDate(std::vector<bool>& binaryData, int start, int length, int day, int month, int hour, int minute) {
+	ACTISENSE_PROFILE_FUNCTION();
 	AISInsertInteger(binaryData, start, 4, day);
 	AISInsertInteger(binaryData, start + 4, 5, month);
 	AISInsertInteger(binaryData, start + 9, 5, hour);
@@ -4093,6 +4759,7 @@ void ActisenseDevice::AISInsertDate(std::vector<bool>& binaryData, int start, in
 
 // Insert a string value into AIS binary data, prior to AIS encoding
 void ActisenseDevice::AISInsertString(std::vector<bool> &binaryData, int start, int length, std::string value) {
+	ACTISENSE_PROFILE_FUNCTION();
 
 	// Should check that value.length is a multiple of 6 (6 bit ASCII encoded characters) and
 	// that value.length * 6 is less than length.
@@ -29,7 +29,9 @@
 
 #include <actisense_ebl.h>
 
-ActisenseEBL::ActisenseEBL(wxMessageQueue<std::vector<byte>> *messageQueue) : ActisenseInterface(messageQueue) {
+ActisenseEBL::ActisenseEBL(ActisenseQueue *messageQueue) : ActisenseInterface(messageQueue), framer(messageQueue) {
+	// Pace playback after each message posted
+	framer.SetPostHook([]() { wxThread::Sleep(CONST_EBL_PLAYBACK_DELAY); });
 }
 
 ActisenseEBL::~ActisenseEBL() {
@@ -64,20 +66,13 @@ int ActisenseEBL::Close(void) {
 }
 
 void ActisenseEBL::Read() {
-	// used to construct valid Actisense messages
-	std::vector<byte> assemblyBuffer;
 	// read 1K at a time
 	std::vector<byte> readBuffer(1024,0);
 	// used to iterate through the readBuffer
 	std::streamsize bytesRead;
-	// if we've found an ASCII Control Char DLE or ESC
-	bool isEscaped = false;
-	// if we've found an ASCII Control Char STX (preceded by a DLE)
-	// or a BEMSTART (preceded by an ESC)
-	bool msgStart = false;
-	// if we've found an ASCII Control Char ETX (also preceded by a DLE)
-	// or a BEMEND (preceded by an ESC)
-	bool msgComplete = false;
+
+	// Messages are assembled and posted by the framer
+	framer.Reset();
 		
 	while (!TestDestroy()) {
 		
@@ -86,93 +81,17 @@ void ActisenseEBL::Read() {
 		bytesRead = logFileStream.gcount(); 
 		
 		if (bytesRead > 0) {
-								
-			for (int i=0; i < bytesRead; i++) {
-				
-				unsigned char ch = readBuffer.at(i);
-				
-				// if last character was DLE or ESC
-				if (isEscaped) {
-					isEscaped = false;
-
-					// Message Start
-					if ((ch == STX) && (!msgStart)) {
-						msgStart = true;
-						msgComplete = false;
-						assemblyBuffer.clear();
-					}
-
-					// Message End
-					else if ((ch == ETX) && (msgStart)) {
-						msgComplete = true;
-						msgStart = false;
-					}
-
-					// Actisense Binary Encoded Message Start
-					else if ((ch == BEMSTART) && (!msgStart)) {
-						msgStart = true;
-						msgComplete = false;
-						assemblyBuffer.clear();
-					}
-
-					// Actisense Binary Encoded Message End
-					else if ((ch == BEMEND) && (msgStart)) {
-						msgComplete = true;
-						msgStart = false;
-					}
-
-					// Escaped DLE
-					else if ((ch == DLE) && (msgStart)) {
-						assemblyBuffer.push_back(ch);
-					}
-
-					// Escaped ESC
-					else if ((ch == ESC) && (msgStart)) {
-						assemblyBuffer.push_back(ch);
-					}
-
-					else {
-						// Can't have an escaped normal char
-						msgComplete = false;
-						msgStart = false;
-						assemblyBuffer.clear();
-					}
-				}
-				// Previous character was not a DLE or ESC
-				else {
-					if ((ch == DLE) || (ch == ESC)) {
-						isEscaped = true;
-					}
-					else if (msgStart) {
-						// a normal character
-						assemblyBuffer.push_back(ch);
-					}
-				}
-			
-				if (msgComplete) {
-					// we have a complete frame, process it
-					deviceQueue->Post(assemblyBuffer);																					
-					
-					wxThread::Sleep(5);
-					
-					// Reset everything for next message
-					assemblyBuffer.clear();
-					msgStart = false;
-					msgComplete = false;
-					isEscaped = false;
-							
-				}	// end if msgComplete
-			
-			} // end for
-			
-			// If end of file, rewind to beginning
-			if (logFileStream.eof()) {
-				logFileStream.clear();
-				logFileStream.seekg(0, std::ios::beg); 
-				wxLogMessage(_T("Actisense EBL, Rewinding Log File"));
-			}
+			framer.Process(readBuffer.data(), static_cast<size_t>(bytesRead), TwoCanUtils::GetMonotonicMicros());
+		}
 			
-		} // end if bytesread > 0
+		// If end of file, rewind to beginning
+		if (logFileStream.eof()) {
+			logFileStream.clear();
+			logFileStream.seekg(0, std::ios::beg); 
+			// Don't join the end of the file to its beginning
+			framer.Reset();
+			wxLogMessage(_T("Actisense EBL, Rewinding Log File"));
+		}
 									
 	} // end while !TestDestroy
 		
@@ -0,0 +1,161 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseFramer - Assembles Actisense messages from a byte stream
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+
+#include "actisense_framer.h"
+
+ActisenseFramer::ActisenseFramer(ActisenseQueue *queue) {
+	messageQueue = queue;
+	postedMessages = 0;
+	resyncs = 0;
+	escapeErrors = 0;
+	discardedBytes = 0;
+	Reset();
+}
+
+ActisenseFramer::~ActisenseFramer(void) {
+}
+
+void ActisenseFramer::Reset(void) {
+	assemblyBuffer.clear();
+	isEscaped = false;
+	msgStart = false;
+	msgComplete = false;
+	isFiltered = false;
+}
+
+void ActisenseFramer::Process(const byte *data, const size_t length, const unsigned long long readTime) {
+	ACTISENSE_PROFILE_SCOPE("Framing");
+	for (size_t i = 0; i < length; i++) {
+
+
+		unsigned char ch = data[i];
+
+		// if last character was DLE or ESC
+		if (isEscaped) {
+			isEscaped = false;
+
+			// Message Start
+			if ((ch == STX) && (!msgStart)) {
+				msgStart = true;
+				msgComplete = false;
+				isFiltered = false;
+				assemblyBuffer.clear();
+			}
+
+			// Message End
+			else if ((ch == ETX) && (msgStart)) {
+				msgComplete = true;
+				msgStart = false;
+			}
+
+			// Actisense Binary Encoded Message Start
+			else if ((ch == BEMSTART) && (!msgStart)) {
+				msgStart = true;
+				msgComplete = false;
+				isFiltered = false;
+				assemblyBuffer.clear();
+			}
+
+			// Actisense Binary Encoded Message End
+			else if ((ch == BEMEND) && (msgStart)) {
+				msgComplete = true;
+				msgStart = false;
+			}
+
+			// Escaped DLE
+			else if ((ch == DLE) && (msgStart)) {
+				if (!isFiltered) {
+					assemblyBuffer.push_back(ch);
+				}
+			}
+
+			// Escaped ESC
+			else if ((ch == ESC) && (msgStart)) {
+				if (!isFiltered) {
+					assemblyBuffer.push_back(ch);
+				}
+			}
+
+			else {
+				// Can't have an escaped normal char, resynchronise on the next DLE STX or ESC BEMSTART
+				escapeErrors++;
+				if (msgStart) {
+					resyncs++;
+				}
+				msgComplete = false;
+				msgStart = false;
+				assemblyBuffer.clear();
+			}
+		}
+		// Previous character was not a DLE or ESC
+		else {
+			if ((ch == DLE) || (ch == ESC)) {
+				isEscaped = true;
+			}
+			else if ((msgStart) && (!isFiltered)) {
+				// a normal character
+				assemblyBuffer.push_back(ch);
+			}
+			else if (!msgStart) {
+				discardedBytes++;
+			}
+		}
+
+		// Stop copying a message as soon as its PGN shows that it is not wanted
+		if ((msgStart) && (!isFiltered) && (assemblyBuffer.size() == CONST_PEEK_LENGTH)) {
+			isFiltered = !pgnFilter.IsEnabled(assemblyBuffer);
+		}
+
+		if (msgComplete) {
+			// we have a complete frame, process it
+			// No idea why Hubert's adapter sends messages both with & without checksums !!
+			// Post the message for processing. Perform checksum validation later so that the 
+			// decoding functions can branch as appropriate
+			
+			if (!isFiltered) {
+				messageQueue->Post(assemblyBuffer, readTime);
+				postedMessages++;
+				if (postHook) {
+					postHook();
+				}
+			}
+			else {
+				pgnFilter.CountFiltered();
+			}
+			
+			// Reset everything for next message
+			assemblyBuffer.clear();
+			msgStart = false;
+			msgComplete = false;
+			isEscaped = false;
+			isFiltered = false;
+
+		}	// end if msgComplete
+
+	} // end for
+}
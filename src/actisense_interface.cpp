@@ -29,7 +29,7 @@
 
 #include <actisense_interface.h>
 
-ActisenseInterface::ActisenseInterface(wxMessageQueue<std::vector<byte>> *messageQueue) : wxThread(wxTHREAD_JOINABLE) {
+ActisenseInterface::ActisenseInterface(ActisenseQueue *messageQueue) : wxThread(wxTHREAD_JOINABLE) {
 	// Save the Actisense Device message queue
 	// NMEA 2000 messages are 'posted' to the Actisense device for subsequent parsing
 	deviceQueue = messageQueue;
@@ -62,3 +62,11 @@ void ActisenseInterface::OnExit() {
 int ActisenseInterface::Write(const unsigned int canId, const unsigned char payloadLength, const unsigned char *payload) {
 	return TWOCAN_RESULT_SUCCESS;
 }
+
+int ActisenseInterface::WriteCommand(const std::vector<byte>& command) {
+	return TWOCAN_RESULT_SUCCESS;
+}
+
+bool ActisenseInterface::GetSerialStatistics(SerialStatistics *statistics) {
+	return FALSE;
+}
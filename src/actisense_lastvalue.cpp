@@ -0,0 +1,143 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseLastValues - Last value received for each (PGN, source)
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+// Version History: 
+// 1.0 Initial Release
+//
+// Open addressed table, linear probing. Slots are never removed, so a key once inserted stays put
+// and readers need only the key and the slot's sequence lock to obtain a consistent snapshot
+
+#include "actisense_lastvalue.h"
+
+ActisenseLastValues::ActisenseLastValues(void) {
+	slots = new LastValueSlot[CONST_LAST_VALUE_SLOTS];
+	for (int i = 0; i < CONST_LAST_VALUE_SLOTS; i++) {
+		slots[i].key.store(0, std::memory_order_relaxed);
+		slots[i].lock.store(0, std::memory_order_relaxed);
+		slots[i].value = {};
+	}
+	generation.store(0, std::memory_order_relaxed);
+	overflows.store(0, std::memory_order_relaxed);
+	oversized.store(0, std::memory_order_relaxed);
+}
+
+ActisenseLastValues::~ActisenseLastValues(void) {
+	delete[] slots;
+}
+
+// Find the slot for a key. As slots are never removed, an unused slot terminates the probe
+int ActisenseLastValues::FindSlot(const unsigned int key, const bool create) {
+	// Fibonacci hashing spreads the consecutive source addresses of the one PGN
+	unsigned int index = (key * 2654435769U) >> 22;
+	for (int i = 0; i < CONST_LAST_VALUE_SLOTS; i++) {
+		unsigned int slotKey = slots[index].key.load(std::memory_order_acquire);
+		if (slotKey == key) {
+			return index;
+		}
+		if (slotKey == 0) {
+			return create ? index : NOT_FOUND;
+		}
+		index = (index + 1) & (CONST_LAST_VALUE_SLOTS - 1);
+	}
+	return NOT_FOUND;
+}
+
+// Overwrite the slot for the frame's (PGN, source). Never blocks
+bool ActisenseLastValues::Update(const CanHeader header, const byte *payload, const unsigned int length, const unsigned long long timestamp) {
+	// ISO Transport Protocol messages may be longer than a Fast Packet. Rather than retain a truncated payload
+	// that a consumer would take to be the whole message, they are not stored
+	if (length > CONST_MAX_FAST_PACKET_LENGTH) {
+		oversized.fetch_add(1, std::memory_order_relaxed);
+		return FALSE;
+	}
+
+	unsigned int key = ((header.pgn << 8) | header.source) + 1;
+	int index = FindSlot(key, TRUE);
+	if (index == NOT_FOUND) {
+		overflows.fetch_add(1, std::memory_order_relaxed);
+		return FALSE;
+	}
+
+	LastValueSlot *slot = &slots[index];
+	unsigned int lock = slot->lock.load(std::memory_order_relaxed);
+	slot->lock.store(lock + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot->value.header = header;
+	slot->value.length = length;
+	memcpy(slot->value.payload, payload, length);
+	slot->value.sequence++;
+	slot->value.timestamp = timestamp;
+
+	slot->lock.store(lock + 2, std::memory_order_release);
+
+	// Publish the key last, so a reader never finds a slot before its first value is complete
+	if (slot->key.load(std::memory_order_relaxed) == 0) {
+		slot->key.store(key, std::memory_order_release);
+	}
+	generation.fetch_add(1, std::memory_order_release);
+	return TRUE;
+}
+
+// Sequence lock read. The producer updates each slot at most a few times a second, so retries are rare
+bool ActisenseLastValues::ReadSlot(const int index, LastValue *value) {
+	LastValueSlot *slot = &slots[index];
+	while (TRUE) {
+		unsigned int before = slot->lock.load(std::memory_order_acquire);
+		if ((before & 1) == 0) {
+			memcpy(value, &slot->value, sizeof(LastValue));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot->lock.load(std::memory_order_relaxed) == before) {
+				return TRUE;
+			}
+		}
+		std::this_thread::yield();
+	}
+}
+
+bool ActisenseLastValues::Read(const unsigned int pgn, const byte source, LastValue *value) {
+	int index = FindSlot(((pgn << 8) | source) + 1, FALSE);
+	if (index == NOT_FOUND) {
+		return FALSE;
+	}
+	return ReadSlot(index, value);
+}
+
+// Coalesces on behalf of the consumer, only the latest value of each updated slot is returned
+size_t ActisenseLastValues::ReadUpdates(std::vector<unsigned long long>& cursor, std::vector<LastValue>& updates) {
+	LastValue value;
+	updates.clear();
+	cursor.resize(CONST_LAST_VALUE_SLOTS, 0);
+	for (int i = 0; i < CONST_LAST_VALUE_SLOTS; i++) {
+		if (slots[i].key.load(std::memory_order_acquire) != 0) {
+			if (ReadSlot(i, &value) && (value.sequence != cursor[i])) {
+				cursor[i] = value.sequence;
+				updates.push_back(value);
+			}
+		}
+	}
+	return updates.size();
+}
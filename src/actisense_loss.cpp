@@ -0,0 +1,197 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseLossTracker - Per source & PGN lost message detection
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+// Version History: 
+// 1.0 Initial Release
+//
+
+#include "actisense_loss.h"
+
+// Offset of the sequence identifier within the payload (-1 if none), and the standard transmission period (msec, 0 if irregular).
+// Only PGN's that the device's PGN filter enables (pgnFlags) are listed, as no others reach the tracker
+static const struct {
+	unsigned int pgn;
+	int sidOffset;
+	unsigned int period;
+} lossExpectations[] = {
+	{ 126992, 0, 1000 }, // System Time
+	{ 127245, -1, 100 }, // Rudder
+	{ 127250, 0, 100 }, // Vessel Heading
+	{ 127251, 0, 100 }, // Rate of Turn
+	{ 127257, 0, 1000 }, // Attitude
+	{ 127258, 0, 0 }, // Magnetic Variation
+	{ 127488, -1, 100 }, // Engine Parameters, Rapid Update
+	{ 127489, -1, 500 }, // Engine Parameters, Dynamic
+	{ 127505, -1, 2500 }, // Fluid Level
+	{ 128259, 0, 1000 }, // Speed
+	{ 128267, 0, 1000 }, // Water Depth
+	{ 129025, -1, 100 }, // Position, Rapid Update
+	{ 129026, 0, 250 }, // COG & SOG, Rapid Update
+	{ 129029, 0, 1000 }, // GNSS Position
+	{ 129283, 0, 1000 }, // Cross Track Error
+	{ 129284, 0, 1000 }, // Navigation Data
+	{ 130306, 0, 100 }, // Wind Data
+	{ 130310, 0, 500 }, // Environmental Parameters
+	{ 130311, 0, 500 }, // Environmental Parameters
+	{ 130312, 0, 2000 }, // Temperature
+	{ 130316, 0, 2000 } // Temperature, Extended Range
+};
+
+ActisenseLossTracker::ActisenseLossTracker(void) {
+	Reset();
+}
+
+ActisenseLossTracker::~ActisenseLossTracker(void) {
+}
+
+void ActisenseLossTracker::Reset(void) {
+	for (int i = 0; i < CONST_LOSS_ENTRIES; i++) {
+		entries[i] = {};
+	}
+	entryCount = 0;
+	receivedMessages = 0;
+	lostMessages = 0;
+	overflows = 0;
+}
+
+// Linear probing, entries are never removed. NULL if the table is full
+LossEntry *ActisenseLossTracker::FindEntry(const CanHeader& header) {
+	unsigned int key = (header.source << 18) | (header.pgn & 0x3FFFF);
+	int position = ((key * 2654435769U) >> 16) & (CONST_LOSS_ENTRIES - 1);
+	for (int i = 0; i < CONST_LOSS_ENTRIES; i++) {
+		LossEntry *entry = &entries[position];
+		if (!entry->inUse) {
+			// Keep one entry free to terminate the search
+			if (entryCount >= CONST_LOSS_ENTRIES - 1) {
+				overflows++;
+				return NULL;
+			}
+			entry->inUse = TRUE;
+			entry->pgn = header.pgn;
+			entry->source = header.source;
+			entry->lastSid = -1;
+			entry->lastSequence = -1;
+			entryCount++;
+			return entry;
+		}
+		if ((entry->pgn == header.pgn) && (entry->source == header.source)) {
+			return entry;
+		}
+		position = (position + 1) & (CONST_LOSS_ENTRIES - 1);
+	}
+	overflows++;
+	return NULL;
+}
+
+void ActisenseLossTracker::AddLost(LossEntry *entry, const unsigned long long lost) {
+	entry->lost += lost;
+	lostMessages += lost;
+}
+
+double ActisenseLossTracker::LossRatio(const LossEntry& entry) {
+	return ((entry.received + entry.lost) > 0) ? static_cast<double>(entry.lost) / (entry.received + entry.lost) : 0;
+}
+
+// A repeated SID is not a loss, a transmitter may send faster than its data is updated
+void ActisenseLossTracker::Record(const CanHeader& header, const std::vector<byte>& payload) {
+	LossEntry *entry = FindEntry(header);
+	if (entry == NULL) {
+		return;
+	}
+
+	entry->received++;
+	receivedMessages++;
+
+	int sidOffset = -1;
+	unsigned int period = 0;
+	for (size_t i = 0; i < sizeof(lossExpectations) / sizeof(lossExpectations[0]); i++) {
+		if (lossExpectations[i].pgn == header.pgn) {
+			sidOffset = lossExpectations[i].sidOffset;
+			period = lossExpectations[i].period;
+			break;
+		}
+	}
+
+	if ((sidOffset >= 0) && (payload.size() > static_cast<size_t>(sidOffset)) && (payload[sidOffset] < CONST_SID_RANGE)) {
+		int sid = payload[sidOffset];
+		if (entry->lastSid >= 0) {
+			int gap = (sid - entry->lastSid + CONST_SID_RANGE) % CONST_SID_RANGE;
+			if ((gap > 1) && (gap <= CONST_MAX_SID_GAP)) {
+				entry->sidGaps += gap - 1;
+				AddLost(entry, gap - 1);
+			}
+		}
+		entry->lastSid = sid;
+	}
+	else if ((period > 0) && (entry->lastTimestamp > 0) && (header.timestamp > entry->lastTimestamp)) {
+		// Only PGN's without a SID are judged by their rate, otherwise the same loss is counted twice
+		unsigned long long interval = header.timestamp - entry->lastTimestamp;
+		if ((interval > (period * 3) / 2) && (interval < CONST_RATE_TIMEOUT)) {
+			unsigned long long missing = ((interval + (period / 2)) / period) - 1;
+			entry->late += missing;
+			AddLost(entry, missing);
+		}
+	}
+
+	entry->lastTimestamp = header.timestamp;
+}
+
+// Fast Packet losses are already reflected in the SID or the rate, so these are counted but not added to the losses
+void ActisenseLossTracker::RecordSequence(const CanHeader& header, const unsigned int sequence) {
+	LossEntry *entry = FindEntry(header);
+	if (entry == NULL) {
+		return;
+	}
+	if (entry->lastSequence >= 0) {
+		int gap = (static_cast<int>(sequence) - entry->lastSequence + CONST_FAST_PACKET_SEQUENCES) % CONST_FAST_PACKET_SEQUENCES;
+		if (gap > 1) {
+			entry->sequenceGaps += gap - 1;
+		}
+	}
+	entry->lastSequence = sequence;
+}
+
+void ActisenseLossTracker::RecordIncomplete(const CanHeader& header) {
+	LossEntry *entry = FindEntry(header);
+	if (entry != NULL) {
+		entry->incomplete++;
+	}
+}
+
+void ActisenseLossTracker::GetLosses(std::vector<LossEntry>& losses, const size_t maximum) {
+	losses.clear();
+	for (int i = 0; i < CONST_LOSS_ENTRIES; i++) {
+		if ((entries[i].inUse) && ((entries[i].lost > 0) || (entries[i].incomplete > 0) || (entries[i].sequenceGaps > 0))) {
+			losses.push_back(entries[i]);
+		}
+	}
+	std::sort(losses.begin(), losses.end(), 
+		[](const LossEntry& a, const LossEntry& b) { return LossRatio(a) > LossRatio(b); });
+	if (losses.size() > maximum) {
+		losses.resize(maximum);
+	}
+}
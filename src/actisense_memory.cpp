@@ -0,0 +1,104 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseMemory - In memory interface for tools and benchmarks
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+
+#include "actisense_memory.h"
+
+ActisenseMemory::ActisenseMemory(ActisenseQueue *messageQueue) : ActisenseInterface(messageQueue), framer(messageQueue) {
+}
+
+ActisenseMemory::~ActisenseMemory(void) {
+}
+
+int ActisenseMemory::Open(const wxString& fileName) {
+	wxLogMessage(_T("Actisense Memory, Opened"));
+	return TWOCAN_RESULT_SUCCESS;
+}
+
+int ActisenseMemory::Close(void) {
+	wxMutexLocker lock(feedMutex);
+	framer.Reset();
+	return TWOCAN_RESULT_SUCCESS;
+}
+
+// Nothing to read, the messages are fed by the caller. Idle until the device deletes the thread
+void ActisenseMemory::Read() {
+	while (!TestDestroy()) {
+		wxThread::Sleep(100);
+	}
+}
+
+void ActisenseMemory::Feed(const byte *data, const size_t length) {
+	wxMutexLocker lock(feedMutex);
+	framer.Process(data, length, TwoCanUtils::GetMonotonicMicros());
+}
+
+void ActisenseMemory::Feed(const std::vector<byte>& data) {
+	Feed(data.data(), data.size());
+}
+
+unsigned long long ActisenseMemory::GetPostedMessages(void) {
+	wxMutexLocker lock(feedMutex);
+	return framer.GetPostedMessages();
+}
+
+int ActisenseMemory::Write(const unsigned int canId, const unsigned char payloadLength, const unsigned char *payload) {
+	MemoryFrame frame;
+	frame.id = canId;
+	frame.payload.assign(payload, payload + payloadLength);
+	wxMutexLocker lock(writeMutex);
+	writtenFrames.push_back(frame);
+	return TWOCAN_RESULT_SUCCESS;
+}
+
+int ActisenseMemory::WriteCommand(const std::vector<byte>& command) {
+	wxMutexLocker lock(writeMutex);
+	writtenCommands.push_back(command);
+	return TWOCAN_RESULT_SUCCESS;
+}
+
+void ActisenseMemory::TakeWrittenFrames(std::vector<MemoryFrame>& frames) {
+	wxMutexLocker lock(writeMutex);
+	frames.swap(writtenFrames);
+	writtenFrames.clear();
+}
+
+void ActisenseMemory::TakeWrittenCommands(std::vector<std::vector<byte>>& commands) {
+	wxMutexLocker lock(writeMutex);
+	commands.swap(writtenCommands);
+	writtenCommands.clear();
+}
+
+// Entry, the method that is executed upon thread start
+wxThread::ExitCode ActisenseMemory::Entry() {
+	Read();
+	return (wxThread::ExitCode)TWOCAN_RESULT_SUCCESS;
+}
+
+// OnExit, called when thread is being destroyed
+void ActisenseMemory::OnExit() {
+}
@@ -0,0 +1,260 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseMetrics - Prometheus metrics endpoint
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+
+#include "actisense_metrics.h"
+
+ActisenseMetrics::ActisenseMetrics(void) : wxThread(wxTHREAD_JOINABLE) {
+	metricsServer = NULL;
+}
+
+ActisenseMetrics::~ActisenseMetrics(void) {
+}
+
+// Init - Bind to localhost, or to a Unix domain socket, so that the metrics are not exposed to the boat's network.
+// Called from the main thread, as wxWidgets requires for the socket initialization
+int ActisenseMetrics::Init(void) {
+	if (!wxSocketBase::IsInitialized()) {
+		wxSocketBase::Initialize();
+	}
+
+	// Sockets used by a secondary thread must block
+	wxSocketFlags flags = wxSOCKET_BLOCK | wxSOCKET_REUSEADDR;
+	
+#if defined(__LINUX__) && defined(wxHAS_UNIX_DOMAIN_SOCKETS)
+	if (!metricsSocket.IsEmpty()) {
+		// A previous instance does not remove the socket file when it exits
+		if (wxFileExists(metricsSocket)) {
+			wxRemoveFile(metricsSocket);
+		}
+		wxUNIXaddress socketAddress;
+		socketAddress.Filename(metricsSocket);
+		metricsServer = new wxSocketServer(socketAddress, flags);
+	}
+	else 
+#endif
+	{
+		wxIPV4address socketAddress;
+		socketAddress.Hostname(_T("127.0.0.1"));
+		socketAddress.Service(metricsPort);
+		metricsServer = new wxSocketServer(socketAddress, flags);
+	}
+
+	if (!metricsServer->IsOk()) {
+		wxLogMessage(_T("Actisense Metrics, Error binding to %s"), metricsSocket.IsEmpty() ? wxString::Format(_T("port %d"), metricsPort) : metricsSocket);
+		metricsServer->Destroy();
+		metricsServer = NULL;
+		return SET_ERROR(TWOCAN_RESULT_FATAL, TWOCAN_SOURCE_PLUGIN, TWOCAN_ERROR_SOCKET_BIND);
+	}
+
+	wxLogMessage(_T("Actisense Metrics, Listening on %s"), metricsSocket.IsEmpty() ? wxString::Format(_T("port %d"), metricsPort) : metricsSocket);
+	return TWOCAN_RESULT_SUCCESS;
+}
+
+// DeInit - Close the listening socket, once the thread has exited
+int ActisenseMetrics::DeInit(void) {
+	if (metricsServer != NULL) {
+		metricsServer->Destroy();
+		metricsServer = NULL;
+	}
+	return TWOCAN_RESULT_SUCCESS;
+}
+
+// Entry, the method that is executed upon thread start
+// Scrapes are served one at a time, they are infrequent and each takes well under a millisecond
+wxThread::ExitCode ActisenseMetrics::Entry() {
+	while (!TestDestroy()) {
+		if (metricsServer->WaitForAccept(0, CONST_METRICS_ACCEPT_TIMEOUT)) {
+			wxSocketBase *client = metricsServer->Accept(false);
+			if (client != NULL) {
+				client->SetFlags(wxSOCKET_BLOCK);
+				client->SetTimeout(1);
+				ServeRequest(client);
+				client->Destroy();
+			}
+		}
+	}
+	return (wxThread::ExitCode)TWOCAN_RESULT_SUCCESS;
+}
+
+// OnExit, called when thread->delete is invoked, and entry returns
+void ActisenseMetrics::OnExit() {
+	wxLogMessage(_T("Actisense Metrics, Thread exiting"));
+}
+
+void ActisenseMetrics::ServeRequest(wxSocketBase *client) {
+	char request[CONST_METRICS_REQUEST_SIZE];
+	size_t length = 0;
+
+	// Only the request line is used, but read the whole header so that the scraper does not see a reset connection
+	while (length < sizeof(request) - 1) {
+		client->Read(request + length, sizeof(request) - 1 - length);
+		if ((client->Error()) || (client->LastCount() == 0)) {
+			break;
+		}
+		length += client->LastCount();
+		request[length] = 0;
+		if (strstr(request, "\r\n\r\n") != NULL) {
+			break;
+		}
+	}
+	request[length] = 0;
+
+	std::string status;
+	std::string page;
+	if (strncmp(request, "GET ", 4) != 0) {
+		status = "405 Method Not Allowed";
+	}
+	else if ((strncmp(request + 4, "/metrics", 8) == 0) && ((request[12] == ' ') || (request[12] == '?'))) {
+		status = "200 OK";
+		page = FormatMetrics();
+	}
+	else {
+		status = "404 Not Found";
+	}
+
+	char header[256];
+	snprintf(header, sizeof(header), "HTTP/1.0 %s\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", 
+		status.c_str(), page.size());
+	page.insert(0, header);
+
+	client->SetFlags(wxSOCKET_BLOCK | wxSOCKET_WAITALL);
+	client->Write(page.data(), page.size());
+}
+
+void ActisenseMetrics::AppendMetric(std::string& page, const char *name, const char *type, const char *help, const unsigned long long value) {
+	char line[256];
+	snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s %s\n%s %llu\n", name, help, name, type, name, value);
+	page.append(line);
+}
+
+// Bucket limits are whole microseconds, so they are formatted without floating point, which would be subject to the locale's decimal separator
+void ActisenseMetrics::AppendHistogram(std::string& page, const char *name, const char *help, const ActisenseHistogram& histogram) {
+	char line[256];
+	snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+	page.append(line);
+
+	// Cumulative, and the count is taken from the buckets so that it is consistent with them
+	unsigned long long count = 0;
+	for (int i = 0; i < CONST_HISTOGRAM_BUCKETS; i++) {
+		count += histogram.GetBucket(i);
+		if (i < CONST_HISTOGRAM_BUCKETS - 1) {
+			unsigned long long limit = ActisenseHistogram::GetBucketLimit(i);
+			snprintf(line, sizeof(line), "%s_bucket{le=\"%llu.%06llu\"} %llu\n", name, limit / 1000000, limit % 1000000, count);
+		}
+		else {
+			snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %llu\n", name, count);
+		}
+		page.append(line);
+	}
+	unsigned long long total = histogram.GetTotal();
+	snprintf(line, sizeof(line), "%s_sum %llu.%06llu\n%s_count %llu\n", name, total / 1000000, total % 1000000, name, count);
+	page.append(line);
+}
+
+// Taken from the last values table, so a scrape reads one snapshot per (PGN, source) rather than replaying the bus.
+// Ages are whole milliseconds, formatted without floating point for the same reason as the bucket limits
+void ActisenseMetrics::AppendLastValues(std::string& page) {
+	// A new cursor, so every (PGN, source) received so far is returned
+	std::vector<unsigned long long> cursor;
+	std::vector<LastValue> values;
+	lastValues.ReadUpdates(cursor, values);
+
+	char line[256];
+	page.append("# HELP actisense_pgn_received_total Messages received for each PGN from each source\n# TYPE actisense_pgn_received_total counter\n");
+	for (std::vector<LastValue>::iterator it = values.begin(); it != values.end(); ++it) {
+		snprintf(line, sizeof(line), "actisense_pgn_received_total{pgn=\"%u\",source=\"%u\"} %llu\n", it->header.pgn, it->header.source, it->sequence);
+		page.append(line);
+	}
+
+	unsigned long long now = TwoCanUtils::GetMonotonicMillis();
+	page.append("# HELP actisense_pgn_age_seconds Time since each PGN was last received from each source\n# TYPE actisense_pgn_age_seconds gauge\n");
+	for (std::vector<LastValue>::iterator it = values.begin(); it != values.end(); ++it) {
+		unsigned long long age = (now > it->timestamp) ? now - it->timestamp : 0;
+		snprintf(line, sizeof(line), "actisense_pgn_age_seconds{pgn=\"%u\",source=\"%u\"} %llu.%03llu\n", it->header.pgn, it->header.source, age / 1000, age % 1000);
+		page.append(line);
+	}
+
+	AppendMetric(page, "actisense_last_value_overflows_total", "counter", "Messages not retained as the last values table is full", lastValues.GetOverflows());
+	AppendMetric(page, "actisense_last_value_oversized_total", "counter", "Messages not retained as they are longer than a Fast Packet", lastValues.GetOversized());
+}
+
+std::string ActisenseMetrics::FormatMetrics(void) {
+	std::string page;
+	page.reserve(8192);
+
+	// Frames
+	AppendMetric(page, "actisense_frames_received_total", "counter", "Messages received from the adapter", deviceStatistics.GetReceivedFrames());
+	AppendMetric(page, "actisense_frames_transmitted_total", "counter", "Frames transmitted to the adapter", deviceStatistics.GetTransmittedFrames());
+	AppendMetric(page, "actisense_frames_standard_total", "counter", "Single frame messages received", deviceStatistics.GetStandardFrames());
+	AppendMetric(page, "actisense_frames_fast_packet_total", "counter", "Fast packet frames received", deviceStatistics.GetFastFrames());
+	AppendMetric(page, "actisense_frames_error_total", "counter", "Malformed messages and checksum failures", deviceStatistics.GetErrorFrames());
+
+	// Drops
+	AppendMetric(page, "actisense_queue_dropped_total", "counter", "Frames discarded by the queue's overload policy", deviceStatistics.GetDroppedFrames());
+	AppendMetric(page, "actisense_queue_coalesced_total", "counter", "Navigation frames replaced by a newer frame while queued", deviceStatistics.GetCoalescedFrames());
+	AppendMetric(page, "actisense_filter_dropped_total", "counter", "Frames discarded by the PGN filter", pgnFilter.GetFilteredFrames());
+	AppendMetric(page, "actisense_adapter_dropped_total", "counter", "Frames dropped by the NGT-1", deviceStatistics.GetAdapterDropped());
+
+	// Queue
+	AppendMetric(page, "actisense_queue_depth", "gauge", "Frames waiting in the queue", deviceStatistics.GetQueueDepth());
+	AppendMetric(page, "actisense_queue_high_water_mark", "gauge", "Most frames ever waiting in the queue", deviceStatistics.GetQueueHighWaterMark());
+	AppendMetric(page, "actisense_queue_capacity", "gauge", "Maximum number of frames that may be queued", deviceStatistics.GetQueueCapacity());
+
+	// Latencies
+	AppendHistogram(page, "actisense_decode_seconds", "Time taken to decode a message", deviceStatistics.GetDecodeTime());
+	AppendHistogram(page, "actisense_queue_wait_seconds", "Time a message waited in the queue", deviceStatistics.GetQueueTime());
+
+	// Sampled frame latencies, only present when tracing
+	if (frameTracer.IsEnabled()) {
+		for (int i = 0; i < TRACE_INTERVALS; i++) {
+			char name[64];
+			snprintf(name, sizeof(name), "actisense_trace_%s_seconds", ActisenseTracer::GetIntervalName(i));
+			AppendHistogram(page, name, "Latency of the sampled frames", frameTracer.GetInterval(i));
+		}
+	}
+
+	// Each PGN from each device
+	AppendLastValues(page);
+
+	// Serial link, only present for the NGT-1
+	SerialStatistics serial;
+	if (deviceStatistics.GetSerial(&serial)) {
+		AppendMetric(page, "actisense_serial_received_bytes_total", "counter", "Bytes received from the serial port", serial.rxBytes);
+		AppendMetric(page, "actisense_serial_bytes_per_second", "gauge", "Serial port receive rate", serial.bytesPerSecond);
+		AppendMetric(page, "actisense_serial_utilisation_percent", "gauge", "Serial port receive rate as a percentage of its capacity", serial.utilisation);
+		AppendMetric(page, "actisense_serial_overruns_total", "counter", "UART overruns", serial.overruns);
+		AppendMetric(page, "actisense_serial_buffer_overruns_total", "counter", "Serial driver buffer overruns", serial.bufferOverruns);
+		AppendMetric(page, "actisense_serial_framing_errors_total", "counter", "Serial framing errors", serial.framingErrors);
+		AppendMetric(page, "actisense_serial_parity_errors_total", "counter", "Serial parity errors", serial.parityErrors);
+		AppendMetric(page, "actisense_serial_resyncs_total", "counter", "Partially received messages discarded", serial.resyncs);
+		AppendMetric(page, "actisense_serial_escape_errors_total", "counter", "Escape characters followed by an unexpected character", serial.escapeErrors);
+		AppendMetric(page, "actisense_serial_discarded_bytes_total", "counter", "Bytes received outside of any message", serial.discardedBytes);
+	}
+
+	return page;
+}
@@ -0,0 +1,255 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseNetworkMap - Devices discovered on the NMEA 2000 network
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+// Version History: 
+// 1.0 Initial Release
+// 1.1 Keyed by NAME, devices retain their details across address changes
+//
+
+#include "actisense_network.h"
+
+ActisenseNetworkMap::ActisenseNetworkMap(void) {
+	registry = new RegistryEntry[CONST_REGISTRY_SIZE];
+	for (int i = 0; i < CONST_REGISTRY_SIZE; i++) {
+		registry[i].information = {};
+		registry[i].information.networkAddress = CONST_NULL_ADDRESS;
+		registry[i].lock.store(0, std::memory_order_relaxed);
+		registry[i].inUse.store(FALSE, std::memory_order_relaxed);
+		registry[i].lastSeen.store(0, std::memory_order_relaxed);
+		registry[i].receivedFrames.store(0, std::memory_order_relaxed);
+	}
+	for (int i = 0; i < CONST_NETWORK_ADDRESSES; i++) {
+		addressSlots[i].store(NOT_FOUND, std::memory_order_relaxed);
+	}
+}
+
+ActisenseNetworkMap::~ActisenseNetworkMap(void) {
+	delete[] registry;
+}
+
+void ActisenseNetworkMap::BeginWrite(const int slot) {
+	registry[slot].lock.store(registry[slot].lock.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+void ActisenseNetworkMap::EndWrite(const int slot) {
+	registry[slot].lock.store(registry[slot].lock.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Prefer a slot that has never been used, otherwise the device that left the network longest ago
+int ActisenseNetworkMap::AllocateSlot(void) {
+	int oldest = NOT_FOUND;
+	for (int i = 0; i < CONST_REGISTRY_SIZE; i++) {
+		if (!registry[i].inUse.load(std::memory_order_relaxed)) {
+			return i;
+		}
+		if (registry[i].information.networkAddress == CONST_NULL_ADDRESS) {
+			if ((oldest == NOT_FOUND) || (registry[i].lastSeen.load(std::memory_order_relaxed) < registry[oldest].lastSeen.load(std::memory_order_relaxed))) {
+				oldest = i;
+			}
+		}
+	}
+	if (oldest != NOT_FOUND) {
+		FreeSlot(oldest);
+	}
+	return oldest;
+}
+
+void ActisenseNetworkMap::FreeSlot(const int slot) {
+	registry[slot].inUse.store(FALSE, std::memory_order_release);
+	if (registry[slot].information.deviceName != 0) {
+		nameSlots.erase(registry[slot].information.deviceName);
+	}
+	BeginWrite(slot);
+	registry[slot].information = {};
+	registry[slot].information.networkAddress = CONST_NULL_ADDRESS;
+	EndWrite(slot);
+	registry[slot].lastSeen.store(0, std::memory_order_relaxed);
+	registry[slot].receivedFrames.store(0, std::memory_order_relaxed);
+}
+
+// A device that has transmitted before we have seen its address claim, its NAME is filled in when it claims
+int ActisenseNetworkMap::GetAnonymousSlot(const byte networkAddress) {
+	int slot = addressSlots[networkAddress].load(std::memory_order_relaxed);
+	if (slot == NOT_FOUND) {
+		slot = AllocateSlot();
+		if (slot != NOT_FOUND) {
+			BeginWrite(slot);
+			registry[slot].information.networkAddress = networkAddress;
+			EndWrite(slot);
+			registry[slot].inUse.store(TRUE, std::memory_order_release);
+			addressSlots[networkAddress].store(slot, std::memory_order_release);
+		}
+	}
+	return slot;
+}
+
+void ActisenseNetworkMap::Touch(const byte networkAddress, const unsigned long long timestamp) {
+	if (networkAddress < CONST_NULL_ADDRESS) {
+		int slot = GetAnonymousSlot(networkAddress);
+		if (slot != NOT_FOUND) {
+			registry[slot].lastSeen.store(timestamp, std::memory_order_relaxed);
+			// Only the device thread writes, so no need for an atomic increment
+			registry[slot].receivedFrames.store(registry[slot].receivedFrames.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+	}
+}
+
+// Either a newly discovered device, a device resending its address claim, 
+// or a device that has moved to another address, possibly displacing the device that was using that address
+byte ActisenseNetworkMap::UpdateAddressClaim(const byte networkAddress, const DeviceInformation *deviceInformation) {
+	byte previousAddress = CONST_NULL_ADDRESS;
+
+	if ((networkAddress >= CONST_NULL_ADDRESS) || (deviceInformation->deviceName == 0)) {
+		return previousAddress;
+	}
+
+	int addressSlot = addressSlots[networkAddress].load(std::memory_order_relaxed);
+	int slot;
+	std::unordered_map<unsigned long long, int>::iterator it = nameSlots.find(deviceInformation->deviceName);
+	if (it != nameSlots.end()) {
+		slot = it->second;
+		// A device seen at this address before its claim is the device we already know, so discard the anonymous entry
+		if ((addressSlot != NOT_FOUND) && (addressSlot != slot) && (registry[addressSlot].information.deviceName == 0)) {
+			registry[slot].lastSeen.store(registry[addressSlot].lastSeen.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			addressSlots[networkAddress].store(NOT_FOUND, std::memory_order_release);
+			FreeSlot(addressSlot);
+			addressSlot = NOT_FOUND;
+		}
+	}
+	else if ((addressSlot != NOT_FOUND) && (registry[addressSlot].information.deviceName == 0)) {
+		// Adopt the anonymous entry
+		slot = addressSlot;
+		nameSlots[deviceInformation->deviceName] = slot;
+	}
+	else {
+		slot = AllocateSlot();
+		if (slot == NOT_FOUND) {
+			return previousAddress;
+		}
+		nameSlots[deviceInformation->deviceName] = slot;
+		registry[slot].inUse.store(TRUE, std::memory_order_release);
+	}
+
+	// Another device was using this address, it has lost it and must claim another
+	if ((addressSlot != NOT_FOUND) && (addressSlot != slot)) {
+		BeginWrite(addressSlot);
+		registry[addressSlot].information.networkAddress = CONST_NULL_ADDRESS;
+		EndWrite(addressSlot);
+	}
+
+	// This device has moved from another address
+	byte oldAddress = registry[slot].information.networkAddress;
+	if ((oldAddress != CONST_NULL_ADDRESS) && (oldAddress != networkAddress)) {
+		if (addressSlots[oldAddress].load(std::memory_order_relaxed) == slot) {
+			addressSlots[oldAddress].store(NOT_FOUND, std::memory_order_release);
+		}
+		previousAddress = oldAddress;
+	}
+
+	BeginWrite(slot);
+	registry[slot].information.deviceName = deviceInformation->deviceName;
+	registry[slot].information.uniqueId = deviceInformation->uniqueId;
+	registry[slot].information.manufacturerId = deviceInformation->manufacturerId;
+	if (previousAddress != CONST_NULL_ADDRESS) {
+		registry[slot].information.addressChanges++;
+	}
+	registry[slot].information.networkAddress = networkAddress;
+	EndWrite(slot);
+
+	addressSlots[networkAddress].store(slot, std::memory_order_release);
+
+	return previousAddress;
+}
+
+void ActisenseNetworkMap::UpdateProductInformation(const byte networkAddress, const ProductInformation *productInformation) {
+	if (networkAddress < CONST_NULL_ADDRESS) {
+		int slot = GetAnonymousSlot(networkAddress);
+		if (slot != NOT_FOUND) {
+			BeginWrite(slot);
+			registry[slot].information.productInformation = *productInformation;
+			EndWrite(slot);
+		}
+	}
+}
+
+void ActisenseNetworkMap::UpdateHeartbeat(const byte networkAddress, const unsigned int heartbeatInterval) {
+	if (networkAddress < CONST_NULL_ADDRESS) {
+		int slot = GetAnonymousSlot(networkAddress);
+		if ((slot != NOT_FOUND) && ((registry[slot].information.heartbeatInterval != heartbeatInterval) || (registry[slot].information.heartbeatExpired))) {
+			BeginWrite(slot);
+			registry[slot].information.heartbeatInterval = heartbeatInterval;
+			registry[slot].information.heartbeatExpired = FALSE;
+			EndWrite(slot);
+		}
+	}
+}
+
+void ActisenseNetworkMap::ExpireHeartbeat(const byte networkAddress) {
+	if (networkAddress < CONST_NULL_ADDRESS) {
+		int slot = addressSlots[networkAddress].load(std::memory_order_relaxed);
+		if (slot != NOT_FOUND) {
+			BeginWrite(slot);
+			registry[slot].information.heartbeatExpired = TRUE;
+			EndWrite(slot);
+		}
+	}
+}
+
+// Sequence lock read, retried if the device thread wrote the entry whilst it was being copied
+bool ActisenseNetworkMap::ReadSlot(const int slot, NetworkInformation *networkInformation) {
+	if ((slot < 0) || (slot >= CONST_REGISTRY_SIZE) || (!registry[slot].inUse.load(std::memory_order_acquire))) {
+		return FALSE;
+	}
+	while (TRUE) {
+		unsigned int before = registry[slot].lock.load(std::memory_order_acquire);
+		if ((before & 1) == 0) {
+			memcpy(networkInformation, &registry[slot].information, sizeof(NetworkInformation));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (registry[slot].lock.load(std::memory_order_relaxed) == before) {
+				break;
+			}
+		}
+		std::this_thread::yield();
+	}
+	networkInformation->timestamp = registry[slot].lastSeen.load(std::memory_order_relaxed);
+	networkInformation->receivedFrames = registry[slot].receivedFrames.load(std::memory_order_relaxed);
+	return TRUE;
+}
+
+bool ActisenseNetworkMap::Read(const byte networkAddress, NetworkInformation *networkInformation) {
+	int slot = addressSlots[networkAddress].load(std::memory_order_acquire);
+	if (slot == NOT_FOUND) {
+		return FALSE;
+	}
+	// The device may have moved in the meantime
+	return (ReadSlot(slot, networkInformation) && (networkInformation->networkAddress == networkAddress));
+}
+
+unsigned long long ActisenseNetworkMap::GetLastSeen(const byte networkAddress) {
+	int slot = addressSlots[networkAddress].load(std::memory_order_acquire);
+	return (slot != NOT_FOUND) ? registry[slot].lastSeen.load(std::memory_order_relaxed) : 0;
+}
@@ -51,7 +51,20 @@ const WCHAR *CONST_SERIAL_PORT_CONFIG = L"SOFTWARE\\Microsoft\\Windows NT\\Curre
 
 #endif
 
-ActisenseNGT1::ActisenseNGT1(wxMessageQueue<std::vector<byte>> *messageQueue) : ActisenseInterface(messageQueue) {
+ActisenseNGT1::ActisenseNGT1(ActisenseQueue *messageQueue) : ActisenseInterface(messageQueue), framer(messageQueue) {
+	readerStatistics = {};
+	serialStatistics = {};
+	lastSample = 0;
+	lastSampleBytes = 0;
+	lastCommand = 0;
+	programmedGeneration = 0;
+	observedGeneration = 0;
+	generationChanged = 0;
+	isListActive = FALSE;
+#ifdef __LINUX__
+	lastCounters = {};
+	hasCounters = FALSE;
+#endif
 }
 
 ActisenseNGT1::~ActisenseNGT1() {
@@ -173,7 +186,7 @@ int ActisenseNGT1::Open(const wxString& optionalPortName) {
 
 	// BUG BUG Could use the settings from the registry
 	// However 115200 is the factory default baud rate
-	serialPortSettings.BaudRate = 115200; // baudRate;
+	serialPortSettings.BaudRate = CONST_NGT_BAUD_RATE; // baudRate;
 	serialPortSettings.ByteSize = 8; // dataBits;
 	serialPortSettings.StopBits = 0; // 0 is one stop bit;
 	serialPortSettings.Parity = 0; //0 is no parity;
@@ -240,9 +253,6 @@ int ActisenseNGT1::Close(void) {
 
 // Reads data from the port and assembles into Actisense messages
 void ActisenseNGT1::Read() {
-	// used to construct valid Actisense messages
-	std::vector<byte> assemblyBuffer;
-	
 	// read 128 at a time ??
 	std::vector<byte> readBuffer(128,0);
 		
@@ -260,17 +270,19 @@ void ActisenseNGT1::Read() {
 	DWORD bytesRead = 0;
 #endif
 
-	// if we've found an ASCII Control Char DLE or ESC
-	bool isEscaped = false;
-	// if we've found an ASCII Control Char STX (preceded by a DLE)
-	// or a BEMSTART (preceded by an ESC)
-	bool msgStart = false;
-	// if we've found an ASCII Control Char ETX (also preceded by a DLE)
-	// or a BEMEND (preceded by an ESC)
-	bool msgComplete = false;
-	
+	// Messages are assembled and posted by the framer
+	framer.Reset();
+
 	// BUG BUG Debug logFile write
 	size_t logFileBytesWritten;
+
+	lastSample = TwoCanUtils::GetMonotonicMillis();
+
+	// The receive PGN list is programmed once the PGN filter has settled, then whenever it changes
+	pendingCommands.clear();
+	observedGeneration = pgnFilter.GetGeneration();
+	programmedGeneration = observedGeneration - 1;
+	generationChanged = 0;
 	
 	while (!TestDestroy()) {
 	
@@ -289,6 +301,11 @@ void ActisenseNGT1::Read() {
 #endif
 
 			if (bytesRead > 0) {
+
+				// The messages completed by this read are timed from here
+				unsigned long long readTime = TwoCanUtils::GetMonotonicMicros();
+
+				readerStatistics.rxBytes += bytesRead;
 				
 				// BUG BUG Log to file
 				if (logFile.IsOpened()) {
@@ -317,91 +334,22 @@ void ActisenseNGT1::Read() {
 				debugMutex->Unlock();
 				// end debug output
 
-				for (int i = 0; i < (int)bytesRead; i++) {
-
-					unsigned char ch = readBuffer.at(i);
-
-					// if last character was DLE or ESC
-					if (isEscaped) {
-						isEscaped = false;
-
-						// Message Start
-						if ((ch == STX) && (!msgStart)) {
-							msgStart = true;
-							msgComplete = false;
-							assemblyBuffer.clear();
-						}
-
-						// Message End
-						else if ((ch == ETX) && (msgStart)) {
-							msgComplete = true;
-							msgStart = false;
-						}
-
-						// Actisense Binary Encoded Message Start
-						else if ((ch == BEMSTART) && (!msgStart)) {
-							msgStart = true;
-							msgComplete = false;
-							assemblyBuffer.clear();
-						}
-
-						// Actisense Binary Encoded Message End
-						else if ((ch == BEMEND) && (msgStart)) {
-							msgComplete = true;
-							msgStart = false;
-						}
-
-						// Escaped DLE
-						else if ((ch == DLE) && (msgStart)) {
-							assemblyBuffer.push_back(ch);
-						}
-
-						// Escaped ESC
-						else if ((ch == ESC) && (msgStart)) {
-							assemblyBuffer.push_back(ch);
-						}
-
-						else {
-							// Can't have an escaped normal char
-							msgComplete = false;
-							msgStart = false;
-							assemblyBuffer.clear();
-						}
-					}
-					// Previous character was not a DLE or ESC
-					else {
-						if ((ch == DLE) || (ch == ESC)) {
-							isEscaped = true;
-						}
-						else if (msgStart) {
-							// a normal character
-							assemblyBuffer.push_back(ch);
-						}
-					}
-
-					if (msgComplete) {
-						// we have a complete frame, process it
-						// No idea why Hubert's adapter sends messages both with & without checksums !!
-						// Post the message for processing. Perform checksum validation later so that the 
-						// decoding functions can branch as appropriate
-						
-						deviceQueue->Post(assemblyBuffer);
-						
-						// Reset everything for next message
-						assemblyBuffer.clear();
-						msgStart = false;
-						msgComplete = false;
-						isEscaped = false;
-
-					}	// end if msgComplete
-
-				} // end for
+				framer.Process(readBuffer.data(), static_cast<size_t>(bytesRead), readTime);
 
 			} // end if bytes read > 0
 
 #ifdef __WXMSW__
 		} // end if ReadFile
 #endif
+
+		unsigned long long now = TwoCanUtils::GetMonotonicMillis();
+		if ((now - lastSample) >= CONST_SERIAL_SAMPLE_INTERVAL) {
+			SampleSerialCounters(now);
+		}
+
+		if (adapterFilter) {
+			ServiceRxPgns(now);
+		}
 							
 	} // end while 
 		
@@ -415,10 +363,71 @@ int ActisenseNGT1::Write(const unsigned int canId, const unsigned char payloadLe
 // Entry, the method that is executed upon thread start
 wxThread::ExitCode ActisenseNGT1::Entry() {
 	// Merely loops continuously waiting for frames to be received by the Actisense adapter
+	ACTISENSE_PROFILE_THREAD("NGT-1");
 	Read();
 	return (wxThread::ExitCode)TWOCAN_RESULT_SUCCESS;
 }
 
+// Throughput and utilisation of the serial link over the sample interval, and the errors the serial driver reports.
+// Bytes lost by the driver or UART only show up as resynchronisations or escape errors in the framing
+void ActisenseNGT1::SampleSerialCounters(const unsigned long long now) {
+	SerialStatistics previous = serialStatistics;
+
+	readerStatistics.resyncs = framer.GetResyncs();
+	readerStatistics.escapeErrors = framer.GetEscapeErrors();
+	readerStatistics.discardedBytes = framer.GetDiscardedBytes();
+
+	readerStatistics.bytesPerSecond = static_cast<unsigned int>(((readerStatistics.rxBytes - lastSampleBytes) * 1000) / (now - lastSample));
+	readerStatistics.utilisation = static_cast<int>((static_cast<unsigned long long>(readerStatistics.bytesPerSecond) * CONST_SERIAL_BITS_PER_BYTE * 100) / CONST_NGT_BAUD_RATE);
+	readerStatistics.peakBytesPerSecond = std::max(readerStatistics.peakBytesPerSecond, readerStatistics.bytesPerSecond);
+	readerStatistics.peakUtilisation = std::max(readerStatistics.peakUtilisation, readerStatistics.utilisation);
+	lastSample = now;
+	lastSampleBytes = readerStatistics.rxBytes;
+
+#ifdef __LINUX__
+	// Counters are cumulative since the port was opened
+	struct serial_icounter_struct counters;
+	if (ioctl(serialPortHandle, TIOCGICOUNT, &counters) == 0) {
+		if (hasCounters) {
+			readerStatistics.overruns += counters.overrun - lastCounters.overrun;
+			readerStatistics.bufferOverruns += counters.buf_overrun - lastCounters.buf_overrun;
+			readerStatistics.framingErrors += counters.frame - lastCounters.frame;
+			readerStatistics.parityErrors += counters.parity - lastCounters.parity;
+		}
+		lastCounters = counters;
+		hasCounters = TRUE;
+	}
+#endif
+
+#ifdef __WXMSW__
+	// Errors are reported, and cleared, once per sample interval rather than counted individually
+	DWORD errors = 0;
+	COMSTAT portStatus;
+	if (ClearCommError(serialPortHandle, &errors, &portStatus)) {
+		readerStatistics.overruns += (errors & CE_OVERRUN) ? 1 : 0;
+		readerStatistics.bufferOverruns += (errors & CE_RXOVER) ? 1 : 0;
+		readerStatistics.framingErrors += (errors & CE_FRAME) ? 1 : 0;
+		readerStatistics.parityErrors += (errors & CE_RXPARITY) ? 1 : 0;
+	}
+#endif
+
+	if ((readerStatistics.overruns != previous.overruns) || (readerStatistics.bufferOverruns != previous.bufferOverruns) || 
+		(readerStatistics.framingErrors != previous.framingErrors) || (readerStatistics.resyncs != previous.resyncs)) {
+		wxLogMessage(_T("Actisense NGT-1, Serial errors, Overruns: %llu, Buffer Overruns: %llu, Framing: %llu, Resyncs: %llu, Throughput: %u bytes/sec (%d%%)"),
+			readerStatistics.overruns, readerStatistics.bufferOverruns, readerStatistics.framingErrors, readerStatistics.resyncs,
+			readerStatistics.bytesPerSecond, readerStatistics.utilisation);
+	}
+
+	wxMutexLocker lock(statisticsMutex);
+	serialStatistics = readerStatistics;
+}
+
+bool ActisenseNGT1::GetSerialStatistics(SerialStatistics *statistics) {
+	wxMutexLocker lock(statisticsMutex);
+	*statistics = serialStatistics;
+	return TRUE;
+}
+
 // OnExit, called when thread is being destroyed
 void ActisenseNGT1::OnExit() {
 	wxLogMessage(_T("Actisense NGT-1, Read thread exiting."));
@@ -466,6 +475,164 @@ int ActisenseNGT1::ConfigureAdapter(void) {
 
 	wxLogMessage(_T("Actisense NGT-1, Sent NGT-1 Reset Sequence"));
 	wxMessageOutputDebug().Printf(_T("Actisense NGT-1, Sent NGT-1 Reset Sequence\n"));
+
+	// The receive PGN enable list is programmed by the read thread, see ServiceRxPgns
+	isListActive = FALSE;
+
+	return TWOCAN_RESULT_SUCCESS;
+}
+
+// At 115200 baud the serial link cannot carry a fully loaded 250 kbit/s NMEA 2000 network,
+// and the NGT-1 discards frames it cannot send. So limit what it sends to the PGN's that are used.
+// Note the Reset Sequence (above) has left the adapter receiving every PGN.
+// The commands are queued, and sent by ServiceRxPgns
+int ActisenseNGT1::ConfigureRxPgns(void) {
+	std::vector<unsigned int> pgns;
+
+	pendingCommands.clear();
+
+	// A subscriber wants raw messages, or there are more PGN's than the list holds
+	bool isReceiveAll = TRUE;
+	if (pgnFilter.IsAllEnabled()) {
+		wxLogMessage(_T("Actisense NGT-1, Receiving all PGN's"));
+	}
+	else {
+		pgnFilter.GetEnabledPgns(pgns);
+		if (pgns.size() > CONST_NGT_MAX_RX_PGNS) {
+			wxLogMessage(_T("Actisense NGT-1, Too many PGN's (%lu) for the receive PGN list, receiving all PGN's"), pgns.size());
+		}
+		else {
+			isReceiveAll = FALSE;
+		}
+	}
+
+	if (isReceiveAll) {
+		// Undo any list programmed previously
+		if (isListActive) {
+			pendingCommands.push_back({ NGT_CMD_OPERATING_MODE, NGT_MODE_RX_ALL & 0xFF, (NGT_MODE_RX_ALL >> 8) & 0xFF });
+			isListActive = FALSE;
+		}
+		return TWOCAN_RESULT_SUCCESS;
+	}
+
+	// Start with an empty receive list
+	pendingCommands.push_back({ NGT_CMD_DELETE_PGN_LIST, NGT_LIST_RX });
+
+	// PGN (little endian), enable, and a mask (little endian) with every bit of the PGN significant
+	for (auto it = pgns.begin(); it != pgns.end(); ++it) {
+		pendingCommands.push_back({ NGT_CMD_RX_PGN_ENABLE, 
+			static_cast<byte>(*it & 0xFF), static_cast<byte>((*it >> 8) & 0xFF), static_cast<byte>((*it >> 16) & 0xFF), 0x00,
+			0x01, 
+			0xFF, 0xFF, 0xFF, 0xFF });
+	}
+
+	// Apply the lists, then only pass the PGN's in the receive list
+	pendingCommands.push_back({ NGT_CMD_ACTIVATE_PGN_LISTS });
+	pendingCommands.push_back({ NGT_CMD_OPERATING_MODE, NGT_MODE_RX_LIST & 0xFF, (NGT_MODE_RX_LIST >> 8) & 0xFF });
+	isListActive = TRUE;
+
+	wxLogMessage(_T("Actisense NGT-1, Programming receive PGN list (%lu PGN's)"), pgns.size());
+	wxMessageOutputDebug().Printf(_T("Actisense NGT-1, Programming receive PGN list (%lu PGN's)\n"), pgns.size());
+	return TWOCAN_RESULT_SUCCESS;
+}
+
+// Subscribers may enable further PGN's at any time, so rather than sleeping between commands in Open,
+// the read thread sends one command every CONST_NGT_COMMAND_DELAY milliseconds between reads
+void ActisenseNGT1::ServiceRxPgns(const unsigned long long now) {
+	if (!pendingCommands.empty()) {
+		if ((now - lastCommand) >= CONST_NGT_COMMAND_DELAY) {
+			if (WriteCommand(pendingCommands.front()) != TWOCAN_RESULT_SUCCESS) {
+				// Not fatal, receive every PGN rather than a partially programmed list
+				wxLogMessage(_T("Actisense NGT-1, Error programming receive PGN list, receiving all PGN's"));
+				pendingCommands.clear();
+				isListActive = FALSE;
+				WriteCommand({ NGT_CMD_OPERATING_MODE, NGT_MODE_RX_ALL & 0xFF, (NGT_MODE_RX_ALL >> 8) & 0xFF });
+				return;
+			}
+			pendingCommands.pop_front();
+			lastCommand = now;
+		}
+		// Any change whilst programming is picked up once the current list has been sent
+		return;
+	}
+
+	unsigned int generation = pgnFilter.GetGeneration();
+	if (generation != observedGeneration) {
+		observedGeneration = generation;
+		generationChanged = now;
+		return;
+	}
+
+	if ((generation != programmedGeneration) && ((now - generationChanged) >= CONST_NGT_FILTER_SETTLE)) {
+		programmedGeneration = generation;
+		ConfigureRxPgns();
+	}
+}
+
+// Actisense BST framing, refer to Canboat. DLE STX, the NGT_TX_CMD, the length of the command, the command,
+// a checksum such that the sum of every byte from the NGT_TX_CMD onwards is zero, then DLE ETX.
+// Any DLE within the message is escaped by a second DLE
+void ActisenseNGT1::EncodeCommand(const std::vector<byte>& command, std::vector<byte>& writeBuffer) {
+	std::vector<byte> message;
+	byte checksum = 0;
+
+	writeBuffer.assign({ DLE, STX });
+
+	message.push_back(NGT_TX_CMD);
+	message.push_back(static_cast<byte>(command.size()));
+	message.insert(message.end(), command.begin(), command.end());
+
+	for (auto it = message.begin(); it != message.end(); ++it) {
+		checksum += *it;
+	}
+	message.push_back(static_cast<byte>(0x100 - checksum));
+
+	for (auto it = message.begin(); it != message.end(); ++it) {
+		writeBuffer.push_back(*it);
+		if (*it == DLE) {
+			writeBuffer.push_back(DLE);
+		}
+	}
+	writeBuffer.push_back(DLE);
+	writeBuffer.push_back(ETX);
+}
+
+int ActisenseNGT1::WriteCommand(const std::vector<byte>& command) {
+	std::vector<byte> writeBuffer;
+
+	EncodeCommand(command, writeBuffer);
+
+#ifdef __WXMSW__
+	DWORD bytesWritten = 0;
+	
+	WriteFile(serialPortHandle, writeBuffer.data(), writeBuffer.size(), &bytesWritten, NULL);
+	
+	if (bytesWritten == 0) {
+		int err = GetLastError();
+		wxLogMessage(_T("Actisense NGT-1, Error sending NGT-1 command 0x%02X: %d"), command.front(), err);
+		wxMessageOutputDebug().Printf(_T("Actisense NGT-1, Error sending NGT-1 command 0x%02X: %d\n"), command.front(), err);
+		return SET_ERROR(TWOCAN_RESULT_ERROR , TWOCAN_SOURCE_DRIVER , TWOCAN_ERROR_CONFIGURE_ADAPTER);
+	}
+
+#endif
+
+#ifdef __LINUX__
+
+	int bytesWritten = 0;
+
+	bytesWritten = write(serialPortHandle, writeBuffer.data(), writeBuffer.size());
+	
+	if (bytesWritten == -1) {
+		wxLogMessage(_T("Actisense NGT-1, Error sending NGT-1 command 0x%02X: %d"), command.front(), errno);
+		wxMessageOutputDebug().Printf(_T("Actisense NGT-1, Error sending NGT-1 command 0x%02X: %d\n"), command.front(), errno);
+		return SET_ERROR(TWOCAN_RESULT_ERROR , TWOCAN_SOURCE_DRIVER , TWOCAN_ERROR_CONFIGURE_ADAPTER);
+	}
+#endif
+
+#ifdef __WXOSX__
+	// ToDo 
+#endif
+
 	return TWOCAN_RESULT_SUCCESS;
 }
 
@@ -0,0 +1,152 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseNgtStatus - Decodes NGT-1 command responses and status
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+// Version History: 
+// 1.0 Initial Release
+//
+
+#include "actisense_ngtstatus.h"
+
+ActisenseNgtStatus::ActisenseNgtStatus(void) {
+	statistics = {};
+}
+
+ActisenseNgtStatus::~ActisenseNgtStatus(void) {
+}
+
+// receivedFrame[0] - NGT_RX_CMD
+// receivedFrame[1] - Length, excludes the command, length and checksum
+// receivedFrame[2] - Response id
+// receivedFrame[3] - SID
+// receivedFrame[4..5] - Model id
+// receivedFrame[6..9] - Serial number
+// receivedFrame[10..13] - Error code
+// receivedFrame[14..n-1] - Response data
+// receivedFrame[n] - Checksum, ensures sum of all bytes modulo 256 == 0
+void ActisenseNgtStatus::ProcessResponse(const std::vector<byte>& receivedFrame) {
+	statistics.responses++;
+
+	if ((receivedFrame.size() < 3) || (receivedFrame[1] != receivedFrame.size() - 3)) {
+		statistics.invalidResponses++;
+		return;
+	}
+
+	if (TwoCanUtils::ActisenseChecksum(receivedFrame.data(), receivedFrame.size()) != 0) {
+		statistics.invalidResponses++;
+		return;
+	}
+
+	const byte *response = &receivedFrame[2];
+	size_t length = receivedFrame[1];
+
+	// Acknowledgements of the configuration commands have no data
+	if (length < CONST_NGT_RESPONSE_HEADER) {
+		return;
+	}
+
+	statistics.modelId = response[2] | (response[3] << 8);
+	statistics.serialNumber = response[4] | (response[5] << 8) | (response[6] << 16) | (response[7] << 24);
+	unsigned int errorCode = response[8] | (response[9] << 8) | (response[10] << 16) | (response[11] << 24);
+	if (errorCode != statistics.errorCode) {
+		wxLogMessage(_T("Actisense NGT-1, Error code 0x%08X"), errorCode);
+		statistics.errorCode = errorCode;
+	}
+
+	const byte *data = response + CONST_NGT_RESPONSE_HEADER;
+	length -= CONST_NGT_RESPONSE_HEADER;
+
+	switch (response[0]) {
+		case NGT_MSG_OPERATING_MODE:
+			if (length >= 2) {
+				statistics.operatingMode = data[0] | (data[1] << 8);
+				wxLogMessage(_T("Actisense NGT-1, Operating mode 0x%04X"), statistics.operatingMode);
+			}
+			break;
+		case NGT_MSG_STARTUP_STATUS:
+			wxLogMessage(_T("Actisense NGT-1, Started, Model: %u, Serial Number: %u"), statistics.modelId, statistics.serialNumber);
+			break;
+		case NGT_MSG_ERROR_REPORT:
+			wxLogMessage(_T("Actisense NGT-1, Error report 0x%08X"), errorCode);
+			break;
+		case NGT_MSG_SYSTEM_STATUS:
+			DecodeSystemStatus(data, length);
+			break;
+		default:
+			break;
+	}
+}
+
+// The independent channel count and channels, followed by the unified channel count and channels.
+// Each status reports the frames filtered, dropped and deleted since the previous status
+void ActisenseNgtStatus::DecodeSystemStatus(const byte *data, const size_t length) {
+	if (length < 1) {
+		statistics.invalidResponses++;
+		return;
+	}
+
+	size_t indiChannels = data[0];
+	size_t uniOffset = 1 + (indiChannels * CONST_NGT_INDI_CHANNEL_LENGTH);
+	if ((length < uniOffset + 1) || (length < uniOffset + 1 + (data[uniOffset] * CONST_NGT_UNI_CHANNEL_LENGTH))) {
+		statistics.invalidResponses++;
+		return;
+	}
+	size_t uniChannels = data[uniOffset];
+
+	statistics.statusReports++;
+
+	int rxLoad = 0;
+	int txLoad = 0;
+	unsigned int dropped = 0;
+	for (size_t i = 0; i < indiChannels; i++) {
+		const byte *channel = &data[1 + (i * CONST_NGT_INDI_CHANNEL_LENGTH)];
+		rxLoad = std::max(rxLoad, static_cast<int>(channel[1]));
+		statistics.rxFiltered += channel[2];
+		dropped += channel[3];
+		txLoad = std::max(txLoad, static_cast<int>(channel[5]));
+	}
+
+	int bufferLoading = 0;
+	unsigned int deleted = 0;
+	for (size_t i = 0; i < uniChannels; i++) {
+		const byte *channel = &data[uniOffset + 1 + (i * CONST_NGT_UNI_CHANNEL_LENGTH)];
+		deleted += channel[1];
+		bufferLoading = std::max(bufferLoading, static_cast<int>(channel[2]));
+	}
+
+	if ((dropped > 0) || (deleted > 0)) {
+		wxLogMessage(_T("Actisense NGT-1, Adapter lost frames, Dropped: %u, Deleted: %u, Rx Load: %d%%, Buffer Loading: %d%%"), 
+			dropped, deleted, rxLoad, bufferLoading);
+	}
+
+	statistics.rxDropped += dropped;
+	statistics.deleted += deleted;
+	statistics.rxLoad = rxLoad;
+	statistics.txLoad = txLoad;
+	statistics.bufferLoading = bufferLoading;
+	statistics.maximumRxLoad = std::max(statistics.maximumRxLoad, rxLoad);
+	statistics.maximumBufferLoading = std::max(statistics.maximumBufferLoading, bufferLoading);
+}
@@ -0,0 +1,95 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisensePgnFilter - Drops frames for unwanted PGN's at the framing layer
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+// Version History: 
+// 1.0 Initial Release
+//
+
+#include "actisense_pgnfilter.h"
+
+ActisensePgnFilter::ActisensePgnFilter(void) {
+	generation = 0;
+	EnableAll();
+	filteredFrames = 0;
+}
+
+ActisensePgnFilter::~ActisensePgnFilter(void) {
+}
+
+void ActisensePgnFilter::EnableAll(void) {
+	for (int i = 0; i < CONST_PGN_SPACE / 32; i++) {
+		bitmap[i].store(0xFFFFFFFF, std::memory_order_relaxed);
+	}
+	generation.fetch_add(1, std::memory_order_release);
+}
+
+void ActisensePgnFilter::DisableAll(void) {
+	for (int i = 0; i < CONST_PGN_SPACE / 32; i++) {
+		bitmap[i].store(0, std::memory_order_relaxed);
+	}
+	generation.fetch_add(1, std::memory_order_release);
+}
+
+void ActisensePgnFilter::Enable(const unsigned int pgn) {
+	unsigned int bit = 1U << (pgn & 0x1F);
+	if ((bitmap[(pgn & CONST_PGN_MASK) >> 5].fetch_or(bit, std::memory_order_relaxed) & bit) == 0) {
+		generation.fetch_add(1, std::memory_order_release);
+	}
+}
+
+bool ActisensePgnFilter::IsAllEnabled(void) const {
+	for (int i = 0; i < CONST_PGN_SPACE / 32; i++) {
+		if (bitmap[i].load(std::memory_order_relaxed) != 0xFFFFFFFF) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+void ActisensePgnFilter::GetEnabledPgns(std::vector<unsigned int>& pgns) const {
+	pgns.clear();
+	for (int i = 0; i < CONST_PGN_SPACE / 32; i++) {
+		unsigned int word = bitmap[i].load(std::memory_order_relaxed);
+		// Most of the PGN space is unused, so skip the empty words
+		for (int j = 0; (word != 0) && (j < 32); j++, word >>= 1) {
+			if (word & 1) {
+				pgns.push_back((i << 5) | j);
+			}
+		}
+	}
+}
+
+// The overall length byte is optional, see TwoCanUtils::DecodeActisenseHeader. 
+// When present it is at least 11 (priority, PGN, destination, source, timestamp & data length),
+// whereas a priority is never more than 7
+bool ActisensePgnFilter::IsEnabled(const std::vector<byte>& message) const {
+	if ((message.size() < CONST_PEEK_LENGTH) || (message[0] != N2K_RX_CMD)) {
+		return TRUE;
+	}
+	int offset = (message[1] > 7) ? 1 : 0;
+	return IsEnabled(message[2 + offset] | (message[3 + offset] << 8) | (message[4 + offset] << 16));
+}
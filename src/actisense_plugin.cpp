@@ -31,28 +31,17 @@
 #include "actisense_plugin.h"
 #include "actisense_icons.h"
 
-// Globally accessible variables used by the plugin, device and the settings dialog.
+// Globally accessible variables used by the plugin and the settings dialog.
+// Those shared with the device are defined in the core library, see actisense_core.cpp
 wxFileConfig *configSettings;
-wxString canAdapter;
-wxString adapterPortName;
-int supportedPGN;
-bool deviceMode;
-bool debugWindowActive;
-bool enableHeartbeat;
-bool enableGateway;
-bool enableSignalK;
 bool enableExcel;
 bool enableInfluxDB;
-bool actisenseChecksum;
-int logLevel;
-// global mutex used to control debug output (prevents interleaving of debug output)
-wxMutex *debugMutex;
-
-
-
-unsigned long uniqueId;
-int networkAddress;
-NetworkInformation networkMap[CONST_MAX_DEVICES];
+// Sentence types pushed to OpenCPN, no UI, set manually in the config file
+wxString sentenceTypes;
+// Prometheus metrics endpoint, no UI, set manually in the config file
+bool enableMetrics;
+int metricsPort;
+wxString metricsSocket;
 
 // The class factories, used to create and destroy instances of the PlugIn
 extern "C" DECL_EXP opencpn_plugin* create_pi(void *ppimgr) {
@@ -70,15 +59,11 @@ Actisense::Actisense(void *ppimgr) : opencpn_plugin_18(ppimgr), wxEvtHandler() {
 	Connect(wxEVT_SENTENCE_RECEIVED_EVENT, wxCommandEventHandler(Actisense::OnSentenceReceived));
 	// Load the plugin bitmaps/icons 
 	initialize_images();
-	
-	debugMutex = new wxMutex();
 }
 
 Actisense::~Actisense(void) {
 	// Disconnect the event handler
 	Disconnect(wxEVT_SENTENCE_RECEIVED_EVENT, wxCommandEventHandler(Actisense::OnSentenceReceived));
-	
-	delete debugMutex;
 }
 
 int Actisense::Init(void) {
@@ -97,15 +82,30 @@ int Actisense::Init(void) {
 	// Initialize Actisense to a nullptr to prevent crashes when trying to stop an unitialized device
 	// which is what happens upon first startup. Bugger, there must be a better way.
 	actisenseDevice = nullptr;
+	metricsServer = nullptr;
 
 	// Toggles display of captured NMEA 2000 frames in the "debug" tab of the preferences dialog
 	debugWindowActive = FALSE;
 
 	// Load the configuration items
-	if (LoadConfiguration()) {
+	bool isConfigured = LoadConfiguration();
+
+	// Receive the NMEA 0183 sentences from the message bus. 
+	// Only the sentence types that we, or another subscriber, want are formatted by the device
+	BusFilter sentenceFilter = {};
+	sentenceFilter.sentenceTypes = ActisenseBus::ParseSentenceTypes(sentenceTypes);
+	sentenceFilter.sentencesOnly = TRUE;
+	sentenceSubscription = new ActisenseSubscription(_T("OpenCPN"), sentenceFilter, CONST_SUBSCRIPTION_SIZE, this, wxEVT_SENTENCE_RECEIVED_EVENT, SENTENCE_RECEIVED_EVENT);
+	messageBus.Subscribe(sentenceSubscription);
+
+	if (isConfigured) {
 		// Start the Actisense Device which will in turn load either the NGT-1 device or the EBL Log File device
 		StartDevice();
 	}
+
+	if (enableMetrics) {
+		StartMetrics();
+	}
 	
 	// Notify OpenCPN what events we want to receive callbacks for
 	// WANTS_NMEA_SENTENCES could be used for future versions where we might convert NMEA 0183 sentences to NMEA 2000
@@ -126,6 +126,13 @@ bool Actisense::DeInit(void) {
 	// Terminate the Actisense Device Thread
 	StopDevice();
 
+	StopMetrics();
+
+	// A doorbell event may still be queued, OnSentenceReceived ignores it once the subscription has gone
+	messageBus.Unsubscribe(sentenceSubscription);
+	delete sentenceSubscription;
+	sentenceSubscription = NULL;
+
 	return TRUE;
 }
 
@@ -180,16 +187,28 @@ void Actisense::SetNMEASentence(wxString &sentence) {
 	}
 }
 
-// Frame received event handler. Events queued from Actisense Device.
-// NMEA 0183 sentences are passed via the SetString()/GetString() functions
+// Sentence received event handler. Raised by the message bus when sentences are waiting in our subscription,
+// a single event may be followed by many messages, each with one or more NMEA 0183 sentences
 void Actisense::OnSentenceReceived(wxCommandEvent &event) {
 	switch (event.GetId()) {
 	case SENTENCE_RECEIVED_EVENT:
-		PushNMEABuffer(event.GetString());
-		// If the preference dialog is open and the debug tab is toggled, display the NMEA 183 sentences
-		// Superfluous as they can be seen in the Connections tab.
-		if ((debugWindowActive) && (settingsDialog != NULL)) {
-			settingsDialog->txtDebug->AppendText(event.GetString());
+		if (sentenceSubscription == NULL) {
+			break;
+		}
+		sentenceSubscription->Acknowledge();
+		while (sentenceSubscription->Receive(sentenceBatch, CONST_BUS_BATCH) > 0) {
+			for (std::vector<BusMessagePtr>::iterator message = sentenceBatch.begin(); message != sentenceBatch.end(); ++message) {
+				for (std::vector<wxString>::const_iterator it = (*message)->sentences.begin(); it != (*message)->sentences.end(); ++it) {
+					PushNMEABuffer(*it);
+					// If the preference dialog is open and the debug tab is toggled, display the NMEA 183 sentences
+					// Superfluous as they can be seen in the Connections tab.
+					if ((debugWindowActive) && (settingsDialog != NULL)) {
+						settingsDialog->txtDebug->AppendText(*it);
+					}
+				}
+				frameTracer.Deliver((*message)->traceId);
+			}
+			sentenceBatch.clear();
 		}
 		break;
 	default:
@@ -239,6 +258,15 @@ bool Actisense::LoadConfiguration(void) {
 		configSettings->Read(_T("Heartbeat"), &enableHeartbeat, FALSE);
 		configSettings->Read(_T("Gateway"), &enableGateway, FALSE);
 		configSettings->Read(_T("Checksum"), &actisenseChecksum, TRUE);
+		configSettings->Read(_T("QueuePolicy"), &queuePolicy, QUEUE_POLICY_DROP_OLDEST);
+		configSettings->Read(_T("QueueSize"), &queueSize, CONST_QUEUE_SIZE);
+		configSettings->Read(_T("Sentences"), &sentenceTypes, _T(""));
+		configSettings->Read(_T("AdapterFilter"), &adapterFilter, TRUE);
+		configSettings->Read(_T("Metrics"), &enableMetrics, FALSE);
+		configSettings->Read(_T("MetricsPort"), &metricsPort, CONST_METRICS_PORT);
+		configSettings->Read(_T("MetricsSocket"), &metricsSocket, _T(""));
+		configSettings->Read(_T("TraceSampling"), &traceSampling, 0);
+		configSettings->Read(_T("TraceFile"), &traceFile, _T(""));
 		return TRUE;
 	}
 	else {
@@ -252,6 +280,15 @@ bool Actisense::LoadConfiguration(void) {
 		enableHeartbeat = FALSE;
 		enableGateway = FALSE;
 		actisenseChecksum = TRUE;
+		queuePolicy = QUEUE_POLICY_DROP_OLDEST;
+		queueSize = CONST_QUEUE_SIZE;
+		sentenceTypes = _T("");
+		adapterFilter = TRUE;
+		enableMetrics = FALSE;
+		metricsPort = CONST_METRICS_PORT;
+		metricsSocket = _T("");
+		traceSampling = 0;
+		traceFile = _T("");
 		return TRUE;
 	}
 }
@@ -261,7 +298,12 @@ bool Actisense::SaveConfiguration(void) {
 		configSettings->SetPath(_T("/PlugIns/Actisense"));
 		// No UI for setting the adapterPortName (AlternativePort). It is set manually to override 
 		// the default automatic detection of the serial port or tty device. 
-		// Similarly no UI for setting the value of actisenseChecksum (Checksum)
+		// Similarly no UI for setting the value of actisenseChecksum (Checksum), 
+		// nor the queue's overload policy (QueuePolicy) and size (QueueSize),
+		// nor the sentence types pushed to OpenCPN (Sentences), eg. "HDT,GLL,VTG", empty for all,
+		// nor whether the NGT-1's receive PGN enable list is programmed (AdapterFilter),
+		// nor the Prometheus metrics endpoint (Metrics), its localhost port (MetricsPort) or Unix domain socket (MetricsSocket),
+		// nor frame latency tracing, one in every TraceSampling frames, and its Chrome trace file (TraceFile)
 		configSettings->Write(_T("Adapter"), canAdapter);
 		configSettings->Write(_T("PGN"), supportedPGN);
 		configSettings->Write(_T("Log"), logLevel);
@@ -296,7 +338,55 @@ void Actisense::StopDevice(void) {
 			
 			// can only delete the interface if it is a joinable thread.
 			delete actisenseDevice;
+
+			// The device has stopped, so the traces are complete
+			if (frameTracer.IsEnabled()) {
+				frameTracer.LogIntervals();
+				if (!traceFile.IsEmpty()) {
+					frameTracer.WriteChromeTrace(traceFile);
+				}
+			}
+
+#ifdef ACTISENSE_PROFILE
+			ActisenseProfiler::WriteCollapsedStacks(CONST_PROFILE_FILE);
+#endif
+		}
+	}
+}
+
+void Actisense::StartMetrics(void) {
+	metricsServer = new ActisenseMetrics();
+	int returnCode = metricsServer->Init();
+	if ((returnCode & TWOCAN_RESULT_FATAL) == TWOCAN_RESULT_FATAL) {
+		wxLogError(_T("Actisense Plugin, Error initializing metrics (%lu)"), returnCode);
+		delete metricsServer;
+		metricsServer = nullptr;
+	}
+	else {
+		int threadResult = metricsServer->Run();
+		if (threadResult == wxTHREAD_NO_ERROR) {
+			wxLogMessage(_T("Actisense Plugin, Successfully created metrics thread"));
+		}
+		else {
+			wxLogError(_T("Actisense Plugin, Error creating metrics thread (%lu)"), threadResult);
+			metricsServer->DeInit();
+			delete metricsServer;
+			metricsServer = nullptr;
+		}
+	}
+}
+
+void Actisense::StopMetrics(void) {
+	wxThread::ExitCode threadExitCode;
+	if (metricsServer != nullptr) {
+		if (metricsServer->IsRunning()) {
+			metricsServer->Delete(&threadExitCode, wxTHREAD_WAIT_BLOCK);
+			// wait for the metrics thread to exit
+			metricsServer->Wait(wxTHREAD_WAIT_BLOCK);
 		}
+		metricsServer->DeInit();
+		delete metricsServer;
+		metricsServer = nullptr;
 	}
 }
 
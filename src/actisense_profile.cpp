@@ -0,0 +1,118 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseProfiler - Scoped profiling zones and collapsed stack export
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+
+#include "actisense_profile.h"
+
+thread_local ActisenseProfiler *ActisenseProfiler::threadProfiler = NULL;
+wxMutex ActisenseProfiler::profilersMutex;
+std::vector<ActisenseProfiler *> ActisenseProfiler::profilers;
+
+ActisenseProfiler::ActisenseProfiler(void) {
+	ProfileNode root = {};
+	root.parent = -1;
+	nodes.push_back(root);
+	currentNode = 0;
+	threadName = std::string("Thread ") + std::to_string(wxThread::GetCurrentId());
+}
+
+// The profiles are never deleted, a thread that is restarted (eg. when the settings change) gets a new one
+ActisenseProfiler *ActisenseProfiler::GetThreadProfiler(void) {
+	if (threadProfiler == NULL) {
+		threadProfiler = new ActisenseProfiler();
+		wxMutexLocker lock(profilersMutex);
+		profilers.push_back(threadProfiler);
+	}
+	return threadProfiler;
+}
+
+void ActisenseProfiler::SetThreadName(const char *name) {
+	GetThreadProfiler()->threadName = name;
+}
+
+// A handful of children at most, so a linear search of the names' addresses is quicker than hashing
+int ActisenseProfiler::Enter(const char *name) {
+	std::vector<int>& children = nodes[currentNode].children;
+	for (std::vector<int>::const_iterator it = children.begin(); it != children.end(); ++it) {
+		if (nodes[*it].name == name) {
+			currentNode = *it;
+			return currentNode;
+		}
+	}
+	ProfileNode child = {};
+	child.name = name;
+	child.parent = currentNode;
+	nodes.push_back(child);
+	int node = (int)nodes.size() - 1;
+	nodes[currentNode].children.push_back(node);
+	currentNode = node;
+	return node;
+}
+
+void ActisenseProfiler::Exit(const int node, const unsigned long long elapsed) {
+	nodes[node].calls++;
+	nodes[node].elapsed += elapsed;
+	currentNode = nodes[node].parent;
+}
+
+// Self time is the node's time less that of its children
+void ActisenseProfiler::AppendStacks(wxFile& file, const int node, const std::string& stack) {
+	unsigned long long selfTime = nodes[node].elapsed;
+	for (std::vector<int>::const_iterator it = nodes[node].children.begin(); it != nodes[node].children.end(); ++it) {
+		selfTime -= std::min(selfTime, nodes[*it].elapsed);
+		AppendStacks(file, *it, stack + ";" + nodes[*it].name);
+	}
+	if ((node > 0) && (selfTime > 0)) {
+		file.Write(wxString::Format("%s %llu\n", stack.c_str(), selfTime));
+	}
+}
+
+int ActisenseProfiler::WriteCollapsedStacks(const wxString& fileName) {
+	wxFileName profileFileName(fileName);
+	if (profileFileName.IsRelative()) {
+		profileFileName.MakeAbsolute(wxStandardPaths::Get().GetDocumentsDir());
+	}
+
+	wxFile profileFile;
+	if (!profileFile.Open(profileFileName.GetFullPath(), wxFile::write)) {
+		wxLogError(_T("Actisense Profiler, Unable to create profile %s"), profileFileName.GetFullPath());
+		return SET_ERROR(TWOCAN_RESULT_ERROR, TWOCAN_SOURCE_DEVICE, TWOCAN_ERROR_PATH_NOT_FOUND);
+	}
+
+	wxMutexLocker lock(profilersMutex);
+	for (std::vector<ActisenseProfiler *>::iterator it = profilers.begin(); it != profilers.end(); ++it) {
+		// Spaces and semicolons separate the stack's counts and frames
+		std::string threadName = (*it)->threadName;
+		std::replace(threadName.begin(), threadName.end(), ' ', '_');
+		std::replace(threadName.begin(), threadName.end(), ';', '_');
+		(*it)->AppendStacks(profileFile, 0, threadName);
+	}
+	profileFile.Close();
+
+	wxLogMessage(_T("Actisense Profiler, Wrote %s"), profileFileName.GetFullPath());
+	return TWOCAN_RESULT_SUCCESS;
+}
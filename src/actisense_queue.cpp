@@ -0,0 +1,382 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseQueue - Bounded queue between the interfaces and the Actisense device
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+// Version History: 
+// 1.0 Initial Release
+// 1.1 Priority lanes for safety PGN's
+//
+// When OpenCPN stalls or an EBL log is replayed faster than it can be decoded, an unbounded
+// queue grows without limit. This queue has a fixed capacity and an explicit overload policy.
+// Frames are held in priority lanes, safety PGN's are always dequeued first
+
+#include "actisense_queue.h"
+
+ActisenseQueue::ActisenseQueue(const size_t capacity, const int policy) : queueCondition(queueMutex) {
+	this->capacity = (capacity < CONST_MIN_QUEUE_SIZE) ? CONST_MIN_QUEUE_SIZE : capacity;
+	this->policy = policy;
+	count = 0;
+	headSequence = 0;
+	tailSequence = 0;
+	highWaterMark = 0;
+	droppedFrames = 0;
+	coalescedFrames = 0;
+	for (int i = 0; i < PGN_CLASSES; i++) {
+		droppedClassFrames[i] = 0;
+	}
+	for (int i = 0; i < QUEUE_LANES; i++) {
+		laneStatistics[i].frames = 0;
+		laneStatistics[i].totalLatency = 0;
+		laneStatistics[i].maximumLatency = 0;
+	}
+}
+
+ActisenseQueue::~ActisenseQueue(void) {
+}
+
+// Classify a PGN so that the least important frames are discarded first.
+// Only navigation PGN's are coalesced, as their latest value supersedes any earlier value. 
+// Bulk PGN's (engines, tanks, batteries, rudders) often carry several instances from the one source
+int ActisenseQueue::GetPGNClass(const unsigned int pgn) {
+	switch (pgn) {
+		case 129798: // AIS SAR Aircraft Position Report
+		case 129801: // AIS Addressed Safety Related Message
+		case 129802: // AIS Safety Related Broadcast Message
+		case 129808: // DSC Message
+			return PGN_CLASS_SAFETY;
+		case 59392: // ISO Acknowledgement
+		case 59904: // ISO Request
+		case 60160: // ISO Transport Protocol, Data Transfer
+		case 60416: // ISO Transport Protocol, Connection Management
+		case 60928: // ISO Address Claim
+		case 65240: // ISO Commanded Address
+		case 126464: // Supported PGN's
+		case 126993: // Heartbeat
+		case 126996: // Product Information
+			return PGN_CLASS_NETWORK;
+		case 129038: // AIS Class A Position Report
+		case 129039: // AIS Class B Position Report
+		case 129040: // AIS Class B Extended Position Report
+		case 129041: // AIS AToN Report
+		case 129793: // AIS Date and Time Report
+		case 129794: // AIS Class A Static Data
+		case 129809: // AIS Class B Static Data, Part A
+		case 129810: // AIS Class B Static Data, Part B
+			return PGN_CLASS_AIS;
+		case 126992: // System Time
+		case 127250: // Heading
+		case 127251: // Rate of Turn
+		case 127257: // Attitude
+		case 127258: // Magnetic Variation
+		case 128259: // Speed
+		case 128267: // Depth
+		case 128275: // Distance Log
+		case 129025: // Position Rapid Update
+		case 129026: // COG & SOG Rapid Update
+		case 129029: // GNSS Position
+		case 129033: // Date & Time
+		case 129283: // Cross Track Error
+		case 129284: // Navigation Data
+		case 129285: // Route & Waypoint Information
+		case 130306: // Wind
+		case 130577: // Direction Data
+			return PGN_CLASS_NAVIGATION;
+		default:
+			return PGN_CLASS_BULK;
+	}
+}
+
+// AIS and navigation data share the normal lane with bulk data so that their relative order is preserved
+int ActisenseQueue::GetLane(const int pgnClass) {
+	switch (pgnClass) {
+		case PGN_CLASS_SAFETY:
+			return QUEUE_LANE_SAFETY;
+		case PGN_CLASS_NETWORK:
+			return QUEUE_LANE_NETWORK;
+		default:
+			return QUEUE_LANE_NORMAL;
+	}
+}
+
+// Add a frame to the queue. If the queue is full, apply the overload policy
+wxMessageQueueError ActisenseQueue::Post(const std::vector<byte>& frame) {
+	return Post(frame, 0);
+}
+
+wxMessageQueueError ActisenseQueue::Post(const std::vector<byte>& frame, const unsigned long long readTime) {
+	QueueEntry entry;
+	CanHeader header;
+
+	entry.isRaw = ((!frame.empty()) && (frame[0] == CAN_RX_CMD));
+	if (TwoCanUtils::DecodeActisenseHeader(frame.data(), frame.size(), &header)) {
+		// Raw CAN frames may be fragments of a multi frame message, so are never coalesced
+		entry.key = entry.isRaw ? 0 : (header.pgn << 8) | header.source;
+		entry.pgnClass = GetPGNClass(header.pgn);
+	}
+	else {
+		// NGT-1 responses etc. are treated as network management
+		entry.key = 0;
+		entry.pgnClass = PGN_CLASS_NETWORK;
+	}
+
+	wxMutexLocker lock(queueMutex);
+
+	if (!lock.IsOk()) {
+		return wxMSGQUEUE_MISC_ERROR;
+	}
+
+	entry.postedTime = (readTime > 0) ? readTime : TwoCanUtils::GetMonotonicMicros();
+
+	if ((policy == QUEUE_POLICY_COALESCE) && (entry.pgnClass == PGN_CLASS_NAVIGATION) && (entry.key != 0)) {
+		entry.frame = frame;
+		if (Coalesce(entry)) {
+			return wxMSGQUEUE_NO_ERROR;
+		}
+	}
+
+	if (count >= capacity) {
+		bool accepted;
+		if (policy == QUEUE_POLICY_DROP_CLASS) {
+			accepted = DropClass(entry.pgnClass);
+		}
+		else {
+			accepted = DropOldest();
+		}
+		// If only raw frames could be discarded, a raw frame is queued beyond the capacity rather than 
+		// corrupting its message's reassembly, up to twice the capacity so that memory remains bounded
+		if ((!accepted) && (entry.isRaw) && (count < (2 * capacity))) {
+			accepted = true;
+		}
+		if (!accepted) {
+			droppedFrames++;
+			droppedClassFrames[entry.pgnClass]++;
+			return wxMSGQUEUE_NO_ERROR;
+		}
+	}
+
+	if (entry.frame.empty()) {
+		entry.frame = frame;
+	}
+	int lane = GetLane(entry.pgnClass);
+	entry.sequence = 0;
+	if (lane == QUEUE_LANE_NORMAL) {
+		entry.sequence = tailSequence++;
+		if ((policy == QUEUE_POLICY_COALESCE) && (entry.pgnClass == PGN_CLASS_NAVIGATION) && (entry.key != 0)) {
+			pendingFrames[entry.key] = entry.sequence;
+		}
+	}
+	lanes[lane].push_back(std::move(entry));
+	count++;
+
+	if (count > highWaterMark) {
+		highWaterMark = count;
+	}
+
+	queueCondition.Signal();
+	return wxMSGQUEUE_NO_ERROR;
+}
+
+// Wait for a frame
+wxMessageQueueError ActisenseQueue::ReceiveTimeout(long timeout, std::vector<byte>& frame) {
+	return ReceiveTimeout(timeout, frame, NULL, NULL);
+}
+
+// Wait for a frame, taking it from the highest priority lane that is not empty
+wxMessageQueueError ActisenseQueue::ReceiveTimeout(long timeout, std::vector<byte>& frame, int *lane, unsigned long long *postedTime) {
+	wxMutexLocker lock(queueMutex);
+
+	if (!lock.IsOk()) {
+		return wxMSGQUEUE_MISC_ERROR;
+	}
+
+	if (count == 0) {
+		// wxCondition may wake spuriously, or another frame may have been taken in the meantime
+		// The deadline is monotonic so that a clock change neither stretches nor cuts the wait
+		unsigned long long waitUntil = TwoCanUtils::GetMonotonicMillis() + timeout;
+		while (count == 0) {
+			long long remaining = (long long)waitUntil - (long long)TwoCanUtils::GetMonotonicMillis();
+			if ((remaining <= 0) || (queueCondition.WaitTimeout((unsigned long)remaining) == wxCOND_TIMEOUT)) {
+				if (count == 0) {
+					return wxMSGQUEUE_TIMEOUT;
+				}
+			}
+		}
+	}
+
+	int i = 0;
+	while (lanes[i].empty()) {
+		i++;
+	}
+
+	QueueEntry& entry = lanes[i].front();
+	unsigned long long latency = TwoCanUtils::GetMonotonicMicros() - entry.postedTime;
+	laneStatistics[i].frames++;
+	laneStatistics[i].totalLatency += latency;
+	if (latency > laneStatistics[i].maximumLatency) {
+		laneStatistics[i].maximumLatency = latency;
+	}
+	if (lane != NULL) {
+		*lane = i;
+	}
+	if (postedTime != NULL) {
+		*postedTime = entry.postedTime;
+	}
+	frame = std::move(entry.frame);
+	PopFront(i);
+
+	return wxMSGQUEUE_NO_ERROR;
+}
+
+// Discard everything, eg. when the device is stopping
+void ActisenseQueue::Clear(void) {
+	wxMutexLocker lock(queueMutex);
+	headSequence += lanes[QUEUE_LANE_NORMAL].size();
+	for (int i = 0; i < QUEUE_LANES; i++) {
+		lanes[i].clear();
+	}
+	count = 0;
+	pendingFrames.clear();
+}
+
+// Remove the frame at the front of a lane, keeping the coalescing sequence numbers in step
+void ActisenseQueue::PopFront(const int lane) {
+	if (lane == QUEUE_LANE_NORMAL) {
+		QueueEntry& entry = lanes[lane].front();
+		if (policy == QUEUE_POLICY_COALESCE) {
+			std::unordered_map<unsigned int, unsigned long long>::iterator it = pendingFrames.find(entry.key);
+			if ((it != pendingFrames.end()) && (it->second == entry.sequence)) {
+				pendingFrames.erase(it);
+			}
+		}
+		headSequence++;
+	}
+	lanes[lane].pop_front();
+	count--;
+}
+
+// Make room by discarding the oldest frame of the lowest priority lane that is not empty.
+// A safety frame is only discarded when the queue holds nothing but safety frames.
+// Only the front of a lane is discarded so that the coalescing sequence numbers remain valid,
+// if that is a raw frame the lane is skipped
+bool ActisenseQueue::DropOldest(void) {
+	for (int i = QUEUE_LANES - 1; i >= 0; i--) {
+		if ((!lanes[i].empty()) && (!lanes[i].front().isRaw)) {
+			droppedFrames++;
+			droppedClassFrames[lanes[i].front().pgnClass]++;
+			PopFront(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+// Make room by discarding the oldest frame of the least important class that is queued.
+// If the incoming frame is no more important than anything queued, it is the one discarded (returns false)
+bool ActisenseQueue::DropClass(const int pgnClass) {
+	int leastImportant = PGN_CLASSES;
+	for (int i = QUEUE_LANES - 1; (i >= 0) && (leastImportant != PGN_CLASS_BULK); i--) {
+		for (std::deque<QueueEntry>::iterator it = lanes[i].begin(); it != lanes[i].end(); ++it) {
+			if ((!it->isRaw) && (it->pgnClass < leastImportant)) {
+				leastImportant = it->pgnClass;
+				if (leastImportant == PGN_CLASS_BULK) {
+					break;
+				}
+			}
+		}
+	}
+
+	if (pgnClass <= leastImportant) {
+		return false;
+	}
+
+	std::deque<QueueEntry>& lane = lanes[GetLane(leastImportant)];
+	for (std::deque<QueueEntry>::iterator it = lane.begin(); it != lane.end(); ++it) {
+		if ((!it->isRaw) && (it->pgnClass == leastImportant)) {
+			droppedFrames++;
+			droppedClassFrames[leastImportant]++;
+			lane.erase(it);
+			count--;
+			// Sequence numbers are only used for coalescing, so no need to renumber
+			return true;
+		}
+	}
+	return false;
+}
+
+// Replace a queued frame from the same PGN & source with the latest frame, preserving its place in the queue.
+// The latency is that of the latest frame, so it takes the latest frame's posted time
+bool ActisenseQueue::Coalesce(const QueueEntry& entry) {
+	std::unordered_map<unsigned int, unsigned long long>::iterator it = pendingFrames.find(entry.key);
+	if (it != pendingFrames.end()) {
+		size_t position = it->second - headSequence;
+		if (position < lanes[QUEUE_LANE_NORMAL].size()) {
+			lanes[QUEUE_LANE_NORMAL][position].frame = entry.frame;
+			lanes[QUEUE_LANE_NORMAL][position].postedTime = entry.postedTime;
+			coalescedFrames++;
+			return true;
+		}
+		// Stale entry
+		pendingFrames.erase(it);
+	}
+	return false;
+}
+
+size_t ActisenseQueue::GetCount(void) {
+	wxMutexLocker lock(queueMutex);
+	return count;
+}
+
+size_t ActisenseQueue::GetCount(const int lane) {
+	wxMutexLocker lock(queueMutex);
+	return ((lane >= 0) && (lane < QUEUE_LANES)) ? lanes[lane].size() : 0;
+}
+
+LaneStatistics ActisenseQueue::GetLaneStatistics(const int lane) {
+	LaneStatistics statistics = { 0, 0, 0 };
+	wxMutexLocker lock(queueMutex);
+	if ((lane >= 0) && (lane < QUEUE_LANES)) {
+		statistics = laneStatistics[lane];
+	}
+	return statistics;
+}
+
+size_t ActisenseQueue::GetHighWaterMark(void) {
+	wxMutexLocker lock(queueMutex);
+	return highWaterMark;
+}
+
+unsigned long long ActisenseQueue::GetDroppedFrames(void) {
+	wxMutexLocker lock(queueMutex);
+	return droppedFrames;
+}
+
+unsigned long long ActisenseQueue::GetCoalescedFrames(void) {
+	wxMutexLocker lock(queueMutex);
+	return coalescedFrames;
+}
+
+unsigned long long ActisenseQueue::GetDroppedFrames(const int pgnClass) {
+	wxMutexLocker lock(queueMutex);
+	return ((pgnClass >= 0) && (pgnClass < PGN_CLASSES)) ? droppedClassFrames[pgnClass] : 0;
+}
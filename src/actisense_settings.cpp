@@ -119,6 +119,12 @@ void ActisenseSettings::OnInit(wxInitDialogEvent& event) {
 	// BUG BUG Localization
 	btnPause->SetLabel((debugWindowActive) ? _("Stop") : _("Start"));
 
+	// Bus Load Tab
+	DisplayBusLoad();
+
+	// Statistics Tab
+	DisplayStatistics();
+
 	// Network Tab - Currently hidden
 	wxSize gridSize;
 	gridSize = this->GetClientSize();
@@ -127,27 +133,30 @@ void ActisenseSettings::OnInit(wxInitDialogEvent& event) {
 	dataGridNetwork->SetMinSize(gridSize);
 	dataGridNetwork->SetMaxSize(gridSize);
 
+	NetworkInformation networkEntry;
+	unsigned long long now = TwoCanUtils::GetMonotonicMillis();
 	for (int i = 0; i < CONST_MAX_DEVICES; i++) {
 		// Renumber row labels to match network address 0 - 253
 		dataGridNetwork->SetRowLabelValue(i, std::to_string(i));
+		// A consistent copy, the device thread may be updating the entry
 		// No need to iterate over non-existent entries
-		if ((networkMap[i].uniqueId > 0) || (strlen(networkMap[i].productInformation.modelId) > 0) ) {
-			dataGridNetwork->SetCellValue(i, 0, wxString::Format("%lu", networkMap[i].uniqueId));
+		if ((networkMap.Read(i, &networkEntry)) && ((networkEntry.uniqueId > 0) || (strlen(networkEntry.productInformation.modelId) > 0))) {
+			dataGridNetwork->SetCellValue(i, 0, wxString::Format("%lu", networkEntry.uniqueId));
 			// Look up the manufacturer name
-			std::unordered_map<int, std::string>::iterator it = deviceManufacturers.find(networkMap[i].manufacturerId);
+			std::unordered_map<int, std::string>::iterator it = deviceManufacturers.find(networkEntry.manufacturerId);
 			if (it != deviceManufacturers.end()) {
 				dataGridNetwork->SetCellValue(i, 1, it->second);
 			}
 			else {
-				dataGridNetwork->SetCellValue(i, 1, wxString::Format("%d", networkMap[i].manufacturerId));
+				dataGridNetwork->SetCellValue(i, 1, wxString::Format("%d", networkEntry.manufacturerId));
 			}
-			dataGridNetwork->SetCellValue(i, 2, wxString::Format("%s", networkMap[i].productInformation.modelId));
+			dataGridNetwork->SetCellValue(i, 2, wxString::Format("%s", networkEntry.productInformation.modelId));
 			// We don't receive our own heartbeats so ignore our time stamp value
-			if (networkMap[i].uniqueId != uniqueId) {
+			if (networkEntry.uniqueId != uniqueId) {
 				wxGridCellAttr *attr;
 				attr = new wxGridCellAttr;
 				// Differentiate dead/alive devices 
-				attr->SetTextColour((wxDateTime::Now() > (networkMap[i].timestamp + wxTimeSpan::Seconds(60))) ? *wxRED : *wxGREEN);
+				attr->SetTextColour(((networkEntry.heartbeatExpired) || (now > (networkEntry.timestamp + CONST_ONE_MINUTE))) ? *wxRED : *wxGREEN);
 				dataGridNetwork->SetAttr(i, 0, attr);
 			}
 		}
@@ -234,6 +243,71 @@ void ActisenseSettings::OnCopy(wxCommandEvent &event) {
 	}
 }
 
+// Take another snapshot of the bus load
+void ActisenseSettings::OnRefresh(wxCommandEvent &event) {
+	DisplayBusLoad();
+}
+
+// The estimated bus load, and the sources and PGN's using most of it. 
+// The busiest PGN's are candidates for removal from the NGT-1's receive PGN list
+void ActisenseSettings::DisplayBusLoad(void) {
+	BusLoadSnapshot snapshot;
+	busLoad.GetSnapshot(&snapshot);
+
+	labelBusLoad->SetLabel(wxString::Format(_("Bus Load: %.1f%% (Peak %.1f%%), %.0f frames/s"), 
+		snapshot.utilisation, snapshot.peakUtilisation, snapshot.framesPerSecond));
+
+	dataGridSources->ClearGrid();
+	for (size_t i = 0; (i < snapshot.sources.size()) && (i < (size_t)dataGridSources->GetNumberRows()); i++) {
+		dataGridSources->SetCellValue(i, 0, wxString::Format("%u", snapshot.sources[i].id));
+		dataGridSources->SetCellValue(i, 1, wxString::Format("%.1f", snapshot.sources[i].framesPerSecond));
+		dataGridSources->SetCellValue(i, 2, wxString::Format("%.1f", snapshot.sources[i].share));
+	}
+
+	dataGridPGN->ClearGrid();
+	for (size_t i = 0; (i < snapshot.pgns.size()) && (i < (size_t)dataGridPGN->GetNumberRows()); i++) {
+		dataGridPGN->SetCellValue(i, 0, wxString::Format("%u", snapshot.pgns[i].id));
+		dataGridPGN->SetCellValue(i, 1, wxString::Format("%.1f", snapshot.pgns[i].framesPerSecond));
+		dataGridPGN->SetCellValue(i, 2, wxString::Format("%.1f", snapshot.pgns[i].share));
+	}
+}
+
+// Take another look at the statistics
+void ActisenseSettings::OnRefreshStatistics(wxCommandEvent &event) {
+	DisplayStatistics();
+}
+
+// Only reads the statistics' atomic counters, so never blocks the device thread
+void ActisenseSettings::DisplayStatistics(void) {
+	labelStatistics->SetLabel(wxString::Format(_("Received: %llu, Transmitted: %llu, Fast Packet: %llu, Errors: %llu, Dropped: %llu"),
+		deviceStatistics.GetReceivedFrames(), deviceStatistics.GetTransmittedFrames(), deviceStatistics.GetFastFrames(),
+		deviceStatistics.GetErrorFrames(), deviceStatistics.GetDroppedFrames()));
+
+	// Distribution of the decode and queue wait times, over all PGN's
+	const ActisenseHistogram& decodeTime = deviceStatistics.GetDecodeTime();
+	const ActisenseHistogram& queueTime = deviceStatistics.GetQueueTime();
+	dataGridHistogram->ClearGrid();
+	for (int i = 0; (i < CONST_HISTOGRAM_BUCKETS) && (i < dataGridHistogram->GetNumberRows()); i++) {
+		dataGridHistogram->SetCellValue(i, 0, (i < CONST_HISTOGRAM_BUCKETS - 1) ? wxString::Format("%llu", ActisenseHistogram::GetBucketLimit(i)) : _("More"));
+		dataGridHistogram->SetCellValue(i, 1, wxString::Format("%llu", decodeTime.GetBucket(i)));
+		dataGridHistogram->SetCellValue(i, 2, wxString::Format("%llu", queueTime.GetBucket(i)));
+	}
+
+	// Average & 99th percentile decode & queue wait times (usec) of the most frequent PGN's
+	std::vector<PgnTimes> times;
+	deviceStatistics.GetPgnTimes(times);
+	dataGridTimes->ClearGrid();
+	for (size_t i = 0; (i < times.size()) && (i < (size_t)dataGridTimes->GetNumberRows()); i++) {
+		dataGridTimes->SetCellValue(i, 0, (times[i].pgn == CONST_OTHER_PGNS) ? _("Other") : wxString::Format("%u", times[i].pgn));
+		dataGridTimes->SetCellValue(i, 1, wxString::Format("%llu", times[i].messages));
+		dataGridTimes->SetCellValue(i, 2, wxString::Format("%llu", times[i].decodeMean));
+		dataGridTimes->SetCellValue(i, 3, wxString::Format("%llu", times[i].decodePercentile));
+		dataGridTimes->SetCellValue(i, 4, wxString::Format("%llu", times[i].queueMean));
+		dataGridTimes->SetCellValue(i, 5, wxString::Format("%llu", times[i].queuePercentile));
+		dataGridTimes->SetCellValue(i, 6, wxString::Format("%llu", times[i].queueMaximum));
+	}
+}
+
 // Set whether the device is an actve or passive node on the NMEA 2000 network
 void ActisenseSettings::OnCheckMode(wxCommandEvent &event) {
 	chkEnableHeartbeat->Enable(chkDeviceMode->IsChecked());
@@ -383,6 +457,8 @@ bool ActisenseSettings::EnumerateDrivers(void) {
 	adapters[CONST_LOG_READER] = CONST_LOG_READER;
 	// BUG BUG Should really check if the Actisense NGT-1 device is present
 	adapters[CONST_NGT_READER] = CONST_NGT_READER;
+	// Raw CAN frames, eg. captured using SocketCAN
+	adapters[CONST_CANDUMP_READER] = CONST_CANDUMP_READER;
 	
 	return TRUE;
 }
@@ -239,6 +239,204 @@ ActisenseSettingsBase::ActisenseSettingsBase( wxWindow* parent, wxWindowID id, c
 	panelDebug->Layout();
 	sizerPanelDebug->Fit( panelDebug );
 	notebookTabs->AddPage( panelDebug, wxT("Debug"), false );
+	panelBusLoad = new wxPanel( notebookTabs, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxTAB_TRAVERSAL );
+	wxBoxSizer* sizerPanelBusLoad;
+	sizerPanelBusLoad = new wxBoxSizer( wxVERTICAL );
+
+	wxBoxSizer* sizerLabelBusLoad;
+	sizerLabelBusLoad = new wxBoxSizer( wxHORIZONTAL );
+
+	labelBusLoad = new wxStaticText( panelBusLoad, wxID_ANY, wxT("Bus Load"), wxDefaultPosition, wxDefaultSize, 0 );
+	labelBusLoad->Wrap( -1 );
+	sizerLabelBusLoad->Add( labelBusLoad, 0, wxALL, 5 );
+
+
+	sizerLabelBusLoad->Add( 0, 0, 1, wxEXPAND, 5 );
+
+	btnRefresh = new wxButton( panelBusLoad, wxID_ANY, wxT("Refresh"), wxDefaultPosition, wxDefaultSize, 0 );
+	sizerLabelBusLoad->Add( btnRefresh, 0, wxALL, 5 );
+
+
+	sizerPanelBusLoad->Add( sizerLabelBusLoad, 0, wxEXPAND, 5 );
+
+	wxBoxSizer* sizerGridBusLoad;
+	sizerGridBusLoad = new wxBoxSizer( wxHORIZONTAL );
+
+	dataGridSources = new wxGrid( panelBusLoad, wxID_ANY, wxDefaultPosition, wxDefaultSize, 0 );
+
+	// Grid
+	dataGridSources->CreateGrid( 20, 3 );
+	dataGridSources->EnableEditing( false );
+	dataGridSources->EnableGridLines( true );
+	dataGridSources->EnableDragGridSize( false );
+	dataGridSources->SetMargins( 0, 0 );
+
+	// Columns
+	dataGridSources->SetColSize( 0, 70 );
+	dataGridSources->SetColSize( 1, 70 );
+	dataGridSources->SetColSize( 2, 60 );
+	dataGridSources->EnableDragColMove( false );
+	dataGridSources->EnableDragColSize( true );
+	dataGridSources->SetColLabelSize( 30 );
+	dataGridSources->SetColLabelValue( 0, wxT("Source") );
+	dataGridSources->SetColLabelValue( 1, wxT("Frames/s") );
+	dataGridSources->SetColLabelValue( 2, wxT("Load %") );
+	dataGridSources->SetColLabelAlignment( wxALIGN_LEFT, wxALIGN_CENTER );
+
+	// Rows
+	dataGridSources->EnableDragRowSize( false );
+	dataGridSources->SetRowLabelSize( 30 );
+	dataGridSources->SetRowLabelAlignment( wxALIGN_LEFT, wxALIGN_CENTER );
+
+	// Label Appearance
+
+	// Cell Defaults
+	dataGridSources->SetDefaultCellAlignment( wxALIGN_LEFT, wxALIGN_TOP );
+	sizerGridBusLoad->Add( dataGridSources, 0, wxALL, 5 );
+
+	dataGridPGN = new wxGrid( panelBusLoad, wxID_ANY, wxDefaultPosition, wxDefaultSize, 0 );
+
+	// Grid
+	dataGridPGN->CreateGrid( 20, 3 );
+	dataGridPGN->EnableEditing( false );
+	dataGridPGN->EnableGridLines( true );
+	dataGridPGN->EnableDragGridSize( false );
+	dataGridPGN->SetMargins( 0, 0 );
+
+	// Columns
+	dataGridPGN->SetColSize( 0, 70 );
+	dataGridPGN->SetColSize( 1, 70 );
+	dataGridPGN->SetColSize( 2, 60 );
+	dataGridPGN->EnableDragColMove( false );
+	dataGridPGN->EnableDragColSize( true );
+	dataGridPGN->SetColLabelSize( 30 );
+	dataGridPGN->SetColLabelValue( 0, wxT("PGN") );
+	dataGridPGN->SetColLabelValue( 1, wxT("Frames/s") );
+	dataGridPGN->SetColLabelValue( 2, wxT("Load %") );
+	dataGridPGN->SetColLabelAlignment( wxALIGN_LEFT, wxALIGN_CENTER );
+
+	// Rows
+	dataGridPGN->EnableDragRowSize( false );
+	dataGridPGN->SetRowLabelSize( 30 );
+	dataGridPGN->SetRowLabelAlignment( wxALIGN_LEFT, wxALIGN_CENTER );
+
+	// Label Appearance
+
+	// Cell Defaults
+	dataGridPGN->SetDefaultCellAlignment( wxALIGN_LEFT, wxALIGN_TOP );
+	sizerGridBusLoad->Add( dataGridPGN, 0, wxALL, 5 );
+
+
+	sizerPanelBusLoad->Add( sizerGridBusLoad, 1, wxEXPAND, 5 );
+
+
+	panelBusLoad->SetSizer( sizerPanelBusLoad );
+	panelBusLoad->Layout();
+	sizerPanelBusLoad->Fit( panelBusLoad );
+	notebookTabs->AddPage( panelBusLoad, wxT("Bus Load"), false );
+	panelStatistics = new wxPanel( notebookTabs, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxTAB_TRAVERSAL );
+	wxBoxSizer* sizerPanelStatistics;
+	sizerPanelStatistics = new wxBoxSizer( wxVERTICAL );
+
+	wxBoxSizer* sizerLabelStatistics;
+	sizerLabelStatistics = new wxBoxSizer( wxHORIZONTAL );
+
+	labelStatistics = new wxStaticText( panelStatistics, wxID_ANY, wxT("Statistics"), wxDefaultPosition, wxDefaultSize, 0 );
+	labelStatistics->Wrap( -1 );
+	sizerLabelStatistics->Add( labelStatistics, 0, wxALL, 5 );
+
+
+	sizerLabelStatistics->Add( 0, 0, 1, wxEXPAND, 5 );
+
+	btnRefreshStatistics = new wxButton( panelStatistics, wxID_ANY, wxT("Refresh"), wxDefaultPosition, wxDefaultSize, 0 );
+	sizerLabelStatistics->Add( btnRefreshStatistics, 0, wxALL, 5 );
+
+
+	sizerPanelStatistics->Add( sizerLabelStatistics, 0, wxEXPAND, 5 );
+
+	wxBoxSizer* sizerGridStatistics;
+	sizerGridStatistics = new wxBoxSizer( wxHORIZONTAL );
+
+	dataGridHistogram = new wxGrid( panelStatistics, wxID_ANY, wxDefaultPosition, wxDefaultSize, 0 );
+
+	// Grid
+	dataGridHistogram->CreateGrid( 24, 3 );
+	dataGridHistogram->EnableEditing( false );
+	dataGridHistogram->EnableGridLines( true );
+	dataGridHistogram->EnableDragGridSize( false );
+	dataGridHistogram->SetMargins( 0, 0 );
+
+	// Columns
+	dataGridHistogram->SetColSize( 0, 70 );
+	dataGridHistogram->SetColSize( 1, 70 );
+	dataGridHistogram->SetColSize( 2, 70 );
+	dataGridHistogram->EnableDragColMove( false );
+	dataGridHistogram->EnableDragColSize( true );
+	dataGridHistogram->SetColLabelSize( 30 );
+	dataGridHistogram->SetColLabelValue( 0, wxT("usec <=") );
+	dataGridHistogram->SetColLabelValue( 1, wxT("Decode") );
+	dataGridHistogram->SetColLabelValue( 2, wxT("Queued") );
+	dataGridHistogram->SetColLabelAlignment( wxALIGN_LEFT, wxALIGN_CENTER );
+
+	// Rows
+	dataGridHistogram->EnableDragRowSize( false );
+	dataGridHistogram->SetRowLabelSize( 30 );
+	dataGridHistogram->SetRowLabelAlignment( wxALIGN_LEFT, wxALIGN_CENTER );
+
+	// Label Appearance
+
+	// Cell Defaults
+	dataGridHistogram->SetDefaultCellAlignment( wxALIGN_LEFT, wxALIGN_TOP );
+	sizerGridStatistics->Add( dataGridHistogram, 0, wxALL, 5 );
+
+	dataGridTimes = new wxGrid( panelStatistics, wxID_ANY, wxDefaultPosition, wxDefaultSize, 0 );
+
+	// Grid
+	dataGridTimes->CreateGrid( 20, 7 );
+	dataGridTimes->EnableEditing( false );
+	dataGridTimes->EnableGridLines( true );
+	dataGridTimes->EnableDragGridSize( false );
+	dataGridTimes->SetMargins( 0, 0 );
+
+	// Columns
+	dataGridTimes->SetColSize( 0, 60 );
+	dataGridTimes->SetColSize( 1, 70 );
+	dataGridTimes->SetColSize( 2, 60 );
+	dataGridTimes->SetColSize( 3, 60 );
+	dataGridTimes->SetColSize( 4, 60 );
+	dataGridTimes->SetColSize( 5, 60 );
+	dataGridTimes->SetColSize( 6, 70 );
+	dataGridTimes->EnableDragColMove( false );
+	dataGridTimes->EnableDragColSize( true );
+	dataGridTimes->SetColLabelSize( 30 );
+	dataGridTimes->SetColLabelValue( 0, wxT("PGN") );
+	dataGridTimes->SetColLabelValue( 1, wxT("Messages") );
+	dataGridTimes->SetColLabelValue( 2, wxT("Decode") );
+	dataGridTimes->SetColLabelValue( 3, wxT("99%") );
+	dataGridTimes->SetColLabelValue( 4, wxT("Queued") );
+	dataGridTimes->SetColLabelValue( 5, wxT("99%") );
+	dataGridTimes->SetColLabelValue( 6, wxT("Maximum") );
+	dataGridTimes->SetColLabelAlignment( wxALIGN_LEFT, wxALIGN_CENTER );
+
+	// Rows
+	dataGridTimes->EnableDragRowSize( false );
+	dataGridTimes->SetRowLabelSize( 30 );
+	dataGridTimes->SetRowLabelAlignment( wxALIGN_LEFT, wxALIGN_CENTER );
+
+	// Label Appearance
+
+	// Cell Defaults
+	dataGridTimes->SetDefaultCellAlignment( wxALIGN_LEFT, wxALIGN_TOP );
+	sizerGridStatistics->Add( dataGridTimes, 0, wxALL, 5 );
+
+
+	sizerPanelStatistics->Add( sizerGridStatistics, 1, wxEXPAND, 5 );
+
+
+	panelStatistics->SetSizer( sizerPanelStatistics );
+	panelStatistics->Layout();
+	sizerPanelStatistics->Fit( panelStatistics );
+	notebookTabs->AddPage( panelStatistics, wxT("Statistics"), false );
 	panelAbout = new wxPanel( notebookTabs, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxTAB_TRAVERSAL );
 	wxBoxSizer* sizerPanelAbout;
 	sizerPanelAbout = new wxBoxSizer( wxVERTICAL );
@@ -311,6 +509,8 @@ ActisenseSettingsBase::ActisenseSettingsBase( wxWindow* parent, wxWindowID id, c
 	chkInfluxDB->Connect( wxEVT_COMMAND_CHECKBOX_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnCheckInfluxDb ), NULL, this );
 	btnPause->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnPause ), NULL, this );
 	btnCopy->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnCopy ), NULL, this );
+	btnRefresh->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnRefresh ), NULL, this );
+	btnRefreshStatistics->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnRefreshStatistics ), NULL, this );
 	btnOK->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnOK ), NULL, this );
 	btnApply->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnApply ), NULL, this );
 	btnCancel->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnCancel ), NULL, this );
@@ -332,6 +532,8 @@ ActisenseSettingsBase::~ActisenseSettingsBase()
 	chkInfluxDB->Disconnect( wxEVT_COMMAND_CHECKBOX_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnCheckInfluxDb ), NULL, this );
 	btnPause->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnPause ), NULL, this );
 	btnCopy->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnCopy ), NULL, this );
+	btnRefresh->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnRefresh ), NULL, this );
+	btnRefreshStatistics->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnRefreshStatistics ), NULL, this );
 	btnOK->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnOK ), NULL, this );
 	btnApply->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnApply ), NULL, this );
 	btnCancel->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( ActisenseSettingsBase::OnCancel ), NULL, this );
@@ -0,0 +1,241 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseStatistics - Frame counters and processing time histograms
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+// Version History: 
+// 1.0 Initial Release
+//
+
+#include "actisense_statistics.h"
+
+// SerialStatistics
+#include "actisense_interface.h"
+
+ActisenseHistogram::ActisenseHistogram(void) {
+	Reset();
+}
+
+void ActisenseHistogram::Reset(void) {
+	for (int i = 0; i < CONST_HISTOGRAM_BUCKETS; i++) {
+		buckets[i].store(0, std::memory_order_relaxed);
+	}
+	count.store(0, std::memory_order_relaxed);
+	total.store(0, std::memory_order_relaxed);
+	minimum.store(ULLONG_MAX, std::memory_order_relaxed);
+	maximum.store(0, std::memory_order_relaxed);
+}
+
+int ActisenseHistogram::GetBucketIndex(const unsigned long long micros) {
+	int bucket = 0;
+	unsigned long long value = micros;
+	while ((value > 0) && (bucket < CONST_HISTOGRAM_BUCKETS - 1)) {
+		value >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+unsigned long long ActisenseHistogram::GetBucketLimit(const int bucket) {
+	return (bucket == 0) ? 0 : (1ULL << bucket) - 1;
+}
+
+// Only the device thread records, so the minimum and maximum need not be compare and swapped
+void ActisenseHistogram::Record(const unsigned long long micros) {
+	buckets[GetBucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+	count.fetch_add(1, std::memory_order_relaxed);
+	total.fetch_add(micros, std::memory_order_relaxed);
+	if (micros < minimum.load(std::memory_order_relaxed)) {
+		minimum.store(micros, std::memory_order_relaxed);
+	}
+	if (micros > maximum.load(std::memory_order_relaxed)) {
+		maximum.store(micros, std::memory_order_relaxed);
+	}
+}
+
+unsigned long long ActisenseHistogram::GetMean(void) const {
+	unsigned long long samples = count.load(std::memory_order_relaxed);
+	return (samples > 0) ? total.load(std::memory_order_relaxed) / samples : 0;
+}
+
+unsigned long long ActisenseHistogram::GetMinimum(void) const {
+	return (count.load(std::memory_order_relaxed) > 0) ? minimum.load(std::memory_order_relaxed) : 0;
+}
+
+unsigned long long ActisenseHistogram::GetPercentile(const double percentile) const {
+	unsigned long long samples[CONST_HISTOGRAM_BUCKETS];
+	unsigned long long sampleCount = 0;
+	// Sum the buckets rather than use count, which may be a little ahead or behind
+	for (int i = 0; i < CONST_HISTOGRAM_BUCKETS; i++) {
+		samples[i] = buckets[i].load(std::memory_order_relaxed);
+		sampleCount += samples[i];
+	}
+	if (sampleCount == 0) {
+		return 0;
+	}
+	unsigned long long target = static_cast<unsigned long long>((percentile * sampleCount) / 100.0);
+	unsigned long long cumulative = 0;
+	for (int i = 0; i < CONST_HISTOGRAM_BUCKETS; i++) {
+		cumulative += samples[i];
+		if (cumulative > target) {
+			return GetBucketLimit(i);
+		}
+	}
+	return GetBucketLimit(CONST_HISTOGRAM_BUCKETS - 1);
+}
+
+ActisenseStatistics::ActisenseStatistics(void) {
+	Reset();
+}
+
+ActisenseStatistics::~ActisenseStatistics(void) {
+}
+
+// Only called when the device is not running
+void ActisenseStatistics::Reset(void) {
+	receivedFrames.store(0, std::memory_order_relaxed);
+	transmittedFrames.store(0, std::memory_order_relaxed);
+	standardFrames.store(0, std::memory_order_relaxed);
+	fastFrames.store(0, std::memory_order_relaxed);
+	errorFrames.store(0, std::memory_order_relaxed);
+	droppedFrames.store(0, std::memory_order_relaxed);
+	coalescedFrames.store(0, std::memory_order_relaxed);
+	adapterDropped.store(0, std::memory_order_relaxed);
+	queueDepth.store(0, std::memory_order_relaxed);
+	queueHighWaterMark.store(0, std::memory_order_relaxed);
+	queueCapacity.store(0, std::memory_order_relaxed);
+	serialAvailable.store(FALSE, std::memory_order_relaxed);
+	serialBytes.store(0, std::memory_order_relaxed);
+	serialBytesPerSecond.store(0, std::memory_order_relaxed);
+	serialUtilisation.store(0, std::memory_order_relaxed);
+	serialOverruns.store(0, std::memory_order_relaxed);
+	serialBufferOverruns.store(0, std::memory_order_relaxed);
+	serialFramingErrors.store(0, std::memory_order_relaxed);
+	serialParityErrors.store(0, std::memory_order_relaxed);
+	serialResyncs.store(0, std::memory_order_relaxed);
+	serialEscapeErrors.store(0, std::memory_order_relaxed);
+	serialDiscardedBytes.store(0, std::memory_order_relaxed);
+	decodeTime.Reset();
+	queueTime.Reset();
+	for (int i = 0; i <= CONST_STATISTICS_PGNS; i++) {
+		pgnEntries[i].key.store(0, std::memory_order_relaxed);
+		pgnEntries[i].decodeTime.Reset();
+		pgnEntries[i].queueTime.Reset();
+	}
+	pgnCount = 0;
+}
+
+void ActisenseStatistics::SetQueue(const size_t depth, const size_t highWaterMark, const size_t capacity, const unsigned long long coalesced) {
+	queueDepth.store(depth, std::memory_order_relaxed);
+	queueHighWaterMark.store(highWaterMark, std::memory_order_relaxed);
+	queueCapacity.store(capacity, std::memory_order_relaxed);
+	coalescedFrames.store(coalesced, std::memory_order_relaxed);
+}
+
+void ActisenseStatistics::SetSerial(const SerialStatistics& serial) {
+	serialBytes.store(serial.rxBytes, std::memory_order_relaxed);
+	serialBytesPerSecond.store(serial.bytesPerSecond, std::memory_order_relaxed);
+	serialUtilisation.store(serial.utilisation, std::memory_order_relaxed);
+	serialOverruns.store(serial.overruns, std::memory_order_relaxed);
+	serialBufferOverruns.store(serial.bufferOverruns, std::memory_order_relaxed);
+	serialFramingErrors.store(serial.framingErrors, std::memory_order_relaxed);
+	serialParityErrors.store(serial.parityErrors, std::memory_order_relaxed);
+	serialResyncs.store(serial.resyncs, std::memory_order_relaxed);
+	serialEscapeErrors.store(serial.escapeErrors, std::memory_order_relaxed);
+	serialDiscardedBytes.store(serial.discardedBytes, std::memory_order_relaxed);
+	serialAvailable.store(TRUE, std::memory_order_relaxed);
+}
+
+// The peak rates are not copied, they are logged by the device when it exits
+bool ActisenseStatistics::GetSerial(SerialStatistics *serial) const {
+	if (!serialAvailable.load(std::memory_order_relaxed)) {
+		return FALSE;
+	}
+	*serial = {};
+	serial->rxBytes = serialBytes.load(std::memory_order_relaxed);
+	serial->bytesPerSecond = serialBytesPerSecond.load(std::memory_order_relaxed);
+	serial->utilisation = serialUtilisation.load(std::memory_order_relaxed);
+	serial->overruns = serialOverruns.load(std::memory_order_relaxed);
+	serial->bufferOverruns = serialBufferOverruns.load(std::memory_order_relaxed);
+	serial->framingErrors = serialFramingErrors.load(std::memory_order_relaxed);
+	serial->parityErrors = serialParityErrors.load(std::memory_order_relaxed);
+	serial->resyncs = serialResyncs.load(std::memory_order_relaxed);
+	serial->escapeErrors = serialEscapeErrors.load(std::memory_order_relaxed);
+	serial->discardedBytes = serialDiscardedBytes.load(std::memory_order_relaxed);
+	return TRUE;
+}
+
+// Linear probing, entries are never removed. The key is published last so that readers only see complete entries
+ActisenseStatistics::PgnEntry *ActisenseStatistics::FindPgn(const unsigned int pgn) {
+	unsigned int key = pgn + 1;
+	int position = ((key * 2654435769U) >> 16) & (CONST_STATISTICS_PGNS - 1);
+	for (int i = 0; i < CONST_STATISTICS_PGNS; i++) {
+		unsigned int entryKey = pgnEntries[position].key.load(std::memory_order_relaxed);
+		if (entryKey == key) {
+			return &pgnEntries[position];
+		}
+		if (entryKey == 0) {
+			// Keep one entry free to terminate the search
+			if (pgnCount >= CONST_STATISTICS_PGNS - 1) {
+				break;
+			}
+			pgnCount++;
+			pgnEntries[position].key.store(key, std::memory_order_release);
+			return &pgnEntries[position];
+		}
+		position = (position + 1) & (CONST_STATISTICS_PGNS - 1);
+	}
+	return &pgnEntries[CONST_STATISTICS_PGNS];
+}
+
+void ActisenseStatistics::RecordFrame(const unsigned int pgn, const unsigned long long decodeMicros, const unsigned long long queueMicros) {
+	decodeTime.Record(decodeMicros);
+	queueTime.Record(queueMicros);
+	PgnEntry *entry = FindPgn(pgn);
+	entry->decodeTime.Record(decodeMicros);
+	entry->queueTime.Record(queueMicros);
+}
+
+void ActisenseStatistics::GetPgnTimes(std::vector<PgnTimes>& times) const {
+	times.clear();
+	for (int i = 0; i <= CONST_STATISTICS_PGNS; i++) {
+		unsigned int key = pgnEntries[i].key.load(std::memory_order_acquire);
+		const PgnEntry *entry = &pgnEntries[i];
+		if (((key > 0) || (i == CONST_STATISTICS_PGNS)) && (entry->decodeTime.GetCount() > 0)) {
+			PgnTimes pgnTimes;
+			pgnTimes.pgn = (i == CONST_STATISTICS_PGNS) ? CONST_OTHER_PGNS : key - 1;
+			pgnTimes.messages = entry->decodeTime.GetCount();
+			pgnTimes.decodeMean = entry->decodeTime.GetMean();
+			pgnTimes.decodePercentile = entry->decodeTime.GetPercentile(99);
+			pgnTimes.decodeMaximum = entry->decodeTime.GetMaximum();
+			pgnTimes.queueMean = entry->queueTime.GetMean();
+			pgnTimes.queuePercentile = entry->queueTime.GetPercentile(99);
+			pgnTimes.queueMaximum = entry->queueTime.GetMaximum();
+			times.push_back(pgnTimes);
+		}
+	}
+	std::sort(times.begin(), times.end(), 
+		[](const PgnTimes& a, const PgnTimes& b) { return a.messages > b.messages; });
+}
@@ -0,0 +1,545 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseTest - Behaviour checks of the framing, queue, reassembly and timestamp mapping
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+// Version History: 
+// 1.0 Initial Release
+//
+
+#include "actisense_test.h"
+
+// wxWidgets
+// Console application initialization and output
+#include <wx/init.h>
+#include <wx/crt.h>
+
+// STL
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+ActisenseTest::ActisenseTest(void) {
+	device = NULL;
+	subscription = NULL;
+	checks = 0;
+	failures = 0;
+}
+
+ActisenseTest::~ActisenseTest(void) {
+	if (subscription != NULL) {
+		messageBus.Unsubscribe(subscription);
+		delete subscription;
+	}
+	if (device != NULL) {
+		// The device thread was never run, so its OnExit has not deleted the interface
+		delete device->GetInterface();
+		delete device;
+	}
+}
+
+int ActisenseTest::Init(void) {
+	supportedPGN = (FLAGS_NAV << 1) - 1;
+	debugWindowActive = FALSE;
+	logLevel = FLAGS_LOG_NONE;
+
+	device = new ActisenseDevice(NULL);
+	int returnCode = device->Init(CONST_MEMORY_READER);
+	if (returnCode != TWOCAN_RESULT_SUCCESS) {
+		return returnCode;
+	}
+
+	// Raw messages of the test PGN's, whether or not they produce a sentence
+	BusFilter busFilter = {};
+	busFilter.pgns.push_back(CONST_TEST_FAST_PGN);
+	busFilter.pgns.push_back(CONST_TEST_SINGLE_PGN);
+	subscription = new ActisenseSubscription(_T("Test"), busFilter, CONST_SUBSCRIPTION_SIZE, NULL, wxEVT_NULL, 0);
+	messageBus.Subscribe(subscription);
+
+	pgnFilter.EnableAll();
+	return TWOCAN_RESULT_SUCCESS;
+}
+
+int ActisenseTest::Run(const wxString& filter) {
+	typedef void (ActisenseTest::*TestFunction)(void);
+	const struct {
+		const char *name;
+		TestFunction function;
+	} tests[] = {
+		{ "framing", &ActisenseTest::TestFraming },
+		{ "queue", &ActisenseTest::TestQueue },
+		{ "fastpacket", &ActisenseTest::TestFastPacket },
+		{ "transport", &ActisenseTest::TestTransport },
+		{ "timestamp", &ActisenseTest::TestAdapterTimestamp },
+		{ "writecommand", &ActisenseTest::TestWriteCommand }
+	};
+
+	for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+		testName = tests[i].name;
+		if ((!filter.IsEmpty()) && (!testName.Contains(filter))) {
+			continue;
+		}
+		int previousFailures = failures;
+		(this->*tests[i].function)();
+		wxPrintf(_T("%-16s %s\n"), testName, (failures == previousFailures) ? _T("passed") : _T("FAILED"));
+	}
+
+	wxPrintf(_T("\n%d checks, %d failed\n"), checks, failures);
+	return failures;
+}
+
+void ActisenseTest::Expect(const bool condition, const char *description) {
+	checks++;
+	if (!condition) {
+		failures++;
+		wxPrintf(_T("%s: %s\n"), testName, description);
+	}
+}
+
+// As transmitted by an NGT-1, with the overall length and checksum
+std::vector<byte> ActisenseTest::BuildFrame(const unsigned int pgn, const byte source, const std::vector<byte>& payload) {
+	std::vector<byte> frame;
+	frame.push_back(N2K_RX_CMD);
+	frame.push_back(static_cast<byte>(payload.size() + 11));
+	frame.push_back(CONST_PRIORITY_MEDIUM);
+	frame.push_back(pgn & 0xFF);
+	frame.push_back((pgn >> 8) & 0xFF);
+	frame.push_back((pgn >> 16) & 0xFF);
+	frame.push_back(CONST_GLOBAL_ADDRESS);
+	frame.push_back(source);
+	// Timestamp
+	frame.push_back(0xE8);
+	frame.push_back(0x03);
+	frame.push_back(0x00);
+	frame.push_back(0x00);
+	frame.push_back(static_cast<byte>(payload.size()));
+	frame.insert(frame.end(), payload.begin(), payload.end());
+	frame.push_back(static_cast<byte>(0x100 - TwoCanUtils::ActisenseChecksum(frame.data(), frame.size())));
+	return frame;
+}
+
+// DLE STX, the frame with any DLE escaped, DLE ETX
+void ActisenseTest::AppendEscaped(std::vector<byte>& stream, const std::vector<byte>& frame) {
+	stream.push_back(DLE);
+	stream.push_back(STX);
+	for (std::vector<byte>::const_iterator it = frame.begin(); it != frame.end(); ++it) {
+		if (*it == DLE) {
+			stream.push_back(DLE);
+		}
+		stream.push_back(*it);
+	}
+	stream.push_back(DLE);
+	stream.push_back(ETX);
+}
+
+// CAN Id (little endian), no timestamp, data length and data
+std::vector<byte> ActisenseTest::BuildRawFrame(const CanHeader& header, const std::vector<byte>& data) {
+	std::vector<byte> frame;
+	unsigned int id;
+	TwoCanUtils::EncodeCanHeader(&id, &header);
+	frame.push_back(CAN_RX_CMD);
+	frame.push_back(id & 0xFF);
+	frame.push_back((id >> 8) & 0xFF);
+	frame.push_back((id >> 16) & 0xFF);
+	frame.push_back((id >> 24) & 0xFF);
+	frame.insert(frame.end(), 4, 0);
+	frame.push_back(static_cast<byte>(data.size()));
+	frame.insert(frame.end(), data.begin(), data.end());
+	return frame;
+}
+
+size_t ActisenseTest::TakePublished(void) {
+	batch.clear();
+	subscription->Acknowledge();
+	return subscription->Receive(batch, CONST_SUBSCRIPTION_SIZE);
+}
+
+// BST framing, escaped DLE's, frames split across reads, and resynchronising after a corrupt escape sequence
+void ActisenseTest::TestFraming(void) {
+	ActisenseQueue queue(CONST_MIN_QUEUE_SIZE, QUEUE_POLICY_DROP_OLDEST);
+	ActisenseFramer framer(&queue);
+	std::vector<byte> stream;
+	std::vector<byte> received;
+
+	// A payload containing DLE, which is escaped on the wire
+	std::vector<byte> frame = BuildFrame(130306, 0x23, { 0x01, DLE, 0x02, DLE, DLE, 0x03, 0xFA, 0xFF });
+	AppendEscaped(stream, frame);
+	framer.Process(stream.data(), stream.size(), 0);
+	Expect(framer.GetPostedMessages() == 1, "a complete frame is posted");
+	Expect(queue.ReceiveTimeout(0, received) == wxMSGQUEUE_NO_ERROR, "the frame is queued");
+	Expect(received == frame, "escaped DLE's are removed");
+
+	// Split across reads, one byte at a time, preceded by noise
+	stream.assign({ 0x55, 0xAA, ETX });
+	AppendEscaped(stream, frame);
+	for (size_t i = 0; i < stream.size(); i++) {
+		framer.Process(&stream[i], 1, 0);
+	}
+	Expect(framer.GetPostedMessages() == 2, "a frame split across reads is posted");
+	Expect(framer.GetDiscardedBytes() == 3, "bytes outside of a frame are discarded");
+	received.clear();
+	queue.ReceiveTimeout(0, received);
+	Expect(received == frame, "a frame split across reads is reassembled");
+
+	// DLE followed by anything other than STX, ETX or DLE abandons the frame, the next frame is received intact
+	stream.clear();
+	AppendEscaped(stream, frame);
+	stream.insert(stream.begin() + 8, { DLE, 0x41 });
+	AppendEscaped(stream, frame);
+	framer.Process(stream.data(), stream.size(), 0);
+	Expect(framer.GetEscapeErrors() > 0, "an invalid escape sequence is counted");
+	Expect(framer.GetResyncs() == 1, "the partial frame is discarded");
+	Expect(framer.GetPostedMessages() == 3, "the framer resynchronises on the next frame");
+	Expect(queue.GetCount() == 1, "only the intact frame is queued");
+	received.clear();
+	queue.ReceiveTimeout(0, received);
+	Expect(received == frame, "the frame after the resynchronisation is intact");
+
+	// Frames of unwanted PGN's are dropped once their PGN is known
+	unsigned long long filtered = pgnFilter.GetFilteredFrames();
+	pgnFilter.DisableAll();
+	pgnFilter.Enable(129025);
+	stream.clear();
+	AppendEscaped(stream, frame);
+	AppendEscaped(stream, BuildFrame(129025, 0x23, { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 }));
+	framer.Process(stream.data(), stream.size(), 0);
+	pgnFilter.EnableAll();
+	Expect(pgnFilter.GetFilteredFrames() == filtered + 1, "a frame of an unwanted PGN is filtered");
+	Expect((queue.GetCount() == 1) && (framer.GetPostedMessages() == 4), "a frame of a wanted PGN is posted");
+	queue.Clear();
+}
+
+// Each overload policy, the priority lanes, and raw frames being kept in preference to discarding a fragment
+void ActisenseTest::TestQueue(void) {
+	std::vector<byte> payload = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07 };
+	std::vector<byte> received;
+	int lane;
+	unsigned long long postedTime;
+
+	// Drop oldest, the first frame makes way for the last
+	{
+		ActisenseQueue queue(CONST_MIN_QUEUE_SIZE, QUEUE_POLICY_DROP_OLDEST);
+		for (int i = 0; i <= CONST_MIN_QUEUE_SIZE; i++) {
+			queue.Post(BuildFrame(127489, static_cast<byte>(i), payload));
+		}
+		Expect(queue.GetCount() == CONST_MIN_QUEUE_SIZE, "drop oldest, the queue remains at capacity");
+		Expect(queue.GetDroppedFrames() == 1, "drop oldest, one frame is dropped");
+		queue.ReceiveTimeout(0, received);
+		Expect(received == BuildFrame(127489, 1, payload), "drop oldest, the first frame is dropped");
+	}
+
+	// Drop class, the least important class queued is discarded, or the incoming frame if it is no more important
+	{
+		ActisenseQueue queue(CONST_MIN_QUEUE_SIZE, QUEUE_POLICY_DROP_CLASS);
+		for (int i = 0; i < CONST_MIN_QUEUE_SIZE / 2; i++) {
+			queue.Post(BuildFrame(129038, static_cast<byte>(i), payload));
+			queue.Post(BuildFrame(127489, static_cast<byte>(i), payload));
+		}
+		queue.Post(BuildFrame(129025, 0x23, payload));
+		Expect(queue.GetDroppedFrames(PGN_CLASS_BULK) == 1, "drop class, a bulk frame makes way for a navigation frame");
+		queue.Post(BuildFrame(127489, 0x23, payload));
+		Expect(queue.GetDroppedFrames(PGN_CLASS_BULK) == 2, "drop class, an incoming bulk frame is itself dropped");
+		Expect(queue.GetDroppedFrames(PGN_CLASS_AIS) == 0, "drop class, the more important frames are kept");
+		Expect(queue.GetCount() == CONST_MIN_QUEUE_SIZE, "drop class, the queue remains at capacity");
+	}
+
+	// Coalesce, a queued navigation frame is replaced by the latest from the same PGN & source
+	{
+		ActisenseQueue queue(CONST_MIN_QUEUE_SIZE, QUEUE_POLICY_COALESCE);
+		queue.Post(BuildFrame(129025, 0x23, payload));
+		queue.Post(BuildFrame(127489, 0x23, payload));
+		for (byte i = 1; i <= 3; i++) {
+			payload[0] = i;
+			queue.Post(BuildFrame(129025, 0x23, payload), TwoCanUtils::GetMonotonicMicros() + i);
+		}
+		queue.Post(BuildFrame(129025, 0x24, payload));
+		Expect(queue.GetCount() == 3, "coalesce, the same PGN & source is queued once");
+		Expect(queue.GetCoalescedFrames() == 3, "coalesce, replaced frames are counted");
+		received.clear();
+		queue.ReceiveTimeout(0, received);
+		Expect(received == BuildFrame(129025, 0x23, payload), "coalesce, the latest frame keeps the first frame's place");
+		payload[0] = 0x00;
+	}
+
+	// Safety frames overtake everything queued
+	{
+		ActisenseQueue queue(CONST_MIN_QUEUE_SIZE, QUEUE_POLICY_DROP_OLDEST);
+		queue.Post(BuildFrame(127489, 0x23, payload));
+		queue.Post(BuildFrame(60928, 0x23, payload));
+		queue.Post(BuildFrame(129802, 0x23, payload));
+		queue.ReceiveTimeout(0, received, &lane, &postedTime);
+		Expect(lane == QUEUE_LANE_SAFETY, "the safety lane is dequeued first");
+		queue.ReceiveTimeout(0, received, &lane, &postedTime);
+		Expect(lane == QUEUE_LANE_NETWORK, "then the network lane");
+		queue.ReceiveTimeout(0, received, &lane, &postedTime);
+		Expect(lane == QUEUE_LANE_NORMAL, "then the normal lane");
+	}
+
+	// Raw frames are queued beyond the capacity rather than losing a fragment
+	{
+		ActisenseQueue queue(CONST_MIN_QUEUE_SIZE, QUEUE_POLICY_DROP_OLDEST);
+		CanHeader header = { 2, 0x23, CONST_GLOBAL_ADDRESS, CONST_TEST_FAST_PGN, 0 };
+		for (int i = 0; i <= CONST_MIN_QUEUE_SIZE; i++) {
+			queue.Post(BuildRawFrame(header, payload));
+		}
+		Expect(queue.GetCount() == CONST_MIN_QUEUE_SIZE + 1, "raw frames are not dropped");
+		Expect(queue.GetDroppedFrames() == 0, "raw frames are not counted as dropped");
+	}
+}
+
+// Fast Packet reassembly, in order, interleaved, out of order, missing the first frame, and abandoned messages
+void ActisenseTest::TestFastPacket(void) {
+	CanHeader header = { 2, 0x23, CONST_GLOBAL_ADDRESS, CONST_TEST_FAST_PGN, 0 };
+	std::vector<byte> payload;
+	for (byte i = 0; i < 18; i++) {
+		payload.push_back(i + 0x40);
+	}
+
+	// Sequence identifier sid, frames of an 18 byte message
+	byte frames[2][3][CONST_PAYLOAD_LENGTH];
+	for (int sid = 0; sid < 2; sid++) {
+		memset(frames[sid], 0xFF, sizeof(frames[sid]));
+		frames[sid][0][0] = sid << 5;
+		frames[sid][0][1] = static_cast<byte>(payload.size());
+		memcpy(&frames[sid][0][2], &payload[0], 6);
+		frames[sid][1][0] = (sid << 5) | 1;
+		memcpy(&frames[sid][1][1], &payload[6], 7);
+		frames[sid][2][0] = (sid << 5) | 2;
+		memcpy(&frames[sid][2][1], &payload[13], 5);
+	}
+
+	TakePublished();
+
+	device->AssembleFastMessage(header, frames[0][0]);
+	device->AssembleFastMessage(header, frames[0][1]);
+	Expect(TakePublished() == 0, "an incomplete message is not published");
+	device->AssembleFastMessage(header, frames[0][2]);
+	Expect((TakePublished() == 1) && (batch[0]->header.pgn == CONST_TEST_FAST_PGN), "a complete message is published");
+	Expect((batch.size() == 1) && (batch[0]->payload == payload), "the payload is reassembled");
+	Expect(device->fastMessageCount == 0, "a completed message is removed");
+
+	// Two messages from the same source, distinguished by their sequence identifiers
+	device->AssembleFastMessage(header, frames[0][0]);
+	device->AssembleFastMessage(header, frames[1][0]);
+	device->AssembleFastMessage(header, frames[1][1]);
+	device->AssembleFastMessage(header, frames[0][1]);
+	device->AssembleFastMessage(header, frames[1][2]);
+	device->AssembleFastMessage(header, frames[0][2]);
+	Expect(TakePublished() == 2, "interleaved messages are both published");
+	Expect((batch.size() == 2) && (batch[0]->payload == payload) && (batch[1]->payload == payload), "interleaved messages are reassembled");
+
+	// Out of order, the message is abandoned
+	device->AssembleFastMessage(header, frames[0][0]);
+	device->AssembleFastMessage(header, frames[0][2]);
+	device->AssembleFastMessage(header, frames[0][1]);
+	Expect(TakePublished() == 0, "an out of order message is not published");
+	Expect(device->fastMessageCount == 0, "an out of order message is removed");
+
+	// Missing the first frame, nothing is buffered
+	device->AssembleFastMessage(header, frames[0][1]);
+	device->AssembleFastMessage(header, frames[0][2]);
+	Expect(TakePublished() == 0, "a message missing its first frame is not published");
+	Expect(device->fastMessageCount == 0, "a message missing its first frame is not buffered");
+
+	// A first frame restarts a message with the same sequence identifier
+	device->AssembleFastMessage(header, frames[0][0]);
+	device->AssembleFastMessage(header, frames[0][0]);
+	device->AssembleFastMessage(header, frames[0][1]);
+	device->AssembleFastMessage(header, frames[0][2]);
+	Expect(TakePublished() == 1, "a repeated first frame restarts the message");
+
+	// The garbage collector removes messages whose next frame is overdue, and only those
+	device->AssembleFastMessage(header, frames[0][0]);
+	device->AssembleFastMessage(header, frames[1][0]);
+	for (int i = 0; i < CONST_MAX_MESSAGES; i++) {
+		if ((!device->fastMessages[i].IsFree) && (device->fastMessages[i].sid == 0)) {
+			device->fastMessages[i].timeArrived -= CONST_TIME_EXCEEDED + 1;
+		}
+	}
+	Expect(device->MapGarbageCollector() == 1, "an overdue message is collected");
+	Expect(device->fastMessageCount == 1, "a current message is not collected");
+	device->AssembleFastMessage(header, frames[1][1]);
+	device->AssembleFastMessage(header, frames[1][2]);
+	Expect((TakePublished() == 1) && (batch[0]->payload == payload), "the remaining message completes");
+	Expect(device->fastMessageCount == 0, "nothing remains buffered");
+}
+
+// ISO Transport Protocol, BAM through the in memory interface and device, RTS/CTS, aborts and timeouts directly
+void ActisenseTest::TestTransport(void) {
+	std::vector<byte> payload;
+	for (byte i = 0; i < 20; i++) {
+		payload.push_back(i + 0x60);
+	}
+	// Transport Protocol Data Transfer packets, each seven bytes of the message, the last padded
+	std::vector<std::vector<byte>> packets;
+	for (int i = 0; i < 3; i++) {
+		std::vector<byte> packet(CONST_PAYLOAD_LENGTH, 0xFF);
+		packet[0] = static_cast<byte>(i + 1);
+		for (int j = 0; (j < 7) && ((i * 7) + j < static_cast<int>(payload.size())); j++) {
+			packet[j + 1] = payload[(i * 7) + j];
+		}
+		packets.push_back(packet);
+	}
+
+	// Broadcast Announce Message, fed to the device as raw CAN frames
+	CanHeader connection = { 7, 0x23, CONST_GLOBAL_ADDRESS, CONST_TP_CM_PGN, 0 };
+	CanHeader transfer = { 7, 0x23, CONST_GLOBAL_ADDRESS, CONST_TP_DT_PGN, 0 };
+	std::vector<byte> announce = { TP_CM_BAM, 20, 0, 3, 0xFF, CONST_TEST_SINGLE_PGN & 0xFF, (CONST_TEST_SINGLE_PGN >> 8) & 0xFF, CONST_TEST_SINGLE_PGN >> 16 };
+	std::vector<byte> stream;
+	AppendEscaped(stream, BuildRawFrame(connection, announce));
+	for (size_t i = 0; i < packets.size(); i++) {
+		AppendEscaped(stream, BuildRawFrame(transfer, packets[i]));
+	}
+	TakePublished();
+	ActisenseMemory *memory = static_cast<ActisenseMemory *>(device->GetInterface());
+	memory->Feed(stream);
+	Expect(device->ProcessPendingMessages() == 4, "the BAM frames are framed and queued");
+	Expect(TakePublished() == 1, "a BAM transfer is published");
+	Expect((batch.size() == 1) && (batch[0]->header.pgn == CONST_TEST_SINGLE_PGN) && (batch[0]->header.source == 0x23), "the BAM header is that of the message");
+	Expect((batch.size() == 1) && (batch[0]->payload == payload), "the BAM payload is reassembled");
+
+	ActisenseTimerWheel timerWheel(CONST_TP_SESSIONS, TwoCanUtils::GetMonotonicMillis());
+	ActisenseTransport transport(&timerWheel, 0);
+
+	// A BAM packet out of sequence abandons the transfer, as nothing can be resent
+	transport.ProcessFrame(connection, announce.data(), CONST_PAYLOAD_LENGTH);
+	transport.ProcessFrame(transfer, packets[0].data(), CONST_PAYLOAD_LENGTH);
+	Expect(!transport.ProcessFrame(transfer, packets[2].data(), CONST_PAYLOAD_LENGTH), "a BAM packet out of sequence is discarded");
+	Expect(!transport.ProcessFrame(transfer, packets[1].data(), CONST_PAYLOAD_LENGTH), "the abandoned BAM transfer is not resumed");
+	Expect(transport.GetStatistics().discarded == 2, "the discarded BAM packets are counted");
+
+	// Request To Send from 0x23 to 0x40, the receiver clears two packets, then the third
+	CanHeader request = { 7, 0x23, 0x40, CONST_TP_CM_PGN, 0 };
+	CanHeader response = { 7, 0x40, 0x23, CONST_TP_CM_PGN, 0 };
+	CanHeader data = { 7, 0x23, 0x40, CONST_TP_DT_PGN, 0 };
+	std::vector<byte> requestToSend = { TP_CM_RTS, 20, 0, 3, 3, CONST_TEST_SINGLE_PGN & 0xFF, (CONST_TEST_SINGLE_PGN >> 8) & 0xFF, CONST_TEST_SINGLE_PGN >> 16 };
+	std::vector<byte> clearFirst = { TP_CM_CTS, 2, 1, 0xFF, 0xFF, CONST_TEST_SINGLE_PGN & 0xFF, (CONST_TEST_SINGLE_PGN >> 8) & 0xFF, CONST_TEST_SINGLE_PGN >> 16 };
+	std::vector<byte> clearLast = { TP_CM_CTS, 1, 3, 0xFF, 0xFF, CONST_TEST_SINGLE_PGN & 0xFF, (CONST_TEST_SINGLE_PGN >> 8) & 0xFF, CONST_TEST_SINGLE_PGN >> 16 };
+	transport.ProcessFrame(request, requestToSend.data(), CONST_PAYLOAD_LENGTH);
+	Expect(!transport.ProcessFrame(data, packets[0].data(), CONST_PAYLOAD_LENGTH), "RTS/CTS, a packet before the CTS is discarded");
+	transport.ProcessFrame(response, clearFirst.data(), CONST_PAYLOAD_LENGTH);
+	transport.ProcessFrame(data, packets[0].data(), CONST_PAYLOAD_LENGTH);
+	transport.ProcessFrame(data, packets[1].data(), CONST_PAYLOAD_LENGTH);
+	Expect(!transport.ProcessFrame(data, packets[2].data(), CONST_PAYLOAD_LENGTH), "RTS/CTS, a packet beyond those cleared is discarded");
+	transport.ProcessFrame(response, clearLast.data(), CONST_PAYLOAD_LENGTH);
+	Expect(transport.ProcessFrame(data, packets[2].data(), CONST_PAYLOAD_LENGTH), "RTS/CTS, the transfer completes");
+	Expect(transport.GetPayload() == payload, "RTS/CTS, the payload is reassembled");
+	Expect((transport.GetHeader().pgn == CONST_TEST_SINGLE_PGN) && (transport.GetHeader().source == 0x23) && (transport.GetHeader().destination == 0x40), 
+		"RTS/CTS, the header is that of the message");
+	Expect(transport.GetStatistics().completed == 1, "RTS/CTS, the transfer is counted");
+
+	// Either party may abort
+	std::vector<byte> abort = { TP_CM_ABORT, 0xFF, 0xFF, 0xFF, 0xFF, CONST_TEST_SINGLE_PGN & 0xFF, (CONST_TEST_SINGLE_PGN >> 8) & 0xFF, CONST_TEST_SINGLE_PGN >> 16 };
+	transport.ProcessFrame(request, requestToSend.data(), CONST_PAYLOAD_LENGTH);
+	transport.ProcessFrame(response, abort.data(), CONST_PAYLOAD_LENGTH);
+	Expect(transport.GetStatistics().aborted == 1, "an aborted transfer is counted");
+	transport.ProcessFrame(response, clearFirst.data(), CONST_PAYLOAD_LENGTH);
+	Expect(!transport.ProcessFrame(data, packets[0].data(), CONST_PAYLOAD_LENGTH), "an aborted transfer is closed");
+
+	// A stalled transfer times out
+	std::vector<int> expired;
+	transport.ProcessFrame(connection, announce.data(), CONST_PAYLOAD_LENGTH);
+	timerWheel.Advance(TwoCanUtils::GetMonotonicMillis() + CONST_TP_T1 + CONST_TP_T3, expired);
+	Expect((expired.size() == 1) && (transport.IsTransportTimer(expired[0])), "a stalled transfer's timer expires");
+	for (size_t i = 0; i < expired.size(); i++) {
+		transport.Expire(expired[i]);
+	}
+	Expect(transport.GetStatistics().timedOut == 1, "a stalled transfer is counted");
+	Expect(!transport.ProcessFrame(transfer, packets[0].data(), CONST_PAYLOAD_LENGTH), "a stalled transfer is closed");
+}
+
+// Mapping the adapter's 32 bit millisecond clock onto ours, across a wrap, a restart and out of order frames
+void ActisenseTest::TestAdapterTimestamp(void) {
+	const unsigned long long hostTime = 100000;
+
+	device->adapterTimeValid = FALSE;
+	Expect(device->ConvertAdapterTimestamp(1000, hostTime) == hostTime, "the first frame sets the offset");
+	Expect(device->ConvertAdapterTimestamp(1100, hostTime + 105) == hostTime + 100, "a delayed frame keeps the least delayed offset");
+	Expect(device->ConvertAdapterTimestamp(1050, hostTime + 110) == hostTime + 50, "a slightly out of order frame is not a restart");
+	Expect(device->ConvertAdapterTimestamp(1200, hostTime + 195) == hostTime + 195, "a less delayed frame lowers the offset");
+
+	// Across the wrap of the adapter's clock
+	device->adapterTimeValid = FALSE;
+	Expect(device->ConvertAdapterTimestamp(0xFFFFFF00, hostTime) == hostTime, "the offset is set before the wrap");
+	Expect(device->ConvertAdapterTimestamp(0x00000010, hostTime + 0x110) == hostTime + 0x110, "the clock is extended across the wrap");
+	Expect(device->adapterEpoch == CONST_ADAPTER_TIME_WRAP, "the wrap advances the epoch");
+	Expect(device->ConvertAdapterTimestamp(0xFFFFFF80, hostTime + 0x120) == hostTime + 0x80, "a late frame from before the wrap belongs to the previous epoch");
+	Expect(device->ConvertAdapterTimestamp(0x00000020, hostTime + 0x120) == hostTime + 0x120, "frames after the wrap continue");
+
+	// The adapter restarting, or an EBL log file rewinding, resets the mapping
+	Expect(device->ConvertAdapterTimestamp(0x00100000, hostTime + 0x100100) == hostTime + 0x100100, "the extended clock advances");
+	Expect(device->ConvertAdapterTimestamp(5, hostTime + 0x200000) == hostTime + 0x200000, "a restart resets the mapping");
+	Expect(device->adapterEpoch == 0, "a restart resets the epoch");
+}
+
+// The NGT-1 commands, framed as the adapter expects
+void ActisenseTest::TestWriteCommand(void) {
+	std::vector<byte> writeBuffer;
+
+	// The Reset Sequence sent by ConfigureAdapter, refer to Canboat
+	ActisenseNGT1::EncodeCommand({ NGT_CMD_OPERATING_MODE, NGT_MODE_RX_ALL & 0xFF, (NGT_MODE_RX_ALL >> 8) & 0xFF }, writeBuffer);
+	Expect(writeBuffer == std::vector<byte>({ DLE, STX, NGT_TX_CMD, 0x03, 0x11, 0x02, 0x00, 0x49, DLE, ETX }), "the reset sequence");
+
+	// Every DLE is escaped, so the framer recovers the command and its checksum
+	std::vector<byte> command = { NGT_CMD_RX_PGN_ENABLE, DLE, 0x00, 0x00, 0x00, 0x01, 0xFF, 0xFF, 0xFF, 0xFF };
+	ActisenseNGT1::EncodeCommand(command, writeBuffer);
+	ActisenseQueue queue(CONST_MIN_QUEUE_SIZE, QUEUE_POLICY_DROP_OLDEST);
+	ActisenseFramer framer(&queue);
+	framer.Process(writeBuffer.data(), writeBuffer.size(), 0);
+	std::vector<byte> received;
+	Expect(queue.ReceiveTimeout(0, received) == wxMSGQUEUE_NO_ERROR, "an encoded command is framed");
+	Expect((received.size() == command.size() + 3) && (std::equal(command.begin(), command.end(), received.begin() + 2)), "an encoded command is escaped");
+	Expect(TwoCanUtils::ActisenseChecksum(received.data(), received.size()) == 0, "an encoded command's checksum");
+}
+
+int main(int argc, char **argv) {
+	wxInitializer initializer;
+	if (!initializer.IsOk()) {
+		fprintf(stderr, "Failed to initialize wxWidgets\n");
+		return EXIT_FAILURE;
+	}
+
+	wxString filter;
+	for (int i = 1; i < argc; i++) {
+		wxString argument(argv[i]);
+		if ((argument == _T("--filter")) && (i + 1 < argc)) {
+			filter = argv[++i];
+		}
+		else {
+			fprintf(stderr, "Usage: %s [--filter name]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	ActisenseTest test;
+	int returnCode = test.Init();
+	if (returnCode != TWOCAN_RESULT_SUCCESS) {
+		fprintf(stderr, "Failed to initialize the device (%d)\n", returnCode);
+		return EXIT_FAILURE;
+	}
+
+	return (test.Run(filter) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,122 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseTimerWheel - Heartbeat and data staleness deadlines
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+// Version History: 
+// 1.0 Initial Release
+//
+
+#include "actisense_timerwheel.h"
+
+ActisenseTimerWheel::ActisenseTimerWheel(const int timers, const unsigned long long now) {
+	WheelTimer timer = { NOT_FOUND, NOT_FOUND, NOT_FOUND, 0 };
+	this->timers.assign(timers, timer);
+	for (int i = 0; i < CONST_WHEEL_SLOTS; i++) {
+		buckets[i] = NOT_FOUND;
+	}
+	currentTick = now / CONST_WHEEL_TICK;
+}
+
+ActisenseTimerWheel::~ActisenseTimerWheel(void) {
+}
+
+// Timers are kept in doubly linked lists threaded through the timers vector, so no allocation is required
+void ActisenseTimerWheel::Link(const int timer, const int bucket) {
+	timers[timer].bucket = bucket;
+	timers[timer].previous = NOT_FOUND;
+	timers[timer].next = buckets[bucket];
+	if (buckets[bucket] != NOT_FOUND) {
+		timers[buckets[bucket]].previous = timer;
+	}
+	buckets[bucket] = timer;
+}
+
+void ActisenseTimerWheel::Unlink(const int timer) {
+	if (timers[timer].previous != NOT_FOUND) {
+		timers[timers[timer].previous].next = timers[timer].next;
+	}
+	else {
+		buckets[timers[timer].bucket] = timers[timer].next;
+	}
+	if (timers[timer].next != NOT_FOUND) {
+		timers[timers[timer].next].previous = timers[timer].previous;
+	}
+	timers[timer].bucket = NOT_FOUND;
+}
+
+void ActisenseTimerWheel::Arm(const int timer, const unsigned long long deadline) {
+	if ((timer < 0) || (timer >= (int)timers.size())) {
+		return;
+	}
+	if (timers[timer].bucket != NOT_FOUND) {
+		Unlink(timer);
+	}
+	timers[timer].deadline = deadline;
+	// Rounded up, so that the deadline has passed by the time its bucket is visited
+	unsigned long long tick = (deadline + CONST_WHEEL_TICK - 1) / CONST_WHEEL_TICK;
+	// A deadline that has already passed expires on the next advance
+	if (tick <= currentTick) {
+		tick = currentTick + 1;
+	}
+	Link(timer, tick & (CONST_WHEEL_SLOTS - 1));
+}
+
+void ActisenseTimerWheel::Cancel(const int timer) {
+	if ((timer >= 0) && (timer < (int)timers.size()) && (timers[timer].bucket != NOT_FOUND)) {
+		Unlink(timer);
+	}
+}
+
+bool ActisenseTimerWheel::IsArmed(const int timer) {
+	return ((timer >= 0) && (timer < (int)timers.size()) && (timers[timer].bucket != NOT_FOUND));
+}
+
+// Visit each bucket passed since the last advance. Timers whose deadline lies in a later revolution remain in place.
+// If more than a revolution has passed (eg. the thread was suspended), every bucket is visited once
+size_t ActisenseTimerWheel::Advance(const unsigned long long now, std::vector<int>& expired) {
+	unsigned long long nowTick = now / CONST_WHEEL_TICK;
+	expired.clear();
+	if (nowTick <= currentTick) {
+		return 0;
+	}
+	unsigned long long ticks = nowTick - currentTick;
+	if (ticks > CONST_WHEEL_SLOTS) {
+		ticks = CONST_WHEEL_SLOTS;
+	}
+	for (unsigned long long i = 1; i <= ticks; i++) {
+		int bucket = (currentTick + i) & (CONST_WHEEL_SLOTS - 1);
+		int timer = buckets[bucket];
+		while (timer != NOT_FOUND) {
+			int next = timers[timer].next;
+			if (timers[timer].deadline <= now) {
+				Unlink(timer);
+				expired.push_back(timer);
+			}
+			timer = next;
+		}
+	}
+	currentTick = nowTick;
+	return expired.size();
+}
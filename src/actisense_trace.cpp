@@ -0,0 +1,204 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseTracer - Sampled per frame latency tracing
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+
+#include "actisense_trace.h"
+
+ActisenseTracer::ActisenseTracer(void) {
+	Reset(0);
+}
+
+ActisenseTracer::~ActisenseTracer(void) {
+}
+
+void ActisenseTracer::Reset(const int interval) {
+	for (int i = 0; i < CONST_TRACE_RECORDS; i++) {
+		records[i].id.store(0, std::memory_order_relaxed);
+		records[i].pgn = 0;
+		for (int j = 0; j < TRACE_STAGES; j++) {
+			records[i].stamps[j].store(0, std::memory_order_relaxed);
+		}
+	}
+	for (int i = 0; i < TRACE_INTERVALS; i++) {
+		intervals[i].Reset();
+	}
+	samplingInterval = (interval > 0) ? interval : 0;
+	sampleCount = 0;
+	lastId = 0;
+}
+
+const char *ActisenseTracer::GetIntervalName(const int interval) {
+	const char *intervalNames[TRACE_INTERVALS] = { "queue", "decode", "publish", "deliver", "total" };
+	return ((interval >= 0) && (interval < TRACE_INTERVALS)) ? intervalNames[interval] : "";
+}
+
+ActisenseTracer::TraceRecord *ActisenseTracer::FindRecord(const unsigned int traceId) {
+	if (traceId == 0) {
+		return NULL;
+	}
+	TraceRecord *record = &records[traceId & (CONST_TRACE_RECORDS - 1)];
+	return (record->id.load(std::memory_order_acquire) == traceId) ? record : NULL;
+}
+
+// Sampling on a count, rather than at random, so that a given interval traces a predictable proportion of the frames
+unsigned int ActisenseTracer::Begin(const unsigned long long readTime, const unsigned long long dequeueTime) {
+	if (samplingInterval == 0) {
+		return 0;
+	}
+	if (++sampleCount < samplingInterval) {
+		return 0;
+	}
+	sampleCount = 0;
+
+	if (++lastId == 0) {
+		lastId = 1;
+	}
+	TraceRecord *record = &records[lastId & (CONST_TRACE_RECORDS - 1)];
+	record->id.store(0, std::memory_order_relaxed);
+	record->pgn = CONST_OTHER_PGNS;
+	for (int i = 0; i < TRACE_STAGES; i++) {
+		record->stamps[i].store(0, std::memory_order_relaxed);
+	}
+	record->stamps[TRACE_STAGE_READ].store((readTime > 0) ? readTime : dequeueTime, std::memory_order_relaxed);
+	record->stamps[TRACE_STAGE_DEQUEUED].store(dequeueTime, std::memory_order_relaxed);
+	record->id.store(lastId, std::memory_order_release);
+	return lastId;
+}
+
+void ActisenseTracer::Stamp(const unsigned int traceId, const int stage) {
+	TraceRecord *record = FindRecord(traceId);
+	if (record != NULL) {
+		record->stamps[stage].store(TwoCanUtils::GetMonotonicMicros(), std::memory_order_relaxed);
+	}
+}
+
+// Frames that do not complete a message (eg. the first frames of a fast packet) are only timed in the queue
+void ActisenseTracer::End(const unsigned int traceId, const unsigned int pgn) {
+	TraceRecord *record = FindRecord(traceId);
+	if (record != NULL) {
+		record->pgn = pgn;
+		unsigned long long read = record->stamps[TRACE_STAGE_READ].load(std::memory_order_relaxed);
+		unsigned long long dequeued = record->stamps[TRACE_STAGE_DEQUEUED].load(std::memory_order_relaxed);
+		unsigned long long decoded = record->stamps[TRACE_STAGE_DECODED].load(std::memory_order_relaxed);
+		unsigned long long published = record->stamps[TRACE_STAGE_PUBLISHED].load(std::memory_order_relaxed);
+		intervals[TRACE_INTERVAL_QUEUE].Record((dequeued > read) ? dequeued - read : 0);
+		if (decoded > 0) {
+			intervals[TRACE_INTERVAL_DECODE].Record((decoded > dequeued) ? decoded - dequeued : 0);
+			if (published > 0) {
+				intervals[TRACE_INTERVAL_PUBLISH].Record((published > decoded) ? published - decoded : 0);
+			}
+		}
+	}
+}
+
+// The decoded stamp is stored before the message is published, so is always visible here. A record reused
+// by the device while this frame waited may be stamped, but with CONST_TRACE_RECORDS of samples in between 
+// the frame would have been delayed by several seconds
+void ActisenseTracer::Deliver(const unsigned int traceId) {
+	TraceRecord *record = FindRecord(traceId);
+	if (record != NULL) {
+		unsigned long long pushed = TwoCanUtils::GetMonotonicMicros();
+		record->stamps[TRACE_STAGE_PUSHED].store(pushed, std::memory_order_relaxed);
+		unsigned long long read = record->stamps[TRACE_STAGE_READ].load(std::memory_order_relaxed);
+		unsigned long long decoded = record->stamps[TRACE_STAGE_DECODED].load(std::memory_order_relaxed);
+		intervals[TRACE_INTERVAL_DELIVER].Record((pushed > decoded) ? pushed - decoded : 0);
+		intervals[TRACE_INTERVAL_TOTAL].Record((pushed > read) ? pushed - read : 0);
+	}
+}
+
+void ActisenseTracer::LogIntervals(void) {
+	for (int i = 0; i < TRACE_INTERVALS; i++) {
+		if (intervals[i].GetCount() > 0) {
+			wxLogMessage(_T("Actisense Tracer, %s (usec) Frames: %llu, Median: %llu, 99%%: %llu, Maximum: %llu"), GetIntervalName(i),
+				intervals[i].GetCount(), intervals[i].GetPercentile(50), intervals[i].GetPercentile(99), intervals[i].GetMaximum());
+		}
+	}
+}
+
+// Each frame is an async event, with its stages nested within it, so that frames overlapping in the queue are drawn separately
+int ActisenseTracer::WriteChromeTrace(const wxString& fileName) {
+	wxFileName traceFileName(fileName);
+	if (traceFileName.IsRelative()) {
+		traceFileName.MakeAbsolute(wxStandardPaths::Get().GetDocumentsDir());
+	}
+
+	wxFile chromeFile;
+	if (!chromeFile.Open(traceFileName.GetFullPath(), wxFile::write)) {
+		wxLogError(_T("Actisense Tracer, Unable to create trace file %s"), traceFileName.GetFullPath());
+		return SET_ERROR(TWOCAN_RESULT_ERROR, TWOCAN_SOURCE_DEVICE, TWOCAN_ERROR_PATH_NOT_FOUND);
+	}
+
+	// Stages as the intervals between their stamps, the name and the start and end stages. Unlike its
+	// histogram, deliver starts once published so that the spans do not overlap. It is omitted if the
+	// main thread pushed the sentence before the device stamped it as published
+	const struct { const char *name; int start; int end; } spans[] = {
+		{ "queue", TRACE_STAGE_READ, TRACE_STAGE_DEQUEUED },
+		{ "decode", TRACE_STAGE_DEQUEUED, TRACE_STAGE_DECODED },
+		{ "publish", TRACE_STAGE_DECODED, TRACE_STAGE_PUBLISHED },
+		{ "deliver", TRACE_STAGE_PUBLISHED, TRACE_STAGE_PUSHED }
+	};
+
+	chromeFile.Write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	bool firstEvent = TRUE;
+	unsigned int traces = 0;
+	// Oldest first
+	for (int i = 1; i <= CONST_TRACE_RECORDS; i++) {
+		const TraceRecord *record = &records[(lastId + i) & (CONST_TRACE_RECORDS - 1)];
+		unsigned int traceId = record->id.load(std::memory_order_relaxed);
+		if (traceId == 0) {
+			continue;
+		}
+		unsigned long long stamps[TRACE_STAGES];
+		unsigned long long frameEnd = 0;
+		for (int j = 0; j < TRACE_STAGES; j++) {
+			stamps[j] = record->stamps[j].load(std::memory_order_relaxed);
+			frameEnd = std::max(frameEnd, stamps[j]);
+		}
+
+		wxString frameName = (record->pgn == CONST_OTHER_PGNS) ? wxString("Frame") : wxString::Format("PGN %u", record->pgn);
+		wxString events = wxString::Format("%s{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"b\",\"id\":%u,\"pid\":1,\"tid\":1,\"ts\":%llu}",
+			firstEvent ? "" : ",\n", frameName, traceId, stamps[TRACE_STAGE_READ]);
+		for (size_t j = 0; j < sizeof(spans) / sizeof(spans[0]); j++) {
+			if ((stamps[spans[j].start] > 0) && (stamps[spans[j].end] >= stamps[spans[j].start])) {
+				events.Append(wxString::Format(",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"b\",\"id\":%u,\"pid\":1,\"tid\":1,\"ts\":%llu}", 
+					spans[j].name, traceId, stamps[spans[j].start]));
+				events.Append(wxString::Format(",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"e\",\"id\":%u,\"pid\":1,\"tid\":1,\"ts\":%llu}", 
+					spans[j].name, traceId, stamps[spans[j].end]));
+			}
+		}
+		events.Append(wxString::Format(",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"e\",\"id\":%u,\"pid\":1,\"tid\":1,\"ts\":%llu}",
+			frameName, traceId, frameEnd));
+		chromeFile.Write(events);
+		firstEvent = FALSE;
+		traces++;
+	}
+	chromeFile.Write("\n]}\n");
+	chromeFile.Close();
+
+	wxLogMessage(_T("Actisense Tracer, Wrote %u traced frames to %s"), traces, traceFileName.GetFullPath());
+	return TWOCAN_RESULT_SUCCESS;
+}
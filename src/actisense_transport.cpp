@@ -0,0 +1,238 @@
+// Copyright(C) 2018-2020 by Steven Adler
+//
+// This file is part of Actisense plugin for OpenCPN.
+//
+// Actisense plugin for OpenCPN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Actisense plugin for OpenCPN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with the Actisense plugin for OpenCPN. If not, see <https://www.gnu.org/licenses/>.
+//
+// NMEA2000® is a registered trademark of the National Marine Electronics Association
+// Actisense® is a registered trademark of Active Research Limited
+
+
+
+// Project: Actisense Plugin
+// Description: Actisense NGT-1 plugin for OpenCPN
+// Unit: ActisenseTransport - ISO 11783-3 Transport Protocol reassembly
+// Owner: twocanplugin@hotmail.com
+// Date: 6/1/2020
+// Version History: 
+// 1.0 Initial Release
+//
+
+#include "actisense_transport.h"
+
+ActisenseTransport::ActisenseTransport(ActisenseTimerWheel *timerWheel, const int firstTimer) {
+	this->timerWheel = timerWheel;
+	this->firstTimer = firstTimer;
+
+	sessions.resize(CONST_TP_SESSIONS);
+	for (int i = 0; i < CONST_TP_SESSIONS; i++) {
+		sessions[i].next = (i + 1 < CONST_TP_SESSIONS) ? i + 1 : NOT_FOUND;
+	}
+	freeSessions = 0;
+
+	for (int i = 0; i <= CONST_GLOBAL_ADDRESS; i++) {
+		sourceSessions[i] = NOT_FOUND;
+	}
+
+	messageHeader = {};
+	messagePayload.reserve(CONST_MAX_ISO_MULTI_PACKET_LENGTH);
+	statistics = {};
+}
+
+ActisenseTransport::~ActisenseTransport(void) {
+}
+
+// A source may have a BAM and one RTS/CTS transfer with each destination in progress at once
+int ActisenseTransport::FindSession(const byte source, const byte destination) {
+	for (int i = sourceSessions[source]; i != NOT_FOUND; i = sessions[i].next) {
+		if (sessions[i].destination == destination) {
+			return i;
+		}
+	}
+	return NOT_FOUND;
+}
+
+// data is a BAM or RTS, bytes 1 - 2 size, byte 3 number of packets, bytes 5 - 7 PGN
+int ActisenseTransport::OpenSession(const CanHeader header, const byte *data) {
+	unsigned int size = data[1] | (data[2] << 8);
+	byte packets = data[3];
+
+	if ((size <= CONST_PAYLOAD_LENGTH) || (size > CONST_MAX_ISO_MULTI_PACKET_LENGTH) || (packets != (size + 6) / 7)) {
+		statistics.discarded++;
+		return NOT_FOUND;
+	}
+
+	if (freeSessions == NOT_FOUND) {
+		statistics.discarded++;
+		return NOT_FOUND;
+	}
+
+	int session = freeSessions;
+	freeSessions = sessions[session].next;
+	sessions[session].next = sourceSessions[header.source];
+	sourceSessions[header.source] = session;
+
+	sessions[session].source = header.source;
+	sessions[session].destination = (data[0] == TP_CM_BAM) ? CONST_GLOBAL_ADDRESS : header.destination;
+	sessions[session].priority = header.priority;
+	sessions[session].pgn = data[5] | (data[6] << 8) | (data[7] << 16);
+	sessions[session].size = size;
+	sessions[session].packets = packets;
+	sessions[session].nextSequence = 1;
+	// BAM data follows immediately, RTS data waits for the receiver's CTS
+	sessions[session].lastSequence = (data[0] == TP_CM_BAM) ? packets : 0;
+
+	timerWheel->Arm(firstTimer + session, TwoCanUtils::GetMonotonicMillis() + ((data[0] == TP_CM_BAM) ? CONST_TP_T1 : CONST_TP_T3));
+	return session;
+}
+
+void ActisenseTransport::CloseSession(const int session) {
+	int *link = &sourceSessions[sessions[session].source];
+	while (*link != session) {
+		link = &sessions[*link].next;
+	}
+	*link = sessions[session].next;
+
+	sessions[session].next = freeSessions;
+	freeSessions = session;
+
+	timerWheel->Cancel(firstTimer + session);
+}
+
+bool ActisenseTransport::IsTransportTimer(const int timer) {
+	return (timer >= firstTimer) && (timer < firstTimer + CONST_TP_SESSIONS);
+}
+
+void ActisenseTransport::Expire(const int timer) {
+	statistics.timedOut++;
+	CloseSession(timer - firstTimer);
+}
+
+bool ActisenseTransport::ProcessFrame(const CanHeader header, const byte *data, const byte length) {
+	if (length < CONST_PAYLOAD_LENGTH) {
+		statistics.discarded++;
+		return FALSE;
+	}
+
+	if (header.pgn == CONST_TP_CM_PGN) {
+		ProcessConnection(header, data);
+		return FALSE;
+	}
+
+	if (header.pgn == CONST_TP_DT_PGN) {
+		return ProcessData(header, data);
+	}
+
+	return FALSE;
+}
+
+void ActisenseTransport::ProcessConnection(const CanHeader header, const byte *data) {
+	int session;
+
+	switch (data[0]) {
+
+		case TP_CM_BAM:
+		case TP_CM_RTS:
+			// A new announcement or request replaces any transfer in progress
+			session = FindSession(header.source, (data[0] == TP_CM_BAM) ? CONST_GLOBAL_ADDRESS : header.destination);
+			if (session != NOT_FOUND) {
+				statistics.aborted++;
+				CloseSession(session);
+			}
+			OpenSession(header, data);
+			break;
+
+		case TP_CM_CTS:
+			// Sent by the receiver, byte 1 number of packets that may be sent, byte 2 next packet number
+			session = FindSession(header.destination, header.source);
+			if (session != NOT_FOUND) {
+				if (data[1] == 0) {
+					// Receiver is holding the connection open
+					timerWheel->Arm(firstTimer + session, TwoCanUtils::GetMonotonicMillis() + CONST_TP_T4);
+				}
+				else if ((data[2] == 0) || (data[2] > sessions[session].packets)) {
+					statistics.discarded++;
+					CloseSession(session);
+				}
+				else {
+					// May request packets to be resent
+					sessions[session].nextSequence = data[2];
+					sessions[session].lastSequence = ((data[2] + data[1] - 1) < sessions[session].packets) ? data[2] + data[1] - 1 : sessions[session].packets;
+					timerWheel->Arm(firstTimer + session, TwoCanUtils::GetMonotonicMillis() + CONST_TP_T2);
+				}
+			}
+			break;
+
+		case TP_CM_EOMA:
+			// The message has already been delivered when its last packet arrived
+			break;
+
+		case TP_CM_ABORT:
+			// Either party may abort
+			session = FindSession(header.source, header.destination);
+			if (session == NOT_FOUND) {
+				session = FindSession(header.destination, header.source);
+			}
+			if (session != NOT_FOUND) {
+				statistics.aborted++;
+				CloseSession(session);
+			}
+			break;
+	}
+}
+
+// data[0] sequence number 1 .. 255, data[1 .. 7] data, the last packet padded with 0xFF
+bool ActisenseTransport::ProcessData(const CanHeader header, const byte *data) {
+	int session = FindSession(header.source, header.destination);
+	if (session == NOT_FOUND) {
+		// Missed the announcement or request
+		statistics.discarded++;
+		return FALSE;
+	}
+
+	TransportSession *transfer = &sessions[session];
+
+	if ((data[0] != transfer->nextSequence) || (data[0] > transfer->lastSequence)) {
+		statistics.discarded++;
+		if (transfer->destination == CONST_GLOBAL_ADDRESS) {
+			// Nothing can be resent to a BAM's receivers
+			CloseSession(session);
+		}
+		// Otherwise the receiver will ask for it again, or the transfer will time out
+		return FALSE;
+	}
+
+	unsigned int offset = (data[0] - 1) * 7;
+	unsigned int count = ((transfer->size - offset) < 7) ? transfer->size - offset : 7;
+	memcpy(&transfer->data[offset], &data[1], count);
+
+	if (data[0] == transfer->packets) {
+		messageHeader.priority = transfer->priority;
+		messageHeader.source = transfer->source;
+		messageHeader.destination = transfer->destination;
+		messageHeader.pgn = transfer->pgn;
+		messageHeader.timestamp = header.timestamp;
+		// Capacity was reserved in the constructor, so assigning does not allocate
+		messagePayload.assign(transfer->data, transfer->data + transfer->size);
+		statistics.completed++;
+		CloseSession(session);
+		return TRUE;
+	}
+
+	transfer->nextSequence++;
+	// RTS/CTS, once the cleared packets have been sent, the originator waits for the next CTS
+	timerWheel->Arm(firstTimer + session, TwoCanUtils::GetMonotonicMillis() + 
+		(((transfer->destination != CONST_GLOBAL_ADDRESS) && (data[0] == transfer->lastSequence)) ? CONST_TP_T3 : CONST_TP_T1));
+	return FALSE;
+}
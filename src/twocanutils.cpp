@@ -70,6 +70,14 @@ int TwoCanUtils::ConvertHexStringToByteArray(const byte *hexstr, const unsigned
 	}
 }
 
+// Milliseconds from a monotonic clock. Only meaningful when comparing two values
+unsigned long long TwoCanUtils::GetMonotonicMillis(void) {
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+unsigned long long TwoCanUtils::GetMonotonicMicros(void) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 // Decodes a 29 bit CAN header
 int TwoCanUtils::DecodeCanHeader(const byte *buf, CanHeader *header) {
@@ -97,6 +105,7 @@ int TwoCanUtils::DecodeCanHeader(const byte *buf, CanHeader *header) {
 		}
 		// Priority is bits 2,3,4 of b(3)
 		header->priority = (buf[3] & 0x1c) >> 2;
+		header->timestamp = 0;
 
 		return true;
 	}
@@ -105,6 +114,39 @@ int TwoCanUtils::DecodeCanHeader(const byte *buf, CanHeader *header) {
 	}
 }
 
+// The checksum byte at the end of an Actisense message ensures that the sum of all bytes modulo 256 equals 0
+byte TwoCanUtils::ActisenseChecksum(const byte *buf, const unsigned int length) {
+	byte checksum = 0;
+	for (unsigned int i = 0; i < length; i++) {
+		checksum += buf[i];
+	}
+	return checksum;
+}
+
+// Decodes the CAN header from an Actisense N2K_RX_CMD message
+// Cheap enough to be used to peek at messages before they are queued, so no checksum validation
+// buf[0] - Command, buf[1] - Overall length (optional), then Priority, PGN (3 bytes), Destination, Source
+// Also decodes the CAN Id of a raw CAN frame (CAN_RX_CMD) posted by a non Actisense interface
+int TwoCanUtils::DecodeActisenseHeader(const byte *buf, const unsigned int length, CanHeader *header) {
+	if ((buf != NULL) && (header != NULL) && (length > 7) && (buf[0] == N2K_RX_CMD)) {
+		// overall length excludes command byte, length byte and checksum byte
+		int offset = (buf[1] == length - 3) ? 1 : 0;
+		header->priority = buf[1 + offset];
+		header->pgn = buf[2 + offset] | (buf[3 + offset] << 8) | (buf[4 + offset] << 16);
+		header->destination = buf[5 + offset];
+		header->source = buf[6 + offset];
+		header->timestamp = 0;
+		return TRUE;
+	}
+	else if ((buf != NULL) && (header != NULL) && (length > 9) && (buf[0] == CAN_RX_CMD)) {
+		// Raw CAN frame
+		return DecodeCanHeader(&buf[1], header);
+	}
+	else {
+		return FALSE;
+	}
+}
+
 // Encodes a 29 bit CAN header
 int TwoCanUtils::EncodeCanHeader(unsigned int *id, const CanHeader *header) {
 	if ((id != NULL) && (header != NULL)) {